@@ -0,0 +1,642 @@
+#include <curve.h>
+#include <elliptic_curve.h>
+#include <naf.h>
+#include <prime_field.h>
+#include <sign_engine_ext.h>
+#include <signature.h>
+
+#include <signature_contest/core/src/perf_events.h>
+
+#ifdef GOST_ECC_BENCH_CRYPTOPP
+#include <cryptopp/ecp.h>
+#include <cryptopp/integer.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Micro and macro benchmarks of every layer: field arithmetic, point operations, scalar
+ * multiplications with several window sizes and whole signature operations, on a 256-bit
+ * (CryptoPro-A) and the 512-bit (paramSetA) curve.
+ *
+ *   gost_ecc_bench [--format table|csv|json] [--filter SUBSTRING] [--samples N] [--sample-ms N] [--perf]
+ *
+ * Each benchmark is calibrated to run long enough for one sample, then timed for a number of
+ * samples. Reported are median, minimum, mean and standard deviation of the time per operation
+ * in nanoseconds, and the median in TSC cycles (reference cycles, not core cycles).
+ *
+ * With --perf, the counters of the contest harness (perf_events.h: core cycles, instructions,
+ * cache and branch misses) are read around every sample and reported as averages per
+ * operation. Events the system does not offer are listed and left out.
+ */
+
+using namespace gost_ecc;
+
+namespace {
+
+struct options {
+    std::string format = "table";
+    std::string filter;
+    unsigned samples = 11;
+    double sample_ms = 20;
+    bool perf = false;
+};
+
+struct result {
+    std::string group;
+    std::string name;
+    std::string curve;
+    std::size_t iterations;
+    double ns_median;
+    double ns_min;
+    double ns_mean;
+    double ns_stddev;
+    double cycles_median;
+
+    /**
+     * Per operation, in the order of PerfEvents::name.
+     */
+    std::vector<double> counters;
+};
+
+/**
+ * Keep the compiler from discarding a computed value.
+ */
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+inline uint64_t cycles() {
+#ifdef BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t middle = values.size() / 2;
+    return (values.size() % 2 == 1) ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+class runner {
+public:
+    explicit runner(const options& opts)
+        :opts(opts)
+    {
+        this->events.count = 0;
+        this->events.group_size = 0;
+        this->events.missing_count = 0;
+        if (!opts.perf) {
+            return;
+        }
+
+        PerfEventsOpen(&this->events);
+        if (this->events.missing_count > 0) {
+            std::cerr << "perf events unavailable:";
+            for (unsigned i = 0; i < this->events.missing_count; i++) {
+                std::cerr << " " << this->events.missing[i];
+            }
+            std::cerr << std::endl;
+        }
+    }
+
+    ~runner() {
+        PerfEventsClose(&this->events);
+    }
+
+    runner(const runner&) = delete;
+    runner& operator=(const runner&) = delete;
+
+    /**
+     * @param body Performs one operation; gets the iteration number to pick its inputs.
+     */
+    void run(const std::string& group, const std::string& name, const std::string& curve,
+             const std::function<void(std::size_t)>& body) {
+        const std::string full_name = group + "/" + name + "/" + curve;
+        if (!this->opts.filter.empty() && full_name.find(this->opts.filter) == std::string::npos) {
+            return;
+        }
+
+        // Calibration doubles as warm-up. The fastest run sets the count, so that a single
+        // preempted run does not cut calibration short.
+        const double target = this->opts.sample_ms * 1e6;
+        const std::size_t limit = std::size_t(1) << 30;
+        std::size_t iterations = 1;
+        double fastest = 0;
+        for (unsigned round = 0; ; round++) {
+            const double elapsed = this->sample(body, iterations).first;
+            const double per_call = std::max(elapsed, 1.0) / iterations;
+            fastest = (round == 0) ? per_call : std::min(fastest, per_call);
+
+            if ((elapsed >= target && round >= 2) || iterations >= limit) {
+                break;
+            }
+            iterations = std::max(iterations + 1, std::min(limit, static_cast<std::size_t>(
+                    std::min(target / fastest, iterations * 100.0))));
+        }
+        iterations = std::max<std::size_t>(1, std::min(limit, static_cast<std::size_t>(target / fastest)));
+
+        std::vector<double> ns;
+        std::vector<double> cpu_cycles;
+        std::vector<double> counters(this->events.count, 0);
+        for (unsigned i = 0; i < this->opts.samples; i++) {
+            // Counters are read outside of the timed region, the reads are syscalls.
+            PerfEventsSample before, after;
+            if (this->events.count > 0) {
+                PerfEventsRead(&this->events, &before);
+            }
+            const std::pair<double, double> sample = this->sample(body, iterations);
+            if (this->events.count > 0) {
+                double delta[PERF_EVENTS_MAX];
+                PerfEventsRead(&this->events, &after);
+                PerfEventsDelta(&this->events, &before, &after, delta);
+                for (std::size_t j = 0; j < counters.size(); j++) {
+                    counters[j] += delta[j];
+                }
+            }
+
+            ns.push_back(sample.first / iterations);
+            cpu_cycles.push_back(sample.second / iterations);
+        }
+        for (auto& value : counters) {
+            value /= static_cast<double>(iterations) * this->opts.samples;
+        }
+
+        result r;
+        r.group = group;
+        r.name = name;
+        r.curve = curve;
+        r.iterations = iterations;
+        r.ns_median = median(ns);
+        r.ns_min = *std::min_element(ns.begin(), ns.end());
+
+        double sum = 0, squares = 0;
+        for (double value : ns) {
+            sum += value;
+        }
+        r.ns_mean = sum / ns.size();
+        for (double value : ns) {
+            squares += (value - r.ns_mean) * (value - r.ns_mean);
+        }
+        r.ns_stddev = (ns.size() > 1) ? std::sqrt(squares / (ns.size() - 1)) : 0;
+        r.cycles_median = median(cpu_cycles);
+        r.counters = counters;
+
+        this->results.push_back(r);
+        if (this->opts.format == "table") {
+            std::printf("%-10s %-28s %-6s %14.1f ns %14.0f cycles  +-%5.1f%%  (%zu x %u)\n",
+                        r.group.c_str(), r.name.c_str(), r.curve.c_str(), r.ns_median, r.cycles_median,
+                        r.ns_mean > 0 ? 100 * r.ns_stddev / r.ns_mean : 0.0, r.iterations, this->opts.samples);
+            if (!r.counters.empty()) {
+                std::printf("%-46s", "");
+                for (std::size_t j = 0; j < r.counters.size(); j++) {
+                    std::printf(" %s=%.1f", this->events.name[j], r.counters[j]);
+                }
+                std::printf("\n");
+            }
+            std::fflush(stdout);
+        }
+    }
+
+    void report() const {
+        if (this->opts.format == "csv") {
+            std::printf("group,name,curve,iterations,samples,ns_median,ns_min,ns_mean,ns_stddev,cycles_median");
+            for (unsigned j = 0; j < this->events.count; j++) {
+                std::printf(",%s", this->events.name[j]);
+            }
+            std::printf("\n");
+            for (const auto& r : this->results) {
+                std::printf("%s,%s,%s,%zu,%u,%.3f,%.3f,%.3f,%.3f,%.1f", r.group.c_str(), r.name.c_str(), r.curve.c_str(),
+                            r.iterations, this->opts.samples, r.ns_median, r.ns_min, r.ns_mean, r.ns_stddev, r.cycles_median);
+                for (double value : r.counters) {
+                    std::printf(",%.3f", value);
+                }
+                std::printf("\n");
+            }
+        } else if (this->opts.format == "json") {
+            std::printf("{\n  \"compiler\": \"%s\",\n  \"optimized\": %s,\n  \"samples\": %u,\n  \"sample_ms\": %.1f,\n",
+                        __VERSION__,
+#ifdef __OPTIMIZE__
+                        "true",
+#else
+                        "false",
+#endif
+                        this->opts.samples, this->opts.sample_ms);
+            if (this->opts.perf) {
+                std::printf("  \"perf_unavailable\": [");
+                for (unsigned j = 0; j < this->events.missing_count; j++) {
+                    std::printf("%s\"%s\"", (j > 0) ? ", " : "", this->events.missing[j]);
+                }
+                std::printf("],\n");
+            }
+            std::printf("  \"results\": [\n");
+            for (std::size_t i = 0; i < this->results.size(); i++) {
+                const result& r = this->results[i];
+                std::printf("    {\"group\": \"%s\", \"name\": \"%s\", \"curve\": \"%s\", \"iterations\": %zu, "
+                            "\"ns_median\": %.3f, \"ns_min\": %.3f, \"ns_mean\": %.3f, \"ns_stddev\": %.3f, "
+                            "\"cycles_median\": %.1f",
+                            r.group.c_str(), r.name.c_str(), r.curve.c_str(), r.iterations, r.ns_median, r.ns_min,
+                            r.ns_mean, r.ns_stddev, r.cycles_median);
+                if (this->opts.perf) {
+                    std::printf(", \"counters\": {");
+                    for (std::size_t j = 0; j < r.counters.size(); j++) {
+                        std::printf("%s\"%s\": %.3f", (j > 0) ? ", " : "", this->events.name[j], r.counters[j]);
+                    }
+                    std::printf("}");
+                }
+                std::printf("}%s\n", (i + 1 < this->results.size()) ? "," : "");
+            }
+            std::printf("  ]\n}\n");
+        }
+    }
+
+private:
+    /**
+     * @return Nanoseconds and TSC cycles of iterations calls.
+     */
+    std::pair<double, double> sample(const std::function<void(std::size_t)>& body, std::size_t iterations) const {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t start_cycles = cycles();
+
+        for (std::size_t i = 0; i < iterations; i++) {
+            body(i);
+        }
+
+        const uint64_t end_cycles = cycles();
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::make_pair(std::chrono::duration<double, std::nano>(end - start).count(),
+                              static_cast<double>(end_cycles - start_cycles));
+    }
+
+    const options& opts;
+    PerfEvents events;
+    std::vector<result> results;
+};
+
+/**
+ * Number of distinct inputs benchmarks cycle through.
+ */
+const std::size_t input_count = 16;
+
+template <typename Curve>
+struct curve_setup {
+    using ec = Curve;
+    using pf = typename ec::field_type;
+    using integer_type = typename ec::integer_type;
+
+    std::string name;
+    ec curve;
+    pf subgroup;
+    typename ec::point base;
+
+    std::vector<integer_type> elements;
+    std::vector<integer_type> scalars;
+
+    curve_setup(const std::string& name, const integer_type& p, const integer_type& a, const integer_type& b,
+                const integer_type& q, const typename ec::point& base)
+        :name(name), curve(p, a, b), subgroup(q), base(base)
+    {
+        std::mt19937_64 random(42);
+
+        for (std::size_t i = 0; i < input_count; i++) {
+            integer_type element = 0, scalar = 0;
+            for (unsigned j = 0; j < pf::bits / 64; j++) {
+                element = (element << 64) | integer_type(random());
+                scalar = (scalar << 64) | integer_type(random());
+            }
+            this->elements.push_back(element % p);
+            this->scalars.push_back(scalar % q);
+        }
+    }
+};
+
+template <typename Setup>
+void bench_field(runner& bench, const Setup& s) {
+    using pf = typename Setup::pf;
+    const pf& field = s.curve.field;
+
+    std::vector<typename pf::double_integer_type> products;
+    std::vector<std::vector<unsigned char> > encoded;
+    for (std::size_t i = 0; i < input_count; i++) {
+        typename pf::double_integer_type product;
+        mp::multiply(product, s.elements[i], s.elements[(i + 1) % input_count]);
+        products.push_back(product);
+
+        encoded.emplace_back(pf::bits / 8);
+        pf::export_bytes(s.elements[i], encoded.back().data());
+    }
+
+    const std::size_t mask = input_count - 1;
+
+    bench.run("field", "mul", s.name, [&](std::size_t i) {
+        keep(field.mul(s.elements[i & mask], s.elements[(i + 1) & mask]));
+    });
+    bench.run("field", "reduce", s.name, [&](std::size_t i) {
+        keep(field.reduce(products[i & mask]));
+    });
+    bench.run("field", "add", s.name, [&](std::size_t i) {
+        keep(field.add(s.elements[i & mask], s.elements[(i + 1) & mask]));
+    });
+    bench.run("field", "mul_inverse", s.name, [&](std::size_t i) {
+        keep(field.mul_inverse(s.elements[i & mask]));
+    });
+    bench.run("field", "import_bytes", s.name, [&](std::size_t i) {
+        keep(pf::import_bytes(encoded[i & mask].data()));
+    });
+}
+
+template <unsigned w, typename Setup>
+void bench_naf(runner& bench, const Setup& s) {
+    std::vector<short> digits(Setup::pf::bits + 1);
+    bench.run("naf", "naf<" + std::to_string(w) + ">", s.name, [&](std::size_t i) {
+        keep(naf<w>(s.scalars[i & (input_count - 1)], digits.data()));
+    });
+}
+
+template <unsigned w, typename Setup>
+void bench_comb(runner& bench, const Setup& s) {
+    using ec = typename Setup::ec;
+    struct table {
+        typename ec::jacobian_point points[1 << w];
+    };
+    std::unique_ptr<table> t(new table());
+
+    bench.run("precompute", "comb_precompute<" + std::to_string(w) + ">", s.name, [&](std::size_t) {
+        s.curve.template comb_precompute<w>(s.base, t->points);
+    });
+    bench.run("mul", "comb<" + std::to_string(w) + ">", s.name, [&](std::size_t i) {
+        keep(s.curve.template mul_scalar_jacobian<w>(t->points, s.scalars[i & (input_count - 1)]));
+    });
+}
+
+template <unsigned w, typename Setup>
+void bench_wnaf(runner& bench, const Setup& s) {
+    using ec = typename Setup::ec;
+    typename ec::jacobian_point table[1 << (w - 2)];
+
+    bench.run("precompute", "naf_precompute<" + std::to_string(w) + ">", s.name, [&](std::size_t) {
+        s.curve.template naf_precompute<w>(s.base, table);
+    });
+    bench.run("mul", "wnaf<" + std::to_string(w) + ">", s.name, [&](std::size_t i) {
+        keep(s.curve.template mul_scalar<w>(table, s.scalars[i & (input_count - 1)]));
+    });
+}
+
+template <unsigned w_right, typename Setup>
+void bench_add_mul(runner& bench, const Setup& s) {
+    using ec = typename Setup::ec;
+    const unsigned w_left = 6;
+    typename ec::jacobian_point left[1 << (w_left - 2)];
+    typename ec::jacobian_point right[1 << (w_right - 2)];
+
+    const typename ec::point other = s.curve.mul_scalar(s.base, s.scalars[0]);
+    s.curve.template naf_precompute<w_left>(other, left);
+    s.curve.template naf_precompute<w_right>(s.base, right);
+
+    bench.run("mul", "add_mul<6," + std::to_string(w_right) + ">", s.name, [&](std::size_t i) {
+        keep(s.curve.template add_mul<w_left, w_right>(left, s.scalars[i & (input_count - 1)],
+                                                        right, s.scalars[(i + 1) & (input_count - 1)]));
+    });
+}
+
+template <typename Setup>
+void bench_curve(runner& bench, const Setup& s) {
+    using ec = typename Setup::ec;
+    const std::size_t mask = input_count - 1;
+
+    std::vector<typename ec::jacobian_point> points;
+    std::vector<typename ec::point> affine;
+    for (std::size_t i = 0; i < input_count; i++) {
+        typename ec::jacobian_point p(s.curve.mul_scalar(s.base, s.scalars[i]));
+        // Non-trivial Z, as in the middle of a multiplication.
+        p = s.curve.twice(p);
+        points.push_back(p);
+        affine.push_back(p.to_affine(s.curve));
+    }
+
+    bench.run("point", "twice", s.name, [&](std::size_t i) {
+        keep(s.curve.twice(points[i & mask]));
+    });
+    bench.run("point", "repeated_twice(8)", s.name, [&](std::size_t i) {
+        keep(s.curve.repeated_twice(points[i & mask], 8));
+    });
+    bench.run("point", "add", s.name, [&](std::size_t i) {
+        keep(s.curve.add(points[i & mask], points[(i + 1) & mask]));
+    });
+    bench.run("point", "add_mixed", s.name, [&](std::size_t i) {
+        keep(s.curve.add(points[i & mask], affine[(i + 1) & mask]));
+    });
+    bench.run("point", "to_affine", s.name, [&](std::size_t i) {
+        keep(points[i & mask].to_affine(s.curve));
+    });
+
+    bench_naf<4>(bench, s);
+    bench_naf<6>(bench, s);
+    bench_naf<10>(bench, s);
+
+    bench.run("mul", "affine_double_add", s.name, [&](std::size_t i) {
+        keep(s.curve.mul_scalar(s.base, s.scalars[i & mask]));
+    });
+
+    bench_wnaf<4>(bench, s);
+    bench_wnaf<6>(bench, s);
+    bench_wnaf<8>(bench, s);
+    bench_wnaf<10>(bench, s);
+
+    bench_comb<4>(bench, s);
+    bench_comb<6>(bench, s);
+    bench_comb<8>(bench, s);
+    bench_comb<10>(bench, s);
+
+    bench_add_mul<6>(bench, s);
+    bench_add_mul<8>(bench, s);
+    bench_add_mul<10>(bench, s);
+}
+
+void bench_signature(runner& bench) {
+    const std::size_t mask = input_count - 1;
+
+    for (unsigned flags : {unsigned(kGost12S512CtxDefault), unsigned(kGost12S512CtxCompact)}) {
+        const std::string suffix = (flags == kGost12S512CtxDefault) ? "" : "(compact)";
+        const signature s(gost_ecc::p, gost_ecc::a, gost_ecc::b, gost_ecc::q, gost_ecc::x0, gost_ecc::y0, flags);
+
+        std::mt19937_64 random(7);
+        std::vector<std::array<uint64_t, 8> > keys(input_count), rands(input_count), hashes(input_count);
+        std::vector<std::array<uint64_t, 8> > xs(input_count), ys(input_count);
+        std::vector<std::array<uint64_t, 16> > signatures(input_count);
+
+        std::vector<const char*> private_keys(input_count);
+        std::vector<char*> public_x(input_count), public_y(input_count);
+        for (std::size_t i = 0; i < input_count; i++) {
+            for (unsigned j = 0; j < 8; j++) {
+                keys[i][j] = random();
+                rands[i][j] = random();
+                hashes[i][j] = random();
+            }
+            // Below q of paramSetA, whose top limb is all ones.
+            keys[i][7] >>= 1;
+            rands[i][7] >>= 1;
+
+            private_keys[i] = reinterpret_cast<const char*>(keys[i].data());
+            public_x[i] = reinterpret_cast<char*>(xs[i].data());
+            public_y[i] = reinterpret_cast<char*>(ys[i].data());
+        }
+        s.derive_keys(private_keys.data(), public_x.data(), public_y.data(), input_count);
+
+        for (std::size_t i = 0; i < input_count; i++) {
+            if (s.sign(reinterpret_cast<const byte*>(keys[i].data()), reinterpret_cast<const byte*>(rands[i].data()),
+                       reinterpret_cast<const byte*>(hashes[i].data()), reinterpret_cast<byte*>(signatures[i].data())) != kStatusOk) {
+                throw std::logic_error("benchmark signature failed");
+            }
+        }
+
+        std::array<uint64_t, 16> out;
+        bench.run("signature", "sign" + suffix, "512", [&](std::size_t i) {
+            keep(s.sign(reinterpret_cast<const byte*>(keys[i & mask].data()), reinterpret_cast<const byte*>(rands[i & mask].data()),
+                        reinterpret_cast<const byte*>(hashes[i & mask].data()), reinterpret_cast<byte*>(out.data())));
+        });
+        bench.run("signature", "verify" + suffix, "512", [&](std::size_t i) {
+            if (s.verify(reinterpret_cast<const byte*>(xs[i & mask].data()), reinterpret_cast<const byte*>(ys[i & mask].data()),
+                         reinterpret_cast<const byte*>(hashes[i & mask].data()),
+                         reinterpret_cast<const byte*>(signatures[i & mask].data())) != kStatusOk) {
+                throw std::logic_error("benchmark verification failed");
+            }
+        });
+    }
+}
+
+#ifdef GOST_ECC_BENCH_CRYPTOPP
+template <typename Setup>
+CryptoPP::Integer to_cryptopp(const typename Setup::integer_type& value) {
+    std::vector<unsigned char> bytes(Setup::pf::bits / 8);
+    Setup::pf::export_bytes(value, bytes.data());
+    std::reverse(bytes.begin(), bytes.end());
+
+    return CryptoPP::Integer(bytes.data(), bytes.size());
+}
+
+/**
+ * Same multiplications with Crypto++, the library the engine was first compared against.
+ */
+template <typename Setup>
+void bench_cryptopp(runner& bench, const Setup& s) {
+    const typename Setup::integer_type a = s.curve.field.sub(0, 3);
+
+    CryptoPP::ECP curve(to_cryptopp<Setup>(s.curve.field.modulus), to_cryptopp<Setup>(a), to_cryptopp<Setup>(s.curve.b));
+    CryptoPP::ECP::Point base(to_cryptopp<Setup>(s.base.x), to_cryptopp<Setup>(s.base.y));
+    CryptoPP::ECP::Point other = curve.ScalarMultiply(base, to_cryptopp<Setup>(s.scalars[0]));
+
+    std::vector<CryptoPP::Integer> scalars;
+    for (const auto& scalar : s.scalars) {
+        scalars.push_back(to_cryptopp<Setup>(scalar));
+    }
+    const std::size_t mask = input_count - 1;
+
+    bench.run("cryptopp", "ScalarMultiply", s.name, [&](std::size_t i) {
+        keep(curve.ScalarMultiply(base, scalars[i & mask]));
+    });
+    bench.run("cryptopp", "CascadeScalarMultiply", s.name, [&](std::size_t i) {
+        keep(curve.CascadeScalarMultiply(other, scalars[i & mask], base, scalars[(i + 1) & mask]));
+    });
+}
+#endif
+
+options parse_options(int argc, char** argv) {
+    options result;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--format" && has_value) {
+            result.format = argv[++i];
+            if (result.format != "table" && result.format != "csv" && result.format != "json") {
+                throw std::invalid_argument("unknown format " + result.format);
+            }
+        } else if (arg == "--filter" && has_value) {
+            result.filter = argv[++i];
+        } else if (arg == "--samples" && has_value) {
+            result.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sample-ms" && has_value) {
+            result.sample_ms = std::max(0.01, std::atof(argv[++i]));
+        } else if (arg == "--perf") {
+            result.perf = true;
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    try {
+        opts = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl <<
+            "Usage: gost_ecc_bench [--format table|csv|json] [--filter SUBSTRING] [--samples N] [--sample-ms N] [--perf]" << std::endl;
+        return 2;
+    }
+
+#ifndef __OPTIMIZE__
+    std::cerr << "warning: benchmarks built without optimization" << std::endl;
+#endif
+
+    runner bench(opts);
+
+    using ec256 = elliptic_curve<mp::uint256_t, mp::uint512_t, cpp_int_fixed<272> >;
+    using ec512 = elliptic_curve<mp::uint512_t, mp::uint1024_t, cpp_int_fixed<528> >;
+
+    // CryptoPro-A of RFC 4357, a = -3.
+    const mp::uint256_t p256("0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFD97");
+    curve_setup<ec256> setup256("256", p256, p256 - 3, 166,
+                                mp::uint256_t("0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF6C611070995AD10045841B09B761B893"),
+                                ec256::point(1, mp::uint256_t("0x8D91E471E0989CDA27DF505A453F2B7635294F2DDF23E3B122ACC99C9E9F1E14")));
+
+    using pf512 = ec512::field_type;
+    curve_setup<ec512> setup512("512", pf512::import_bytes(gost_ecc::p), pf512::import_bytes(gost_ecc::a), pf512::import_bytes(gost_ecc::b),
+                                pf512::import_bytes(gost_ecc::q), ec512::point(pf512::import_bytes(gost_ecc::x0), pf512::import_bytes(gost_ecc::y0)));
+
+    try {
+        bench_field(bench, setup256);
+        bench_field(bench, setup512);
+        bench_curve(bench, setup256);
+        bench_curve(bench, setup512);
+        bench_signature(bench);
+#ifdef GOST_ECC_BENCH_CRYPTOPP
+        bench_cryptopp(bench, setup256);
+        bench_cryptopp(bench, setup512);
+#endif
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    bench.report();
+    return 0;
+}
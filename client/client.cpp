@@ -0,0 +1,196 @@
+#include <sign_engine_client.h>
+#include <daemon_protocol.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace protocol = ::gost_ecc::protocol;
+
+struct Gost12S512Client {
+    int fd;
+    uint32_t next_id;
+
+    /**
+     * Connection failed, e.g. the daemon has been restarted, and must be reopened.
+     */
+    bool broken;
+
+    explicit Gost12S512Client(int fd)
+        :fd(fd), next_id(0), broken(false)
+    {}
+
+    ~Gost12S512Client() {
+        ::close(this->fd);
+    }
+
+    /**
+     * Send request and wait for its response. Requests are not pipelined, so the response
+     * must carry the same id. A timeout breaks the connection, a late response must not be
+     * taken for the one of the next request.
+     */
+    bool call(protocol::request& request, protocol::response& response) {
+        request.id = this->next_id++;
+
+        if (!protocol::send_all(this->fd, &request, sizeof(request)) ||
+                !protocol::receive_all(this->fd, &response, sizeof(response)) ||
+                response.id != request.id) {
+            this->broken = true;
+        }
+        return !this->broken;
+    }
+};
+
+namespace {
+
+std::string default_path() {
+    const char* path = std::getenv(protocol::socket_variable);
+    return (path != nullptr && *path != '\0') ? path : protocol::default_socket();
+}
+
+unsigned call_timeout() {
+    const char* value = std::getenv(protocol::timeout_variable);
+    if (value == nullptr || *value == '\0') {
+        return protocol::call_timeout_ms;
+    }
+
+    char* end = nullptr;
+    const unsigned long timeout = std::strtoul(value, &end, 10);
+    return (*end == '\0') ? static_cast<unsigned>(timeout) : protocol::call_timeout_ms;
+}
+
+/**
+ * Connection of the calling thread for the contest interface, reopened after failures.
+ */
+thread_local std::unique_ptr<Gost12S512Client, void (*)(Gost12S512Client*)> own_client(nullptr, Gost12S512ClientClose);
+
+Gost12S512Client* thread_client() {
+    if (own_client && own_client->broken) {
+        own_client.reset();
+    }
+    if (!own_client) {
+        own_client.reset(Gost12S512ClientConnect(nullptr));
+    }
+    return own_client.get();
+}
+
+}
+
+Gost12S512Client* Gost12S512ClientConnect(const char* socketPath) {
+    const std::string path = (socketPath != nullptr) ? socketPath : default_path();
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return nullptr;
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // Keys and hashes go to the daemon, which must be run by the same user or by root.
+    uid_t daemon_uid;
+    if (!protocol::peer_uid(fd, daemon_uid) || (daemon_uid != ::geteuid() && daemon_uid != 0)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // A hung daemon breaks the connection instead of blocking the caller forever.
+    if (!protocol::set_timeouts(fd, call_timeout())) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    Gost12S512Client* client = new (std::nothrow) Gost12S512Client(fd);
+    if (client == nullptr) {
+        ::close(fd);
+    }
+    return client;
+}
+
+void Gost12S512ClientClose(Gost12S512Client* client) {
+    delete client;
+}
+
+Gost12S512Status Gost12S512ClientSign(Gost12S512Client* client,
+                                      const char* privateKey,
+                                      const char* rand,
+                                      const char* hash,
+                                      char* signature) {
+    if (client == nullptr) {
+        return kStatusInternalError;
+    }
+
+    protocol::request request;
+    std::memset(&request, 0, sizeof(request));
+    request.op = protocol::op_sign;
+    std::memcpy(request.data, privateKey, 64);
+    std::memcpy(request.data + 8, rand, 64);
+    std::memcpy(request.data + 16, hash, 64);
+
+    protocol::response response;
+    if (!client->call(request, response)) {
+        return kStatusInternalError;
+    }
+
+    if (response.status == kStatusOk) {
+        std::memcpy(signature, response.signature, sizeof(response.signature));
+    }
+    return static_cast<Gost12S512Status>(response.status);
+}
+
+Gost12S512Status Gost12S512ClientVerify(Gost12S512Client* client,
+                                        const char* publicKeyX,
+                                        const char* publicKeyY,
+                                        const char* hash,
+                                        const char* signature) {
+    if (client == nullptr) {
+        return kStatusInternalError;
+    }
+
+    protocol::request request;
+    std::memset(&request, 0, sizeof(request));
+    request.op = protocol::op_verify;
+    std::memcpy(request.data, publicKeyX, 64);
+    std::memcpy(request.data + 8, publicKeyY, 64);
+    std::memcpy(request.data + 16, hash, 64);
+    std::memcpy(request.data + 24, signature, 128);
+
+    protocol::response response;
+    if (!client->call(request, response)) {
+        return kStatusInternalError;
+    }
+    return static_cast<Gost12S512Status>(response.status);
+}
+
+Gost12S512Status Gost12S512Init() {
+    return (thread_client() != nullptr) ? kStatusOk : kStatusInternalError;
+}
+
+Gost12S512Status Gost12S512Sign(const char* privateKey,
+                                const char* rand,
+                                const char* hash,
+                                char* signature) {
+    return Gost12S512ClientSign(thread_client(), privateKey, rand, hash, signature);
+}
+
+Gost12S512Status Gost12S512Verify(const char* publicKeyX,
+                                  const char* publicKeyY,
+                                  const char* hash,
+                                  const char* signature) {
+    return Gost12S512ClientVerify(thread_client(), publicKeyX, publicKeyY, hash, signature);
+}
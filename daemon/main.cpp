@@ -0,0 +1,503 @@
+#include <sign_engine_ext.h>
+#include <daemon_protocol.h>
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Serves sign and verify requests of local processes from one engine context.
+ *
+ *   gost_ecc_daemon [--socket PATH] [--workers N] [--batch N] [--deadline-us N]
+ *
+ * Each connection has a reader thread, which queues requests. Worker threads take requests
+ * from the queue in micro-batches and run them through the batch functions, so that
+ * concurrent requests share field inversions and interleaved multiplications. Responses go
+ * back over the connection of each request, see daemon_protocol.h for the wire format.
+ *
+ * The socket is created with mode 0600 and connections of other users are refused.
+ */
+
+namespace protocol = ::gost_ecc::protocol;
+
+namespace {
+
+struct options {
+    std::string socket_path = protocol::default_socket();
+    unsigned workers = 0;
+    std::size_t batch_size = 32;
+    std::chrono::microseconds deadline{200};
+};
+
+void usage() {
+    std::cerr <<
+        "Usage: gost_ecc_daemon [options]\n"
+        "  --socket PATH     Unix socket to listen on, default " << protocol::default_socket() << "\n"
+        "  --workers N       threads running batches, default is the number of CPUs\n"
+        "  --batch N         maximum requests per batch, default 32\n"
+        "  --deadline-us N   how long a batch may wait for more requests under load, default 200\n";
+}
+
+unsigned long parse_number(const char* value) {
+    char* end = nullptr;
+    unsigned long result = std::strtoul(value, &end, 10);
+    if (end == value || *end != '\0') {
+        throw std::invalid_argument(std::string("not a number: ") + value);
+    }
+    return result;
+}
+
+options parse_options(int argc, char** argv) {
+    options result;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--socket" && has_value) {
+            result.socket_path = argv[++i];
+        } else if (arg == "--workers" && has_value) {
+            result.workers = parse_number(argv[++i]);
+        } else if (arg == "--batch" && has_value) {
+            result.batch_size = std::max(1ul, parse_number(argv[++i]));
+        } else if (arg == "--deadline-us" && has_value) {
+            result.deadline = std::chrono::microseconds(parse_number(argv[++i]));
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+
+    if (result.workers == 0) {
+        result.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return result;
+}
+
+/**
+ * Create the directory of the default socket, or check that an existing one belongs to us and
+ * is closed to other users.
+ */
+bool private_directory(const std::string& path) {
+    if (::mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+        std::perror(path.c_str());
+        return false;
+    }
+
+    struct stat info;
+    if (::lstat(path.c_str(), &info) != 0) {
+        std::perror(path.c_str());
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode) || info.st_uid != ::geteuid() || (info.st_mode & 077) != 0) {
+        std::cerr << path << " is not a directory of this user closed to others" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Remove a socket left by a previous run. Other files and sockets of other users are kept.
+ */
+bool remove_stale_socket(const std::string& path) {
+    struct stat info;
+    if (::lstat(path.c_str(), &info) != 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        std::perror(path.c_str());
+        return false;
+    }
+    if (!S_ISSOCK(info.st_mode) || info.st_uid != ::geteuid()) {
+        std::cerr << path << " exists and is not a socket of this user" << std::endl;
+        return false;
+    }
+    return ::unlink(path.c_str()) == 0 || errno == ENOENT;
+}
+
+class connection {
+public:
+    explicit connection(int fd)
+        :fd(fd)
+    {}
+
+    ~connection() {
+        ::close(this->fd);
+    }
+
+    connection(const connection&) = delete;
+    connection& operator=(const connection&) = delete;
+
+    /**
+     * Responses of one connection may come from several workers at once.
+     */
+    void reply(const protocol::response& response) {
+        std::lock_guard<std::mutex> lock(this->write_mutex);
+        protocol::send_all(this->fd, &response, sizeof(response));
+    }
+
+    const int fd;
+
+private:
+    std::mutex write_mutex;
+};
+
+struct pending {
+    std::shared_ptr<connection> origin;
+    protocol::request request;
+};
+
+/**
+ * Queue of requests and the workers which drain it in micro-batches.
+ *
+ * Batching trades latency for throughput, so it adapts to the load: when the previous batch
+ * held a single request, requests arrive slower than they are served and the next batch
+ * starts as soon as there is anything to do. Otherwise a batch waits up to the deadline for
+ * more requests to arrive.
+ */
+class batcher {
+public:
+    batcher(const Gost12S512Ctx* ctx, const options& opts)
+        :ctx(ctx), opts(opts), stopping(false), last_batch(1), requests(0), batches(0)
+    {
+        for (unsigned i = 0; i < opts.workers; i++) {
+            this->workers.emplace_back([this]() { this->work(); });
+        }
+    }
+
+    ~batcher() {
+        this->stop();
+    }
+
+    /**
+     * Serve the requests already queued and wait for the workers to finish.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->arrived.notify_all();
+
+        for (auto& worker : this->workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    void submit(pending& request) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->queue.push_back(std::move(request));
+        }
+        this->arrived.notify_one();
+    }
+
+    void report() const {
+        const std::size_t batches = this->batches;
+        std::fprintf(stderr, "served %zu requests in %zu batches, %.2f per batch\n", this->requests.load(), batches,
+                     batches > 0 ? static_cast<double>(this->requests) / batches : 0.0);
+    }
+
+private:
+    void work() {
+        std::vector<pending> batch;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->arrived.wait(lock, [this]() {
+                    return !this->queue.empty() || this->stopping;
+                });
+
+                if (this->queue.empty()) {
+                    return;
+                }
+
+                if (this->last_batch > 1 && this->queue.size() < this->opts.batch_size) {
+                    const auto deadline = std::chrono::steady_clock::now() + this->opts.deadline;
+                    this->arrived.wait_until(lock, deadline, [this]() {
+                        return this->queue.size() >= this->opts.batch_size || this->stopping;
+                    });
+                }
+
+                // Another worker may have taken everything while this one waited.
+                const std::size_t size = std::min(this->queue.size(), this->opts.batch_size);
+                if (size == 0) {
+                    continue;
+                }
+
+                for (std::size_t i = 0; i < size; i++) {
+                    batch.push_back(std::move(this->queue.front()));
+                    this->queue.pop_front();
+                }
+                this->last_batch = size;
+            }
+
+            this->run(batch);
+            this->requests += batch.size();
+            this->batches++;
+            batch.clear();
+        }
+    }
+
+    void run(std::vector<pending>& batch) {
+        std::vector<protocol::response> responses(batch.size());
+        std::vector<Gost12S512SignJob> sign_jobs;
+        std::vector<std::size_t> sign_index;
+        std::vector<Gost12S512VerifyJob> verify_jobs;
+        std::vector<std::size_t> verify_index;
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            const protocol::request& request = batch[i].request;
+            const char* data = reinterpret_cast<const char*>(request.data);
+
+            std::memset(&responses[i], 0, sizeof(responses[i]));
+            responses[i].id = request.id;
+            responses[i].status = kStatusBadInput;
+
+            if (request.op == protocol::op_sign) {
+                Gost12S512SignJob job;
+                job.privateKey = data;
+                job.rand = data + 64;
+                job.hash = data + 128;
+                job.signature = reinterpret_cast<char*>(responses[i].signature);
+                sign_jobs.push_back(job);
+                sign_index.push_back(i);
+            } else if (request.op == protocol::op_verify) {
+                Gost12S512VerifyJob job;
+                job.publicKeyX = data;
+                job.publicKeyY = data + 64;
+                job.hash = data + 128;
+                job.signature = data + 192;
+                verify_jobs.push_back(job);
+                verify_index.push_back(i);
+            }
+        }
+
+        if (!sign_jobs.empty()) {
+            const Gost12S512Status status = Gost12S512CtxSignBatch(this->ctx, sign_jobs.data(), sign_jobs.size());
+            for (std::size_t j = 0; j < sign_jobs.size(); j++) {
+                responses[sign_index[j]].status = (status == kStatusOk) ? sign_jobs[j].status : status;
+            }
+        }
+
+        if (!verify_jobs.empty()) {
+            const Gost12S512Status status = Gost12S512CtxVerifyBatch(this->ctx, verify_jobs.data(), verify_jobs.size());
+            for (std::size_t j = 0; j < verify_jobs.size(); j++) {
+                responses[verify_index[j]].status = (status == kStatusOk) ? verify_jobs[j].status : status;
+            }
+        }
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            batch[i].origin->reply(responses[i]);
+        }
+    }
+
+    const Gost12S512Ctx* ctx;
+    const options& opts;
+
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::deque<pending> queue;
+    bool stopping;
+    std::size_t last_batch;
+
+    std::atomic<std::size_t> requests;
+    std::atomic<std::size_t> batches;
+
+    std::vector<std::thread> workers;
+};
+
+/**
+ * Reader threads of open connections.
+ */
+class readers {
+public:
+    explicit readers(batcher& work)
+        :work(work)
+    {}
+
+    /**
+     * Stop reading from all connections and wait for their readers, so that none of them
+     * touches the batcher afterwards. Requests already read keep their connections open for
+     * writing until the batcher has replied to them.
+     */
+    ~readers() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        for (const auto& origin : this->live) {
+            ::shutdown(origin->fd, SHUT_RD);
+        }
+        this->finished.wait(lock, [this]() {
+            return this->live.empty();
+        });
+    }
+
+    void start(int fd) {
+        std::list<std::shared_ptr<connection> >::iterator entry;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            entry = this->live.insert(this->live.end(), std::make_shared<connection>(fd));
+        }
+
+        std::thread([this, entry]() {
+            this->serve(*entry);
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->live.erase(entry);
+            this->finished.notify_all();
+        }).detach();
+    }
+
+private:
+    void serve(std::shared_ptr<connection> origin) {
+        pending request;
+        request.origin = origin;
+
+        while (protocol::receive_all(origin->fd, &request.request, sizeof(request.request))) {
+            this->work.submit(request);
+            request.origin = origin;
+        }
+    }
+
+    batcher& work;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::list<std::shared_ptr<connection> > live;
+};
+
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    try {
+        opts = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        usage();
+        return 2;
+    }
+
+    // Signals are taken by a dedicated thread, the rest never see them.
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    std::unique_ptr<Gost12S512Ctx, void (*)(Gost12S512Ctx*)> ctx(
+            Gost12S512CtxCreate(kGost12S512ParamSetA, nullptr), Gost12S512CtxDestroy);
+    if (!ctx) {
+        std::cerr << "cannot create engine context" << std::endl;
+        return 1;
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (opts.socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "socket path is too long" << std::endl;
+        return 2;
+    }
+    std::strcpy(address.sun_path, opts.socket_path.c_str());
+
+    if (opts.socket_path == protocol::default_socket() && !private_directory(protocol::default_directory())) {
+        return 1;
+    }
+    if (!remove_stale_socket(opts.socket_path)) {
+        return 1;
+    }
+
+    // The socket is created without group and other permissions, no window for them to connect.
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const mode_t previous_umask = ::umask(0177);
+    const bool bound = listener >= 0 &&
+            ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    ::umask(previous_umask);
+
+    struct stat socket_info;
+    if (!bound || ::lstat(opts.socket_path.c_str(), &socket_info) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        std::perror(opts.socket_path.c_str());
+        return 1;
+    }
+
+    std::atomic<bool> stopped(false);
+    std::thread signal_waiter([&stop_signals, &stopped, listener]() {
+        int signal = 0;
+        sigwait(&stop_signals, &signal);
+        stopped = true;
+        ::shutdown(listener, SHUT_RDWR);
+    });
+
+    {
+        batcher work(ctx.get(), opts);
+        {
+            readers connections(work);
+            std::fprintf(stderr, "listening on %s with %u workers\n", opts.socket_path.c_str(), opts.workers);
+
+            while (!stopped) {
+                const int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0) {
+                    if (errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    // Out of descriptors or memory for now, connections closing will free them.
+                    if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                        std::perror("accept");
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        continue;
+                    }
+                    break;
+                }
+
+                uid_t uid;
+                if (!protocol::peer_uid(fd, uid) || uid != ::geteuid()) {
+                    std::fprintf(stderr, "refused connection of another user\n");
+                    ::close(fd);
+                    continue;
+                }
+                connections.start(fd);
+            }
+        }
+        work.stop();
+        work.report();
+    }
+
+    if (!stopped) {
+        std::perror("accept");
+        ::kill(::getpid(), SIGTERM);
+    }
+    signal_waiter.join();
+
+    ::close(listener);
+
+    // Remove the socket unless it has been replaced meanwhile.
+    struct stat current_info;
+    if (::lstat(opts.socket_path.c_str(), &current_info) == 0 &&
+            current_info.st_dev == socket_info.st_dev && current_info.st_ino == socket_info.st_ino) {
+        ::unlink(opts.socket_path.c_str());
+    }
+    return 0;
+}
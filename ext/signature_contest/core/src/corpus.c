@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <signature_contest/core/src/corpus.h>
+
+/* Record size written by CorpusWrite(): TestEntry rounded up to the alignment. */
+#define CORPUS_RECORD_SIZE \
+     ((sizeof(TestEntry) + CORPUS_ALIGNMENT - 1) / CORPUS_ALIGNMENT * CORPUS_ALIGNMENT)
+
+CorpusStatus CorpusAttach( Corpus* corpus, const void* data, size_t size )
+{
+     const char* bytes = (const char*) data;
+     CorpusHeader header;
+
+     if( size >= sizeof(header) && memcmp( bytes, CORPUS_MAGIC, sizeof(header.magic) ) == 0 )
+     {
+          memcpy( &header, bytes, sizeof(header) );
+
+          if( header.version != CORPUS_VERSION )
+          {
+               return kCorpusUnsupportedVersion;
+          }
+          if( header.header_size < sizeof(header) || header.header_size % CORPUS_ALIGNMENT != 0 ||
+              header.record_size < sizeof(TestEntry) || header.record_size % CORPUS_ALIGNMENT != 0 ||
+              header.header_size > size || header.count == 0 ||
+              header.count > (size - header.header_size) / header.record_size )
+          {
+               return kCorpusBadFormat;
+          }
+
+          corpus->records = bytes + header.header_size;
+          corpus->count = (size_t) header.count;
+          corpus->stride = header.record_size;
+          corpus->version = header.version;
+          return kCorpusOk;
+     }
+
+     if( size == 0 || size % sizeof(TestEntry) != 0 )
+     {
+          return kCorpusBadFormat;
+     }
+
+     corpus->records = bytes;
+     corpus->count = size / sizeof(TestEntry);
+     corpus->stride = sizeof(TestEntry);
+     corpus->version = 0;
+     return kCorpusOk;
+}
+
+const TestEntry* CorpusEntry( const Corpus* corpus, size_t index )
+{
+     return (const TestEntry*) (corpus->records + index * corpus->stride);
+}
+
+void CorpusShard( const Corpus* corpus, unsigned int shard, unsigned int shards,
+                  size_t* first, size_t* count )
+{
+     size_t begin = corpus->count * shard / shards;
+     size_t end = corpus->count * (shard + 1) / shards;
+
+     *first = begin;
+     *count = end - begin;
+}
+
+int CorpusWrite( const Corpus* corpus, const char* path )
+{
+     CorpusHeader header;
+     char record[ CORPUS_RECORD_SIZE ];
+     FILE* file;
+     size_t i;
+     int result = 0;
+
+     memset( &header, 0, sizeof(header) );
+     memcpy( header.magic, CORPUS_MAGIC, sizeof(header.magic) );
+     header.version = CORPUS_VERSION;
+     header.header_size = CORPUS_ALIGNMENT;
+     header.record_size = (uint32_t) sizeof(record);
+     header.count = corpus->count;
+
+     file = fopen( path, "wb" );
+     if( file == NULL )
+     {
+          return -1;
+     }
+
+     if( fwrite( &header, sizeof(header), 1, file ) != 1 )
+     {
+          result = -1;
+     }
+
+     memset( record, 0, sizeof(record) );
+     for( i = 0; result == 0 && i < corpus->count; i++ )
+     {
+          memcpy( record, CorpusEntry( corpus, i ), sizeof(TestEntry) );
+          if( fwrite( record, sizeof(record), 1, file ) != 1 )
+          {
+               result = -1;
+          }
+     }
+
+     if( fclose( file ) != 0 )
+     {
+          result = -1;
+     }
+     return result;
+}
@@ -0,0 +1,85 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <signature_contest/core/src/test_entry.h>
+
+/* Test vector corpus, version 1.
+ *
+ * A file starts with CorpusHeader, followed by `count` records at offset
+ * `header_size`, each `record_size` bytes apart. Both sizes are multiples of
+ * CORPUS_ALIGNMENT, so every record starts on its own cache line. A record
+ * begins with a TestEntry; bytes past it are reserved and written as zeroes.
+ * Numbers are little-endian.
+ *
+ * Files without the header, plain concatenations of TestEntry such as
+ * verify/test.dat, are read as well (version 0). */
+
+#define CORPUS_MAGIC "GOSTVEC"
+#define CORPUS_VERSION 1
+#define CORPUS_ALIGNMENT 64
+
+typedef struct
+{
+     char magic[ 8 ];
+     uint32_t version;
+     uint32_t header_size;
+     uint32_t record_size;
+     uint32_t reserved0;
+     uint64_t count;
+     char reserved[ 32 ];
+} CorpusHeader;
+
+/* Read-only view of a mapped corpus file. */
+typedef struct
+{
+     const char* records;
+     size_t count;
+     size_t stride;
+     unsigned int version;
+
+     void* mapping;
+     size_t mapping_size;
+     void* handle;
+} Corpus;
+
+typedef enum
+{
+     kCorpusOk,
+     kCorpusCantOpen,
+     kCorpusBadFormat,
+     kCorpusUnsupportedVersion
+} CorpusStatus;
+
+#ifdef __cplusplus
+extern "C" {
+#endif //__cplusplus
+
+/* Map the file and check its header. All pages are read in here, so that
+ * page faults don't land in measurements. */
+CorpusStatus CorpusOpen( const char* path, Corpus* corpus );
+
+void CorpusClose( Corpus* corpus );
+
+/* Check the header of data already in memory and fill records, count,
+ * stride and version of the corpus. */
+CorpusStatus CorpusAttach( Corpus* corpus, const void* data, size_t size );
+
+/* Contiguous range of entries [*first, *first + *count) of shard number
+ * `shard` out of `shards`; shard sizes differ by one entry at most. */
+void CorpusShard( const Corpus* corpus, unsigned int shard, unsigned int shards,
+                  size_t* first, size_t* count );
+
+/* Write all entries of the corpus as a version 1 file. Returns 0 on success. */
+int CorpusWrite( const Corpus* corpus, const char* path );
+
+/* Entry without copying, valid until CorpusClose(). */
+const TestEntry* CorpusEntry( const Corpus* corpus, size_t index );
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#endif /* CORPUS_H */
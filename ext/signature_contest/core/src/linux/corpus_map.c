@@ -0,0 +1,60 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <signature_contest/core/src/corpus.h>
+
+CorpusStatus CorpusOpen( const char* path, Corpus* corpus )
+{
+     struct stat info;
+     CorpusStatus status;
+     void* mapping;
+     int fd;
+
+     memset( corpus, 0, sizeof(*corpus) );
+
+     fd = open( path, O_RDONLY | O_CLOEXEC );
+     if( fd < 0 )
+     {
+          return kCorpusCantOpen;
+     }
+     if( fstat( fd, &info ) != 0 )
+     {
+          close( fd );
+          return kCorpusCantOpen;
+     }
+     if( info.st_size == 0 )
+     {
+          close( fd );
+          return kCorpusBadFormat;
+     }
+
+     /* MAP_POPULATE reads the whole file in now, not during measurements. */
+     mapping = mmap( NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0 );
+     close( fd );
+     if( mapping == MAP_FAILED )
+     {
+          return kCorpusCantOpen;
+     }
+
+     corpus->mapping = mapping;
+     corpus->mapping_size = (size_t) info.st_size;
+
+     status = CorpusAttach( corpus, mapping, corpus->mapping_size );
+     if( status != kCorpusOk )
+     {
+          CorpusClose( corpus );
+     }
+     return status;
+}
+
+void CorpusClose( Corpus* corpus )
+{
+     if( corpus->mapping != NULL )
+     {
+          munmap( corpus->mapping, corpus->mapping_size );
+     }
+     memset( corpus, 0, sizeof(*corpus) );
+}
@@ -0,0 +1,191 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <signature_contest/core/src/perf_events.h>
+
+typedef struct
+{
+     const char* name;
+     unsigned int type;
+     unsigned long long config;
+} PerfEventDescription;
+
+/* There is no generic L2 event: cache references count last level cache
+ * references, which on Intel are roughly L2 misses. */
+static const PerfEventDescription descriptions[ PERF_EVENTS_MAX ] =
+{
+     { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+     { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+     { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+     { "L1-dcache-load-misses", PERF_TYPE_HW_CACHE,
+       PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+     { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+     { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+     { "task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+     { "context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+     { "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS }
+};
+
+static int PerfEventOpen( const PerfEventDescription* description, int group_fd )
+{
+     struct perf_event_attr attr;
+
+     memset( &attr, 0, sizeof(attr) );
+     attr.size = sizeof(attr);
+     attr.type = description->type;
+     attr.config = description->config;
+     attr.exclude_kernel = 1;
+     attr.exclude_hv = 1;
+     attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+     if( description->type != PERF_TYPE_SOFTWARE )
+     {
+          attr.read_format |= PERF_FORMAT_GROUP;
+     }
+
+     return (int) syscall( SYS_perf_event_open, &attr, 0, -1, group_fd, 0 );
+}
+
+/* A group which does not fit on the PMU is never scheduled, time running stays put. */
+static int PerfGroupCounts( int leader )
+{
+     unsigned long long before[ 3 + PERF_EVENTS_MAX ];     /* nr, time enabled, time running, values */
+     unsigned long long after[ 3 + PERF_EVENTS_MAX ];
+     volatile unsigned int spin;
+
+     if( read( leader, before, sizeof(before) ) <= 0 )
+     {
+          return 0;
+     }
+     for( spin = 0; spin < 1000000; spin++ )
+     {
+     }
+     if( read( leader, after, sizeof(after) ) <= 0 )
+     {
+          return 0;
+     }
+
+     return after[ 2 ] > before[ 2 ];
+}
+
+unsigned int PerfEventsOpen( PerfEvents* events )
+{
+     const PerfEventDescription* rest[ PERF_EVENTS_MAX ];
+     unsigned int rest_count = 0;
+     unsigned int i;
+
+     events->count = 0;
+     events->group_size = 0;
+     events->missing_count = 0;
+
+     /* Hardware events join the group while it still fits, the others count on their own. */
+     for( i = 0; i < PERF_EVENTS_MAX; i++ )
+     {
+          int fd;
+
+          if( descriptions[ i ].type == PERF_TYPE_SOFTWARE )
+          {
+               rest[ rest_count++ ] = &descriptions[ i ];
+               continue;
+          }
+
+          fd = PerfEventOpen( &descriptions[ i ], events->group_size > 0 ? events->fd[ 0 ] : -1 );
+          if( fd >= 0 && PerfGroupCounts( events->group_size > 0 ? events->fd[ 0 ] : fd ) )
+          {
+               events->fd[ events->count ] = fd;
+               events->name[ events->count ] = descriptions[ i ].name;
+               events->count++;
+               events->group_size++;
+               continue;
+          }
+
+          if( fd >= 0 )
+          {
+               close( fd );
+          }
+          rest[ rest_count++ ] = &descriptions[ i ];
+     }
+
+     for( i = 0; i < rest_count; i++ )
+     {
+          int fd = PerfEventOpen( rest[ i ], -1 );
+          if( fd >= 0 )
+          {
+               events->fd[ events->count ] = fd;
+               events->name[ events->count ] = rest[ i ]->name;
+               events->count++;
+          }
+          else
+          {
+               events->missing[ events->missing_count++ ] = rest[ i ]->name;
+          }
+     }
+
+     return events->count;
+}
+
+void PerfEventsRead( const PerfEvents* events, PerfEventsSample* sample )
+{
+     unsigned int i;
+
+     memset( sample, 0, sizeof(*sample) );
+
+     if( events->group_size > 0 )
+     {
+          unsigned long long data[ 3 + PERF_EVENTS_MAX ];     /* nr, time enabled, time running, values */
+          ssize_t size = (ssize_t) ( ( 3 + events->group_size ) * sizeof(data[ 0 ]) );
+
+          if( read( events->fd[ 0 ], data, sizeof(data) ) >= size && data[ 0 ] == events->group_size )
+          {
+               for( i = 0; i < events->group_size; i++ )
+               {
+                    sample->value[ i ] = data[ 3 + i ];
+                    sample->enabled[ i ] = data[ 1 ];
+                    sample->running[ i ] = data[ 2 ];
+               }
+          }
+     }
+
+     for( i = events->group_size; i < events->count; i++ )
+     {
+          unsigned long long data[ 3 ];     /* value, time enabled, time running */
+
+          if( read( events->fd[ i ], data, sizeof(data) ) == (ssize_t) sizeof(data) )
+          {
+               sample->value[ i ] = data[ 0 ];
+               sample->enabled[ i ] = data[ 1 ];
+               sample->running[ i ] = data[ 2 ];
+          }
+     }
+}
+
+void PerfEventsDelta( const PerfEvents* events, const PerfEventsSample* before,
+                      const PerfEventsSample* after, double* values )
+{
+     unsigned int i;
+
+     for( i = 0; i < events->count; i++ )
+     {
+          unsigned long long enabled = after->enabled[ i ] - before->enabled[ i ];
+          unsigned long long running = after->running[ i ] - before->running[ i ];
+
+          values[ i ] = (double) ( after->value[ i ] - before->value[ i ] );
+          if( running > 0 && running < enabled )
+          {
+               values[ i ] = values[ i ] * enabled / running;
+          }
+     }
+}
+
+void PerfEventsClose( PerfEvents* events )
+{
+     unsigned int i;
+
+     for( i = 0; i < events->count; i++ )
+     {
+          close( events->fd[ i ] );
+     }
+     events->count = 0;
+     events->group_size = 0;
+}
@@ -1,20 +1,19 @@
 #include <iostream>
 #include <iomanip>
-#include <fstream>
 #include <chrono>
+#include <vector>
 #include <string.h>
+#include <stdlib.h>
 
+#include <signature_contest/core/src/corpus.h>
 #include <signature_contest/core/src/load_dl.h>
+#include <signature_contest/core/src/perf_events.h>
+#include <signature_contest/core/src/test_entry.h>
+#include <signature_contest/core/src/throughput.h>
 
 using namespace std;
 using namespace std::chrono;
 
-#define GOST12S512_PRIVATE_KEY_SIZE 64
-#define GOST12S512_PUBLIC_KEY_SIZE 64
-#define GOST12S512_HASH_SIZE 64
-#define GOST12S512_RAND_SIZE 64
-#define GOST12S512_SIGN_SIZE 128
-
 static const char* strstatus( Gost12S512Status status )
 {
      switch( status )
@@ -46,16 +45,6 @@ static void print_sign_error( const char* context, Gost12S512Status status )
      }
 }
 
-typedef struct
-{
-     char privateKey[ GOST12S512_PRIVATE_KEY_SIZE ];
-     char publicKeyX[ GOST12S512_PUBLIC_KEY_SIZE ];
-     char publicKeyY[ GOST12S512_PUBLIC_KEY_SIZE ];
-     char rand[ GOST12S512_RAND_SIZE ];
-     char hash[ GOST12S512_HASH_SIZE ];
-     char sign[ GOST12S512_SIGN_SIZE ];
-} TestEntry;
-
 #define DUMP_BYTES_AT_ROW 16
 
 static void dump_array( const char* arr, size_t size )
@@ -117,78 +106,204 @@ static void dump_input_data( bool sign, const TestEntry& entry )
      cerr << endl;
 }
 
-static bool get_next_entry( ifstream& in_file, TestEntry& entry )
+static void usage( const char* exec_name )
+{
+     cerr << "Usage: " << exec_name << " <library> <input file> [options]" << endl;
+     cerr << "  --perf              also report performance counters per operation" << endl;
+     cerr << "  --threads N[,N...]  throughput mode: run sign and verify on N threads at once," << endl;
+     cerr << "                      for every given N, and report ops/sec and latency percentiles" << endl;
+     cerr << "  --warmup N          throughput mode: calls per thread before measuring, default 100" << endl;
+     cerr << "  --operations N      throughput mode: measured calls per thread, default 1000" << endl;
+     cerr << "  --json              throughput mode: print results as JSON" << endl;
+     cerr << "Usage: " << exec_name << " --convert <input file> <output file>" << endl;
+     cerr << "  write the input file, with or without a header, as a version " << CORPUS_VERSION << " corpus" << endl;
+}
+
+static bool parse_number( const char* str, unsigned int& value )
 {
-     in_file.read( entry.privateKey, sizeof(entry.privateKey) );
-     if( !in_file )
+     char* end;
+     unsigned long parsed = strtoul( str, &end, 10 );
+
+     if( end == str || (*end != '\0' && *end != ',') )
      {
           return false;
      }
+     value = (unsigned int) parsed;
+     return true;
+}
 
-     in_file.read( entry.publicKeyX, sizeof(entry.publicKeyX) );
-     if( !in_file )
+static bool parse_thread_counts( const char* str, std::vector< unsigned int >& counts )
+{
+     while( *str != '\0' )
      {
-          return false;
+          unsigned int count;
+          if( !parse_number( str, count ) || count == 0 )
+          {
+               return false;
+          }
+          counts.push_back( count );
+
+          str = strchr( str, ',' );
+          if( str == 0 )
+          {
+               break;
+          }
+          str++;
      }
+     return !counts.empty();
+}
+
+static PerfEvents perf_events;
+
+/* Counters are read outside of the timed region, reads are system calls. */
+#define MEASURED_CALL( func, ret, dur, counters, ... )                          \
+     do                                                                         \
+     {                                                                          \
+          high_resolution_clock::time_point before, after;                      \
+          PerfEventsSample counters_before, counters_after;                     \
+          double counters_delta[ PERF_EVENTS_MAX ];                             \
+          if( perf_events.count > 0 )                                           \
+          {                                                                     \
+               PerfEventsRead( &perf_events, &counters_before );                \
+          }                                                                     \
+          before = high_resolution_clock::now();                                \
+          ret = func( __VA_ARGS__ );                                            \
+          after = high_resolution_clock::now();                                 \
+          dur = duration_cast< nanoseconds >( after - before );                 \
+          if( perf_events.count > 0 )                                           \
+          {                                                                     \
+               PerfEventsRead( &perf_events, &counters_after );                 \
+               PerfEventsDelta( &perf_events, &counters_before,                 \
+                                &counters_after, counters_delta );              \
+               for( unsigned int i = 0; i < perf_events.count; i++ )            \
+               {                                                                \
+                    counters[ i ] += counters_delta[ i ];                       \
+               }                                                                \
+          }                                                                     \
+     } while( 0 )
 
-     in_file.read( entry.publicKeyY, sizeof(entry.publicKeyY) );
-     if( !in_file )
+static void print_counters( const char* operation, const double* counters, unsigned int test_count )
+{
+     cout << "Average " << operation << " counters:";
+     for( unsigned int i = 0; i < perf_events.count; i++ )
      {
-          return false;
+          cout << " " << perf_events.name[ i ] << " "
+               << fixed << setprecision( 0 ) << counters[ i ] / test_count;
      }
+     cout << endl;
+}
 
-     in_file.read( entry.rand, sizeof(entry.rand) );
-     if( !in_file )
+static int open_corpus( const char* path, Corpus& corpus )
+{
+     switch( CorpusOpen( path, &corpus ) )
      {
-          return false;
+          case kCorpusOk:
+               return 0;
+          case kCorpusCantOpen:
+               cerr << "Can't open file: " << path << endl;
+               return 2;
+          case kCorpusUnsupportedVersion:
+               cerr << "Input file has unsupported corpus version" << endl;
+               return 8;
+          case kCorpusBadFormat:
+               break;
      }
+     cerr << "Input file has incorrect format" << endl;
+     return 8;
+}
 
-     in_file.read( entry.hash, sizeof(entry.hash) );
-     if( !in_file )
+static int convert( const char* infile, const char* outfile )
+{
+     Corpus corpus;
+     int result = open_corpus( infile, corpus );
+     if( result != 0 )
      {
-          return false;
+          return result;
      }
 
-     in_file.read( entry.sign, sizeof(entry.sign) );
-     if( !in_file )
+     if( CorpusWrite( &corpus, outfile ) != 0 )
      {
-          return false;
+          cerr << "Can't write file: " << outfile << endl;
+          result = 2;
      }
-
-     return true;
-}
-
-static void usage( const char* exec_name )
-{
-     cerr << "Usage: " << exec_name << " <library> <input file>" << endl;
+     else
+     {
+          cout << "Wrote " << corpus.count << " entries to " << outfile << endl;
+     }
+     CorpusClose( &corpus );
+     return result;
 }
 
-#define MEASURED_CALL( func, ret, dur, ... )                          \
-     do                                                               \
-     {                                                                \
-          high_resolution_clock::time_point before, after;            \
-          before = high_resolution_clock::now();                      \
-          ret = func( __VA_ARGS__ );                                  \
-          after = high_resolution_clock::now();                       \
-          dur = duration_cast< microseconds >( after - before );      \
-     } while( 0 )
-
 int main( int argc, char* argv[] )
 {
+     if( argc == 4 && strcmp( argv[1], "--convert" ) == 0 )
+     {
+          return convert( argv[2], argv[3] );
+     }
+
      const char* libpath = argv[1];
      const char* infile  = argv[2];
 
-     if( argc != 3 )
+     bool perf = false;
+     ThroughputOptions throughput;
+     throughput.warmup = 100;
+     throughput.operations = 1000;
+     throughput.json = false;
+
+     bool options_valid = (argc >= 3);
+     for( int i = 3; options_valid && i < argc; i++ )
+     {
+          bool has_value = (i + 1 < argc);
+
+          if( strcmp( argv[i], "--perf" ) == 0 )
+          {
+               perf = true;
+          }
+          else if( strcmp( argv[i], "--json" ) == 0 )
+          {
+               throughput.json = true;
+          }
+          else if( strcmp( argv[i], "--threads" ) == 0 && has_value )
+          {
+               options_valid = parse_thread_counts( argv[++i], throughput.threads );
+          }
+          else if( strcmp( argv[i], "--warmup" ) == 0 && has_value )
+          {
+               options_valid = parse_number( argv[++i], throughput.warmup );
+          }
+          else if( strcmp( argv[i], "--operations" ) == 0 && has_value )
+          {
+               options_valid = parse_number( argv[++i], throughput.operations ) && throughput.operations > 0;
+          }
+          else
+          {
+               options_valid = false;
+          }
+     }
+
+     if( !options_valid )
      {
           usage( argv[0] );
           return 1;
      }
 
-     ifstream in_file( infile );
-     if( !in_file.is_open() )
+     /* Counters follow the calling thread, so they would miss the workers. */
+     if( perf && !throughput.threads.empty() )
      {
-          cerr << "Can't open file: " << infile << endl;
-          return 2;
+          cerr << "--perf is ignored in throughput mode" << endl;
+     }
+     else if( perf && PerfEventsOpen( &perf_events ) == 0 )
+     {
+          cerr << "Performance counters are unavailable, measuring time only" << endl;
+     }
+
+     /* The whole corpus is mapped and checked before anything is measured. */
+     Corpus corpus;
+     int corpus_result = open_corpus( infile, corpus );
+     if( corpus_result != 0 )
+     {
+          PerfEventsClose( &perf_events );
+          return corpus_result;
      }
 
      Gost12S512Init_t Gost12S512Init;
@@ -200,7 +315,7 @@ int main( int argc, char* argv[] )
      if( dl_handle == 0 )
      {
           cerr << "Incorrect library: " << libpath << endl;
-          in_file.close();
+          CorpusClose( &corpus );
           return 3;
      }
 
@@ -213,25 +328,38 @@ int main( int argc, char* argv[] )
           {
                print_sign_error( INIT_FUNCTION_NAME, status );
                Gost12S512DlCleanup( dl_handle );
-               in_file.close();
+               CorpusClose( &corpus );
                return 4;
           }
      }
 
+     if( !throughput.threads.empty() )
+     {
+          int result = RunThroughput( throughput, libpath, corpus, Gost12S512Sign, Gost12S512Verify );
+          Gost12S512DlCleanup( dl_handle );
+          CorpusClose( &corpus );
+          PerfEventsClose( &perf_events );
+          return result;
+     }
+
      char signature[ GOST12S512_SIGN_SIZE ];
 
-     microseconds sign_duration( 0 );
-     microseconds verify_true_duration( 0 );
-     microseconds verify_false_duration( 0 );
+     nanoseconds sign_duration( 0 );
+     nanoseconds verify_true_duration( 0 );
+     nanoseconds verify_false_duration( 0 );
+     double sign_counters[ PERF_EVENTS_MAX ] = { 0 };
+     double verify_true_counters[ PERF_EVENTS_MAX ] = { 0 };
+     double verify_false_counters[ PERF_EVENTS_MAX ] = { 0 };
      unsigned int test_count = 0;
-     TestEntry entry;
 
-     while( get_next_entry( in_file, entry ) )
+     for( ; test_count < corpus.count; test_count++ )
      {
-          microseconds duration;
+          const TestEntry& entry = *CorpusEntry( &corpus, test_count );
+          char wrong_hash[ GOST12S512_HASH_SIZE ];
+          nanoseconds duration;
 
           // Sign test
-          MEASURED_CALL( Gost12S512Sign, status, duration,
+          MEASURED_CALL( Gost12S512Sign, status, duration, sign_counters,
                          entry.privateKey, entry.rand, entry.hash, signature );
           if( status != kStatusOk ||
               memcmp( signature, entry.sign, sizeof(entry.sign) ) != 0 )
@@ -248,13 +376,13 @@ int main( int argc, char* argv[] )
                dump_array(signature, sizeof(entry.sign));
 
                Gost12S512DlCleanup( dl_handle );
-               in_file.close();
+               CorpusClose( &corpus );
                return 5;
           }
           sign_duration += duration;
 
           // Verify test (with correct data)
-          MEASURED_CALL( Gost12S512Verify, status, duration,
+          MEASURED_CALL( Gost12S512Verify, status, duration, verify_true_counters,
                          entry.publicKeyX, entry.publicKeyY, entry.hash, entry.sign );
           if( status == kStatusWrongSignature )
           {
@@ -266,54 +394,57 @@ int main( int argc, char* argv[] )
                cerr << endl;
                dump_input_data( false, entry );
                Gost12S512DlCleanup( dl_handle );
-               in_file.close();
+               CorpusClose( &corpus );
                return 6;
           }
           verify_true_duration += duration;
 
           // Verify test (with incorrect data)
-          entry.hash[ test_count % sizeof(entry.hash) ] ^= 0xFF;
+          memcpy( wrong_hash, entry.hash, sizeof(wrong_hash) );
+          wrong_hash[ test_count % sizeof(wrong_hash) ] ^= 0xFF;
 
-          MEASURED_CALL( Gost12S512Verify, status, duration,
-                         entry.publicKeyX, entry.publicKeyY, entry.hash, entry.sign );
+          MEASURED_CALL( Gost12S512Verify, status, duration, verify_false_counters,
+                         entry.publicKeyX, entry.publicKeyY, wrong_hash, entry.sign );
           if( status == kStatusOk )
           {
                cerr << "Incorrect signature was treated as correct" << endl;
           }
           if( status != kStatusWrongSignature )
           {
+               TestEntry wrong_entry = entry;
+               memcpy( wrong_entry.hash, wrong_hash, sizeof(wrong_hash) );
+
                print_sign_error( VERIFY_FUNCTION_NAME, status );
                cerr << endl;
-               dump_input_data( false, entry );
+               dump_input_data( false, wrong_entry );
                Gost12S512DlCleanup( dl_handle );
-               in_file.close();
+               CorpusClose( &corpus );
                return 7;
           }
           verify_false_duration += duration;
-
-          test_count++;
      }
 
      Gost12S512DlCleanup( dl_handle );
+     CorpusClose( &corpus );
 
-     if( !in_file.eof() )
-     {
-          cerr << "Input file has incorrect format" << endl;
-          in_file.close();
-          return 8;
-     }
-
-     in_file.close();
-
-     cout << "Average sign time: " << sign_duration.count() / test_count
+     cout << fixed << setprecision( 3 );
+     cout << "Average sign time: " << sign_duration.count() / 1000.0 / test_count
           << " microseconds" << endl;
      cout << "Average correct signature verification time "
-          << verify_true_duration.count() / test_count
+          << verify_true_duration.count() / 1000.0 / test_count
           << " microseconds" << endl;
      cout << "Average incorrect signature verification time "
-          << verify_false_duration.count() / test_count
+          << verify_false_duration.count() / 1000.0 / test_count
           << " microseconds" << endl;
 
+     if( perf_events.count > 0 )
+     {
+          print_counters( "sign", sign_counters, test_count );
+          print_counters( "correct signature verification", verify_true_counters, test_count );
+          print_counters( "incorrect signature verification", verify_false_counters, test_count );
+     }
+     PerfEventsClose( &perf_events );
+
      return 0;
 }
 
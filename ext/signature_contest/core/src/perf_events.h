@@ -0,0 +1,54 @@
+#ifndef PERF_EVENTS_H
+#define PERF_EVENTS_H
+
+/* Hardware performance counters of the calling thread (Linux perf_event_open).
+ * Events the system does not offer, e.g. hardware events inside most virtual
+ * machines, are skipped; on other platforms no events are available at all. */
+
+#define PERF_EVENTS_MAX 9
+
+typedef struct
+{
+     int fd[ PERF_EVENTS_MAX ];
+     const char* name[ PERF_EVENTS_MAX ];
+     unsigned int count;
+     /* The first group_size events are hardware events the kernel schedules together,
+      * as many as fit on the PMU, so their ratios hold under multiplexing. */
+     unsigned int group_size;
+     /* Events the system refused. */
+     const char* missing[ PERF_EVENTS_MAX ];
+     unsigned int missing_count;
+} PerfEvents;
+
+/* Counts since the events were opened, with the times in nanoseconds each event was
+ * enabled and actually counting. Scaling cumulative values by the current ratio would
+ * misattribute multiplexing to earlier intervals, so only differences are scaled. */
+typedef struct
+{
+     unsigned long long value[ PERF_EVENTS_MAX ];
+     unsigned long long enabled[ PERF_EVENTS_MAX ];
+     unsigned long long running[ PERF_EVENTS_MAX ];
+} PerfEventsSample;
+
+#ifdef __cplusplus
+extern "C" {
+#endif //__cplusplus
+
+/* Returns the number of events opened, zero if counters are unavailable. */
+unsigned int PerfEventsOpen( PerfEvents* events );
+
+/* Stores events->count raw values, unscaled. */
+void PerfEventsRead( const PerfEvents* events, PerfEventsSample* sample );
+
+/* Stores events->count differences between two samples. Each difference is scaled by
+ * the share of the interval its event actually counted, if the kernel multiplexed it. */
+void PerfEventsDelta( const PerfEvents* events, const PerfEventsSample* before,
+                      const PerfEventsSample* after, double* values );
+
+void PerfEventsClose( PerfEvents* events );
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#endif /* PERF_EVENTS_H */
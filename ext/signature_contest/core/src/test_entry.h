@@ -0,0 +1,20 @@
+#ifndef TEST_ENTRY_H
+#define TEST_ENTRY_H
+
+#define GOST12S512_PRIVATE_KEY_SIZE 64
+#define GOST12S512_PUBLIC_KEY_SIZE 64
+#define GOST12S512_HASH_SIZE 64
+#define GOST12S512_RAND_SIZE 64
+#define GOST12S512_SIGN_SIZE 128
+
+typedef struct
+{
+     char privateKey[ GOST12S512_PRIVATE_KEY_SIZE ];
+     char publicKeyX[ GOST12S512_PUBLIC_KEY_SIZE ];
+     char publicKeyY[ GOST12S512_PUBLIC_KEY_SIZE ];
+     char rand[ GOST12S512_RAND_SIZE ];
+     char hash[ GOST12S512_HASH_SIZE ];
+     char sign[ GOST12S512_SIGN_SIZE ];
+} TestEntry;
+
+#endif /* TEST_ENTRY_H */
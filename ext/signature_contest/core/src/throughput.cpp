@@ -0,0 +1,436 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_TSC
+#endif
+
+#include <signature_contest/core/src/throughput.h>
+
+using namespace std;
+using namespace std::chrono;
+
+static inline uint64_t read_tsc()
+{
+#ifdef HAVE_TSC
+     return __rdtsc();
+#else
+     return 0;
+#endif
+}
+
+/* Log-linear latency histogram: values below 64 ns are exact, larger ones
+ * fall into 32 buckets per power of two, i.e. within 3% of the value. */
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_SUB_COUNT (1u << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS) * HISTOGRAM_SUB_COUNT)
+
+class LatencyHistogram
+{
+public:
+     LatencyHistogram()
+          : buckets( HISTOGRAM_BUCKETS, 0 ), count( 0 ), sum( 0 ), cycles( 0 ), min( UINT64_MAX ), max( 0 )
+     {
+     }
+
+     void add( uint64_t ns, uint64_t tsc )
+     {
+          buckets[ index( ns ) ]++;
+          count++;
+          sum += ns;
+          cycles += tsc;
+          min = std::min( min, ns );
+          max = std::max( max, ns );
+     }
+
+     void merge( const LatencyHistogram& other )
+     {
+          for( size_t i = 0; i < buckets.size(); i++ )
+          {
+               buckets[ i ] += other.buckets[ i ];
+          }
+          count += other.count;
+          sum += other.sum;
+          cycles += other.cycles;
+          min = std::min( min, other.min );
+          max = std::max( max, other.max );
+     }
+
+     /* Upper bound of the bucket holding the given fraction of calls. */
+     uint64_t percentile( double fraction ) const
+     {
+          uint64_t rank = (uint64_t) (fraction * count + 0.5);
+          uint64_t seen = 0;
+
+          rank = std::max< uint64_t >( rank, 1 );
+          for( size_t i = 0; i < buckets.size(); i++ )
+          {
+               seen += buckets[ i ];
+               if( seen >= rank )
+               {
+                    return std::min( upper( i ), max );
+               }
+          }
+          return max;
+     }
+
+     static uint64_t upper( size_t i )
+     {
+          if( i < 2 * HISTOGRAM_SUB_COUNT )
+          {
+               return i;
+          }
+
+          unsigned int shift = (unsigned int) (i / HISTOGRAM_SUB_COUNT) - 1;
+          uint64_t mantissa = i % HISTOGRAM_SUB_COUNT + HISTOGRAM_SUB_COUNT;
+          return ((mantissa + 1) << shift) - 1;
+     }
+
+     std::vector< uint64_t > buckets;
+     uint64_t count;
+     uint64_t sum;
+     uint64_t cycles;
+     uint64_t min;
+     uint64_t max;
+
+private:
+     static size_t index( uint64_t ns )
+     {
+          if( ns < 2 * HISTOGRAM_SUB_COUNT )
+          {
+               return (size_t) ns;
+          }
+
+          unsigned int msb = 63;
+          while( (ns >> msb) == 0 )
+          {
+               msb--;
+          }
+
+          unsigned int shift = msb - HISTOGRAM_SUB_BITS;
+          return (shift + 1) * HISTOGRAM_SUB_COUNT + (size_t) ((ns >> shift) - HISTOGRAM_SUB_COUNT);
+     }
+};
+
+/* Lets the measured phase of all threads start together, after every one of
+ * them has warmed up. */
+class StartBarrier
+{
+public:
+     explicit StartBarrier( unsigned int parties )
+          : waiting( parties )
+     {
+     }
+
+     /* The last thread to arrive takes the start time. */
+     void arrive( steady_clock::time_point& start )
+     {
+          unique_lock< mutex > lock( guard );
+          if( --waiting == 0 )
+          {
+               start = steady_clock::now();
+               released.notify_all();
+               return;
+          }
+          released.wait( lock, [this]() { return waiting == 0; } );
+     }
+
+private:
+     mutex guard;
+     condition_variable released;
+     unsigned int waiting;
+};
+
+typedef enum
+{
+     kOperationSign,
+     kOperationVerify
+} Operation;
+
+static const char* operation_name( Operation operation )
+{
+     return (operation == kOperationSign) ? "sign" : "verify";
+}
+
+typedef struct
+{
+     unsigned int threads;
+     Operation operation;
+     double seconds;
+     uint64_t errors;
+     LatencyHistogram latency;
+} ThroughputRun;
+
+static uint64_t call( Operation operation, const TestEntry& entry, Gost12S512Sign_t sign, Gost12S512Verify_t verify )
+{
+     if( operation == kOperationSign )
+     {
+          char signature[ GOST12S512_SIGN_SIZE ];
+          Gost12S512Status status = sign( entry.privateKey, entry.rand, entry.hash, signature );
+          return (status != kStatusOk || memcmp( signature, entry.sign, sizeof(signature) ) != 0) ? 1 : 0;
+     }
+
+     return (verify( entry.publicKeyX, entry.publicKeyY, entry.hash, entry.sign ) != kStatusOk) ? 1 : 0;
+}
+
+static void worker( unsigned int id,
+                    ThroughputRun& run,
+                    const ThroughputOptions& options,
+                    const Corpus& corpus,
+                    Gost12S512Sign_t sign,
+                    Gost12S512Verify_t verify,
+                    StartBarrier& barrier,
+                    steady_clock::time_point& start,
+                    LatencyHistogram& latency,
+                    uint64_t& errors )
+{
+     /* Threads cycle over their own shard so that they don't work on the same
+      * data. With more threads than entries they share single entries. */
+     size_t first, count;
+     CorpusShard( &corpus, id, run.threads, &first, &count );
+     if( count == 0 )
+     {
+          first = id % corpus.count;
+          count = 1;
+     }
+     size_t next = 0;
+
+     for( unsigned int i = 0; i < options.warmup; i++ )
+     {
+          errors += call( run.operation, *CorpusEntry( &corpus, first + next ), sign, verify );
+          next = (next + 1) % count;
+     }
+
+     barrier.arrive( start );
+
+     for( unsigned int i = 0; i < options.operations; i++ )
+     {
+          const TestEntry& entry = *CorpusEntry( &corpus, first + next );
+          next = (next + 1) % count;
+
+          steady_clock::time_point before = steady_clock::now();
+          uint64_t tsc_before = read_tsc();
+          errors += call( run.operation, entry, sign, verify );
+          uint64_t tsc_after = read_tsc();
+          steady_clock::time_point after = steady_clock::now();
+
+          latency.add( (uint64_t) duration_cast< nanoseconds >( after - before ).count(), tsc_after - tsc_before );
+     }
+}
+
+static void measure( ThroughputRun& run,
+                     const ThroughputOptions& options,
+                     const Corpus& corpus,
+                     Gost12S512Sign_t sign,
+                     Gost12S512Verify_t verify )
+{
+     StartBarrier barrier( run.threads );
+     steady_clock::time_point start;
+     std::vector< LatencyHistogram > latencies( run.threads );
+     std::vector< uint64_t > errors( run.threads, 0 );
+     std::vector< std::thread > threads;
+
+     for( unsigned int i = 0; i < run.threads; i++ )
+     {
+          threads.push_back( std::thread( worker, i, std::ref( run ), std::cref( options ), std::cref( corpus ),
+                                          sign, verify, std::ref( barrier ), std::ref( start ),
+                                          std::ref( latencies[ i ] ), std::ref( errors[ i ] ) ) );
+     }
+     for( size_t i = 0; i < threads.size(); i++ )
+     {
+          threads[ i ].join();
+     }
+
+     run.seconds = duration< double >( steady_clock::now() - start ).count();
+     run.errors = 0;
+     for( unsigned int i = 0; i < run.threads; i++ )
+     {
+          run.latency.merge( latencies[ i ] );
+          run.errors += errors[ i ];
+     }
+}
+
+static double ops_per_second( const ThroughputRun& run )
+{
+     return (run.seconds > 0) ? run.latency.count / run.seconds : 0;
+}
+
+static const double percentiles[] = { 0.5, 0.9, 0.99, 0.999 };
+static const char* const percentile_names[] = { "p50", "p90", "p99", "p99.9" };
+
+static void print_table( const std::vector< ThroughputRun >& runs )
+{
+     cout << setw( 8 ) << "threads" << setw( 10 ) << "operation" << setw( 12 ) << "ops/sec";
+     for( size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++ )
+     {
+          cout << setw( 10 ) << percentile_names[ i ] << " us";
+     }
+     cout << setw( 14 ) << "mean cycles" << setw( 8 ) << "errors" << endl;
+
+     for( size_t r = 0; r < runs.size(); r++ )
+     {
+          const ThroughputRun& run = runs[ r ];
+          const LatencyHistogram& latency = run.latency;
+
+          cout << setw( 8 ) << run.threads << setw( 10 ) << operation_name( run.operation )
+               << setw( 12 ) << fixed << setprecision( 1 ) << ops_per_second( run );
+          for( size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++ )
+          {
+               cout << setw( 13 ) << setprecision( 1 ) << latency.percentile( percentiles[ i ] ) / 1000.0;
+          }
+          cout << setw( 14 ) << setprecision( 0 ) << (latency.count ? (double) latency.cycles / latency.count : 0.0)
+               << setw( 8 ) << run.errors << endl;
+     }
+}
+
+/* Quoted JSON string; paths may hold quotes, backslashes and control characters. */
+static void print_json_string( const char* value )
+{
+     static const char hex[] = "0123456789abcdef";
+
+     cout << '"';
+     for( ; *value != '\0'; value++ )
+     {
+          unsigned char c = (unsigned char) *value;
+          switch( c )
+          {
+               case '"':
+                    cout << "\\\"";
+                    break;
+               case '\\':
+                    cout << "\\\\";
+                    break;
+               case '\n':
+                    cout << "\\n";
+                    break;
+               case '\r':
+                    cout << "\\r";
+                    break;
+               case '\t':
+                    cout << "\\t";
+                    break;
+               default:
+                    if( c < 0x20 )
+                    {
+                         cout << "\\u00" << hex[ c >> 4 ] << hex[ c & 0xf ];
+                    }
+                    else
+                    {
+                         cout << (char) c;
+                    }
+          }
+     }
+     cout << '"';
+}
+
+static void print_json( const std::vector< ThroughputRun >& runs, const ThroughputOptions& options, const char* libpath )
+{
+     cout << "{" << endl;
+     cout << "  \"library\": ";
+     print_json_string( libpath );
+     cout << "," << endl;
+     cout << "  \"warmup\": " << options.warmup << "," << endl;
+     cout << "  \"operations\": " << options.operations << "," << endl;
+     cout << "  \"tsc\": " <<
+#ifdef HAVE_TSC
+          "true"
+#else
+          "false"
+#endif
+          << "," << endl;
+     cout << "  \"runs\": [" << endl;
+
+     for( size_t r = 0; r < runs.size(); r++ )
+     {
+          const ThroughputRun& run = runs[ r ];
+          const LatencyHistogram& latency = run.latency;
+
+          cout << "    {\"threads\": " << run.threads
+               << ", \"operation\": \"" << operation_name( run.operation ) << "\""
+               << ", \"calls\": " << latency.count
+               << ", \"errors\": " << run.errors
+               << ", \"seconds\": " << fixed << setprecision( 6 ) << run.seconds
+               << ", \"ops_per_sec\": " << setprecision( 3 ) << ops_per_second( run )
+               << ", \"mean_cycles\": " << setprecision( 1 ) << (latency.count ? (double) latency.cycles / latency.count : 0.0)
+               << ", \"latency_ns\": {\"min\": " << (latency.count ? latency.min : 0)
+               << ", \"mean\": " << setprecision( 1 ) << (latency.count ? (double) latency.sum / latency.count : 0.0)
+               << ", \"max\": " << latency.max;
+          for( size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++ )
+          {
+               cout << ", \"" << percentile_names[ i ] << "\": " << latency.percentile( percentiles[ i ] );
+          }
+          cout << "}, \"histogram\": [";
+
+          bool first = true;
+          for( size_t i = 0; i < latency.buckets.size(); i++ )
+          {
+               if( latency.buckets[ i ] == 0 )
+               {
+                    continue;
+               }
+               cout << (first ? "" : ", ") << "[" << LatencyHistogram::upper( i ) << ", " << latency.buckets[ i ] << "]";
+               first = false;
+          }
+          cout << "]}" << (r + 1 < runs.size() ? "," : "") << endl;
+     }
+
+     cout << "  ]" << endl << "}" << endl;
+}
+
+int RunThroughput( const ThroughputOptions& options,
+                   const char* libpath,
+                   const Corpus& corpus,
+                   Gost12S512Sign_t sign,
+                   Gost12S512Verify_t verify )
+{
+     std::vector< ThroughputRun > runs;
+     uint64_t errors = 0;
+
+     for( size_t t = 0; t < options.threads.size(); t++ )
+     {
+          const Operation operations[] = { kOperationSign, kOperationVerify };
+
+          for( size_t o = 0; o < sizeof(operations) / sizeof(operations[0]); o++ )
+          {
+               ThroughputRun run;
+               run.threads = options.threads[ t ];
+               run.operation = operations[ o ];
+               measure( run, options, corpus, sign, verify );
+
+               if( !options.json )
+               {
+                    cerr << run.threads << " threads, " << operation_name( run.operation ) << ": "
+                         << fixed << setprecision( 1 ) << ops_per_second( run ) << " ops/sec" << endl;
+               }
+               errors += run.errors;
+               runs.push_back( run );
+          }
+     }
+
+     if( options.json )
+     {
+          print_json( runs, options, libpath );
+     }
+     else
+     {
+          print_table( runs );
+     }
+
+     if( errors > 0 )
+     {
+          cerr << errors << " calls failed or produced wrong results" << endl;
+          return 9;
+     }
+     return 0;
+}
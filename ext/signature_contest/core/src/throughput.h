@@ -0,0 +1,31 @@
+#ifndef THROUGHPUT_H
+#define THROUGHPUT_H
+
+#include <vector>
+
+#include <signature_contest/core/src/load_dl.h>
+#include <signature_contest/core/src/corpus.h>
+
+/* Throughput and latency mode: for every thread count the library is driven
+ * by that many threads at once, first signing, then verifying. Each thread
+ * warms up, waits for the others and then times every call. Threads work on
+ * their own shard of the corpus. */
+
+typedef struct
+{
+     std::vector< unsigned int > threads;
+     /* Calls per thread and operation before measuring. */
+     unsigned int warmup;
+     /* Measured calls per thread and operation. */
+     unsigned int operations;
+     bool json;
+} ThroughputOptions;
+
+/* Returns 0 on success, 9 if any call failed or produced a wrong result. */
+int RunThroughput( const ThroughputOptions& options,
+                   const char* libpath,
+                   const Corpus& corpus,
+                   Gost12S512Sign_t sign,
+                   Gost12S512Verify_t verify );
+
+#endif /* THROUGHPUT_H */
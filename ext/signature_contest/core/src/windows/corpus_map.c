@@ -0,0 +1,84 @@
+#include <signature_contest/core/src/windows/targetver.h>
+
+#include <windows.h>
+#include <string.h>
+
+#include <signature_contest/core/src/corpus.h>
+
+CorpusStatus CorpusOpen( const char* path, Corpus* corpus )
+{
+     LARGE_INTEGER size;
+     CorpusStatus status;
+     HANDLE file;
+     HANDLE mapping;
+     void* view;
+
+     memset( corpus, 0, sizeof(*corpus) );
+
+     file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+     if( file == INVALID_HANDLE_VALUE )
+     {
+          return kCorpusCantOpen;
+     }
+     if( !GetFileSizeEx( file, &size ) )
+     {
+          CloseHandle( file );
+          return kCorpusCantOpen;
+     }
+     if( size.QuadPart == 0 )
+     {
+          CloseHandle( file );
+          return kCorpusBadFormat;
+     }
+
+     mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+     CloseHandle( file );
+     if( mapping == NULL )
+     {
+          return kCorpusCantOpen;
+     }
+
+     view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+     if( view == NULL )
+     {
+          CloseHandle( mapping );
+          return kCorpusCantOpen;
+     }
+
+     corpus->mapping = view;
+     corpus->mapping_size = (size_t) size.QuadPart;
+     corpus->handle = mapping;
+
+     /* Touch every page now, not during measurements. */
+     {
+          volatile const char* bytes = (volatile const char*) view;
+          size_t offset;
+          char sum = 0;
+
+          for( offset = 0; offset < corpus->mapping_size; offset += 4096 )
+          {
+               sum ^= bytes[ offset ];
+          }
+          (void) sum;
+     }
+
+     status = CorpusAttach( corpus, view, corpus->mapping_size );
+     if( status != kCorpusOk )
+     {
+          CorpusClose( corpus );
+     }
+     return status;
+}
+
+void CorpusClose( Corpus* corpus )
+{
+     if( corpus->mapping != NULL )
+     {
+          UnmapViewOfFile( corpus->mapping );
+     }
+     if( corpus->handle != NULL )
+     {
+          CloseHandle( (HANDLE) corpus->handle );
+     }
+     memset( corpus, 0, sizeof(*corpus) );
+}
@@ -0,0 +1,31 @@
+#include <signature_contest/core/src/perf_events.h>
+
+unsigned int PerfEventsOpen( PerfEvents* events )
+{
+     events->count = 0;
+     events->group_size = 0;
+     events->missing_count = 0;
+     return 0;
+}
+
+void PerfEventsRead( const PerfEvents* events, PerfEventsSample* sample )
+{
+     (void) events;
+     (void) sample;
+}
+
+void PerfEventsDelta( const PerfEvents* events, const PerfEventsSample* before,
+                      const PerfEventsSample* after, double* values )
+{
+     (void) events;
+     (void) before;
+     (void) after;
+     (void) values;
+}
+
+void PerfEventsClose( PerfEvents* events )
+{
+     events->count = 0;
+     events->group_size = 0;
+     events->missing_count = 0;
+}
@@ -0,0 +1,122 @@
+#ifndef ALIGNED_H
+#define ALIGNED_H
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace gost_ecc {
+
+/**
+ * @brief Size of a cache line on the target platforms.
+ */
+const std::size_t cache_line = 64;
+
+/**
+ * @brief Deleter for objects allocated by aligned_new() and aligned_array.
+ */
+template <typename T>
+struct aligned_delete {
+    aligned_delete() = default;
+
+    template <typename U>
+    aligned_delete(const aligned_delete<U>&)
+    {}
+
+    void operator()(T* ptr) const {
+        if (ptr != nullptr) {
+            ptr->~T();
+            std::free(const_cast<void*>(static_cast<const void*>(ptr)));
+        }
+    }
+};
+
+template <typename T>
+using aligned_ptr = std::unique_ptr<T, aligned_delete<T> >;
+
+/**
+ * @brief Allocate object on its own cache lines.
+ *
+ * Allocation starts at a cache line boundary and is padded to a whole number of lines, so no
+ * other heap object can share a line with it. Useful for large read-mostly objects accessed
+ * from many threads, and for per-thread state.
+ */
+template <typename T, typename... Args>
+aligned_ptr<T> aligned_new(Args&&... args) {
+    const std::size_t size = (sizeof(T) + cache_line - 1) / cache_line * cache_line;
+    void* memory = nullptr;
+    if (posix_memalign(&memory, cache_line, size) != 0) {
+        throw std::bad_alloc();
+    }
+
+    try {
+        return aligned_ptr<T>(new (memory) T(std::forward<Args>(args)...));
+    } catch (...) {
+        std::free(memory);
+        throw;
+    }
+}
+
+/**
+ * @brief Fixed size array of default-constructed objects, each starting at a cache line boundary.
+ *
+ * Unlike std::vector it doesn't require T to be movable, so it can hold mutexes and atomics.
+ */
+template <typename T>
+class aligned_array {
+    static const std::size_t stride = (sizeof(T) + cache_line - 1) / cache_line * cache_line;
+
+    char* _data;
+    std::size_t _size;
+
+    void destroy() {
+        while (_size > 0) {
+            (*this)[--_size].~T();
+        }
+        std::free(_data);
+    }
+
+public:
+    explicit aligned_array(std::size_t size)
+        :_data(nullptr), _size(0)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, cache_line, stride * size) != 0) {
+            throw std::bad_alloc();
+        }
+        _data = static_cast<char*>(memory);
+
+        try {
+            for (; _size < size; _size++) {
+                new (_data + stride * _size) T();
+            }
+        } catch (...) {
+            this->destroy();
+            throw;
+        }
+    }
+
+    aligned_array(const aligned_array&) = delete;
+    aligned_array& operator=(const aligned_array&) = delete;
+
+    ~aligned_array() {
+        this->destroy();
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    T& operator[](std::size_t i) {
+        return *reinterpret_cast<T*>(_data + stride * i);
+    }
+
+    const T& operator[](std::size_t i) const {
+        return *reinterpret_cast<const T*>(_data + stride * i);
+    }
+};
+
+}
+
+#endif // ALIGNED_H
@@ -0,0 +1,103 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace gost_ecc {
+
+/**
+ * @brief Blocking multi-producer multi-consumer queue of limited capacity.
+ *
+ * Links stages of a pipeline: a full queue stops its producers, so a slow stage limits the
+ * memory held by the faster ones. Producers call close() when done, consumers then drain the
+ * remaining items and get false from pop().
+ */
+template <typename T>
+class bounded_queue {
+public:
+    explicit bounded_queue(std::size_t capacity)
+        :capacity(capacity), closed(false)
+    {}
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+    /**
+     * @brief Wait for free space and append item.
+     * @return false if the queue is closed, item is left untouched then.
+     */
+    bool push(T& item) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->not_full.wait(lock, [this]() {
+            return this->items.size() < this->capacity || this->closed;
+        });
+
+        if (this->closed) {
+            return false;
+        }
+
+        this->items.push_back(std::move(item));
+        lock.unlock();
+        this->not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Wait for an item.
+     * @return false if the queue is closed and empty.
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->not_empty.wait(lock, [this]() {
+            return !this->items.empty() || this->closed;
+        });
+
+        return this->take(item, lock);
+    }
+
+    /**
+     * @brief Take an item only if one is available right away.
+     */
+    bool try_pop(T& item) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        return this->take(item, lock);
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closed = true;
+        }
+        this->not_empty.notify_all();
+        this->not_full.notify_all();
+    }
+
+private:
+    bool take(T& item, std::unique_lock<std::mutex>& lock) {
+        if (this->items.empty()) {
+            return false;
+        }
+
+        item = std::move(this->items.front());
+        this->items.pop_front();
+        lock.unlock();
+        this->not_full.notify_one();
+        return true;
+    }
+
+    const std::size_t capacity;
+
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<T> items;
+    bool closed;
+};
+
+}
+
+#endif // BOUNDED_QUEUE_H
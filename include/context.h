@@ -0,0 +1,127 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <sign_engine_ext.h>
+#include <signature.h>
+#include <thread_pool.h>
+#include <spin_worker.h>
+#include <aligned.h>
+#include <numa.h>
+#include <striped_cache.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Engine context behind the C interface.
+ *
+ * Everything reachable from the context is read-only after construction except for
+ * internally synchronized caches, see sign_engine_ext.h.
+ * Engine and each of its tables are allocated on their own cache lines, so worker threads
+ * sharing the tables never contend with writes to neighbouring heap objects.
+ */
+struct Gost12S512Ctx {
+    Gost12S512ParamSet paramset;
+    Gost12S512CtxOptions options;
+    ::gost_ecc::aligned_ptr<const ::gost_ecc::signature> engine;
+
+    /**
+     * Copies of engine in memory of each NUMA node, empty unless kGost12S512CtxNumaReplicate.
+     */
+    std::vector< ::gost_ecc::numa::node_ptr<const ::gost_ecc::signature> > replicas;
+
+    std::unique_ptr< ::gost_ecc::thread_pool> pool;
+    std::unique_ptr< ::gost_ecc::spin_worker> helper;
+
+    /**
+     * X coordinate and parity of Y of a compressed public key.
+     */
+    struct compressed_key {
+        std::array<uint64_t, 8> x;
+        bool y_odd;
+
+        bool operator ==(const compressed_key& that) const {
+            return this->x == that.x && this->y_odd == that.y_odd;
+        }
+    };
+
+    /**
+     * @brief Multiply-xor fingerprint of limbs, seeded once per process.
+     *
+     * Keys of the caches come from peers, the unknown seed keeps them from choosing inputs
+     * which all land in one stripe or bucket.
+     */
+    static uint64_t fingerprint(const uint64_t* limbs, std::size_t count, uint64_t tweak);
+
+    struct compressed_key_hash {
+        std::size_t operator()(const compressed_key& key) const {
+            return static_cast<std::size_t>(fingerprint(key.x.data(), key.x.size(), key.y_odd));
+        }
+    };
+
+    /**
+     * Decompressed Y coordinates, null if options.keyCacheSize is 0.
+     */
+    std::unique_ptr< ::gost_ecc::striped_cache<compressed_key, std::array<uint64_t, 8>, compressed_key_hash> > key_cache;
+
+    /**
+     * Complete input of a verification: public key, hash and signature.
+     */
+    struct verify_input {
+        std::array<uint64_t, 40> data;
+
+        bool operator ==(const verify_input& that) const {
+            return this->data == that.data;
+        }
+    };
+
+    struct verify_input_hash {
+        std::size_t operator()(const verify_input& input) const {
+            return static_cast<std::size_t>(fingerprint(input.data.data(), input.data.size(), 0));
+        }
+    };
+
+    /**
+     * Results of verifications, null if options.verifyCacheSize is 0. Entries keep the whole
+     * input, so a fingerprint collision can't return a wrong result.
+     */
+    std::unique_ptr< ::gost_ecc::striped_cache<verify_input, Gost12S512Status, verify_input_hash> > verify_cache;
+
+    /**
+     * @brief Verify jobs with the local engine, skipping inputs found in verify_cache.
+     */
+    void verify(Gost12S512VerifyJob* jobs, std::size_t count) const;
+
+    /**
+     * @brief Look up a single verification in verify_cache.
+     */
+    bool find_verified(const Gost12S512VerifyJob& job, verify_input& input, Gost12S512Status& status) const;
+
+    /**
+     * @brief Store result of a verification in verify_cache according to options.
+     */
+    void remember_verified(const verify_input& input, Gost12S512Status status) const;
+
+    /**
+     * @brief Engine with tables closest to the calling thread.
+     */
+    const ::gost_ecc::signature& local_engine() const {
+        if (!this->replicas.empty()) {
+            return *this->replicas[::gost_ecc::numa::current_node() % this->replicas.size()];
+        }
+        return *this->engine;
+    }
+
+    /**
+     * @brief Pin library-owned worker thread to a node, spreading workers evenly between replicas.
+     */
+    void bind_worker(unsigned index) const {
+        if (!this->replicas.empty()) {
+            ::gost_ecc::numa::bind_thread(index % this->replicas.size());
+        }
+    }
+};
+
+#endif // CONTEXT_H
@@ -14,6 +14,20 @@ extern uint64_t y[8];
 extern uint64_t x0[8];
 extern uint64_t y0[8];
 
+/**
+ * Curve of id-tc26-gost-3410-12-512-paramSetB, the globals above are paramSetA.
+ */
+namespace paramset_b {
+
+extern uint64_t p[8];
+extern uint64_t a[8];
+extern uint64_t b[8];
+extern uint64_t q[8];
+extern uint64_t x0[8];
+extern uint64_t y0[8];
+
+}
+
 }
 
 #endif // CURVE_H
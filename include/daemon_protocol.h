@@ -0,0 +1,158 @@
+#ifndef DAEMON_PROTOCOL_H
+#define DAEMON_PROTOCOL_H
+
+#include <sign_engine.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace gost_ecc {
+
+/**
+ * @brief Wire format of gost_ecc_daemon, spoken over a local SOCK_STREAM Unix socket.
+ *
+ * Client sends fixed-size requests and gets one response per request, in any order when
+ * requests are pipelined, matched by id. Both sides run on the same host, so structures are
+ * sent in native byte order and layout. Numbers inside are little-endian as in sign_engine.h.
+ */
+namespace protocol {
+
+const char* const socket_name = "gost_ecc.sock";
+
+/**
+ * @brief Environment variable which overrides default_socket() for clients.
+ */
+const char* const socket_variable = "GOST_ECC_SOCKET";
+
+/**
+ * @brief Environment variable with the time in milliseconds a client waits for the daemon to
+ * take a request or to respond, call_timeout_ms by default.
+ */
+const char* const timeout_variable = "GOST_ECC_TIMEOUT_MS";
+
+const unsigned call_timeout_ms = 10000;
+
+/**
+ * @brief Directory of the default socket, accessible to the user only: $XDG_RUNTIME_DIR, or
+ * /tmp/gost_ecc-UID created by the daemon with mode 0700.
+ */
+inline std::string default_directory() {
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime != nullptr && *runtime != '\0') {
+        return runtime;
+    }
+    return "/tmp/gost_ecc-" + std::to_string(::geteuid());
+}
+
+inline std::string default_socket() {
+    return default_directory() + "/" + socket_name;
+}
+
+/**
+ * @brief User id of the process on the other end of a connected Unix socket.
+ * @return false if it is unknown.
+ */
+inline bool peer_uid(int fd, uid_t& uid) {
+    ucred credentials;
+    socklen_t size = sizeof(credentials);
+
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0 || size != sizeof(credentials)) {
+        return false;
+    }
+    uid = credentials.uid;
+    return true;
+}
+
+/**
+ * @brief Limit how long send_all() and receive_all() block on the socket, 0 means forever.
+ * @return false if the timeouts can't be set.
+ */
+inline bool set_timeouts(int fd, unsigned milliseconds) {
+    timeval timeout;
+    timeout.tv_sec = milliseconds / 1000;
+    timeout.tv_usec = (milliseconds % 1000) * 1000;
+
+    return ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0 &&
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+}
+
+enum operation : uint32_t {
+    op_sign = 1,
+    op_verify = 2
+};
+
+struct request {
+    uint32_t op;
+    uint32_t id;
+
+    /**
+     * Sign: private key, rand, hash. Verify: public key X, public key Y, hash, signature.
+     */
+    uint64_t data[8 * 5];
+};
+
+struct response {
+    uint32_t status;
+    uint32_t id;
+
+    /**
+     * Signature for op_sign, unused otherwise.
+     */
+    uint64_t signature[16];
+};
+
+/**
+ * @brief Send the whole buffer, retrying short writes.
+ * @return false if the connection is broken or the send timeout has expired.
+ */
+inline bool send_all(int fd, const void* data, std::size_t size) {
+    const char* begin = static_cast<const char*>(data);
+
+    while (size > 0) {
+        const ssize_t sent = ::send(fd, begin, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        begin += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+/**
+ * @brief Receive exactly size bytes.
+ * @return false if the connection is closed or broken, or the receive timeout has expired.
+ */
+inline bool receive_all(int fd, void* data, std::size_t size) {
+    char* begin = static_cast<char*>(data);
+
+    while (size > 0) {
+        const ssize_t received = ::recv(fd, begin, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        begin += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+}
+
+}
+
+#endif // DAEMON_PROTOCOL_H
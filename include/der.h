@@ -0,0 +1,51 @@
+#ifndef DER_H
+#define DER_H
+
+#include <cstddef>
+
+namespace gost_ecc {
+
+/**
+ * @brief Conversion between DER encodings of GOST R 34.10-2012 objects and the raw layout of
+ * sign_engine.h.
+ *
+ * Raw signature is r || s and raw public key is X || Y, all little-endian 64-byte numbers.
+ * Parsers don't allocate, values are byte-reversed straight from the input into the output.
+ */
+namespace der {
+
+using byte = unsigned char;
+
+/**
+ * @brief Size of the encoding written by write_signature().
+ */
+const std::size_t signature_size = 3 + 128;
+
+/**
+ * @brief Read DER signature into raw layout.
+ *
+ * Accepts the RFC 4491 form, which is s || r big-endian in an OCTET STRING (PKCS#7) or a
+ * BIT STRING (X.509), and SEQUENCE { INTEGER r, INTEGER s } used by some toolkits.
+ * @return false if data is malformed.
+ */
+bool read_signature(const byte* data, std::size_t size, byte* signature);
+
+/**
+ * @brief Write raw signature as the RFC 4491 OCTET STRING, signature_size bytes.
+ */
+void write_signature(const byte* signature, byte* data);
+
+/**
+ * @brief Read DER public key into raw layout.
+ *
+ * Accepts the RFC 4491 OCTET STRING with X || Y little-endian, as well as the subjectPublicKey
+ * BIT STRING wrapping it and the whole SubjectPublicKeyInfo.
+ * @return false if data is malformed.
+ */
+bool read_public_key(const byte* data, std::size_t size, byte* public_key_x, byte* public_key_y);
+
+}
+
+}
+
+#endif // DER_H
@@ -3,9 +3,12 @@
 
 #include <prime_field.h>
 #include <naf.h>
+#include <op_counters.h>
 
 #include <ostream>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 
 namespace gost_ecc {
 
@@ -78,6 +81,30 @@ public:
         const static jacobian_point inf;
     };
 
+    /**
+     * @brief Affine point as raw little-endian limbs, the most compact form for tables.
+     *
+     * Takes 2 * bits / 8 bytes against three multiprecision numbers of a jacobian_point, and
+     * additions of packed points are mixed ones.
+     */
+    struct packed_point {
+        static const unsigned limbs = integer_type::backend_type::internal_limb_count;
+
+        mp::limb_type x[limbs];
+        mp::limb_type y[limbs];
+
+        packed_point() = default;
+
+        explicit packed_point(const point& p) {
+            field_type::export_bytes(p.x, this->x);
+            field_type::export_bytes(p.y, this->y);
+        }
+
+        point unpack() const {
+            return point(field_type::import_bytes(this->x), field_type::import_bytes(this->y));
+        }
+    };
+
     const field_type field;
     const integer_type a;
     const integer_type b;
@@ -96,25 +123,103 @@ public:
     {
     }
 
+    /**
+     * @brief Convert several points to affine coordinates at the cost of a single field inversion.
+     * @param points
+     * @param result Array of count affine points.
+     * @param count
+     */
+    void to_affine(const jacobian_point* points, point* result, std::size_t count) const {
+        std::vector<integer_type> inv_z(count);
+        for (std::size_t i = 0; i < count; i++) {
+            inv_z[i] = points[i].z;
+        }
+
+        const field_type& f = this->field;
+        f.mul_inverse(inv_z.data(), count);
+
+        for (std::size_t i = 0; i < count; i++) {
+            if (inv_z[i] == 0) {
+                result[i] = point::inf;
+                continue;
+            }
+
+            integer_type inv_zz = f.mul(inv_z[i], inv_z[i]); // z^-2
+            integer_type inv_zzz = f.mul(inv_zz, inv_z[i]); // z^-3
+            result[i] = point(f.mul(points[i].x, inv_zz), f.mul(points[i].y, inv_zzz));
+        }
+    }
+
+    /**
+     * @brief Check that p is a finite point of the curve: y^2 = x^3 + ax + b with reduced coordinates.
+     */
+    bool contains(const point& p) const {
+        const field_type& f = this->field;
+        if (p == point::inf || p.x >= f.modulus || p.y >= f.modulus) {
+            return false;
+        }
+
+        integer_type right = f.add(f.mul(f.add(f.mul(p.x, p.x), this->a), p.x), this->b);
+        return f.mul(p.y, p.y) == right;
+    }
+
+    /**
+     * @brief Restore point from its x coordinate and parity of y.
+     *
+     * Requires field modulus = 3 (mod 4), see prime_field::sqrt().
+     * @return false if x is not a coordinate of a curve point with such parity of y.
+     */
+    bool decompress(const integer_type& x, bool y_odd, point& result) const {
+        const field_type& f = this->field;
+        if (x >= f.modulus) {
+            return false;
+        }
+
+        integer_type y;
+        integer_type right = f.add(f.mul(f.add(f.mul(x, x), this->a), x), this->b);
+        if (!f.sqrt(right, y)) {
+            return false;
+        }
+
+        if (mp::bit_test(y, 0) != y_odd) {
+            if (y == 0) {
+                return false;
+            }
+            y = f.inverse(y);
+        }
+
+        result = point(x, y);
+        return true;
+    }
+
     point negate(const point& p) const {
         return point(p.x, this->field.inverse(p.y));
     }
 
+    point negate(const packed_point& p) const {
+        return this->negate(p.unpack());
+    }
+
     jacobian_point negate(const jacobian_point& p) const {
         return jacobian_point(p.x, this->field.inverse(p.y), p.z);
     }
 
     point add(const point& left, const point& right) const {
         if (left == point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return right;
         } else if (right == point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return left;
         } else if (left == right) {
             return this->twice(left);
         } else if (left == this->negate(right)) {
+            GOST_ECC_COUNT(point_infinity);
             return point::inf;
         }
 
+        GOST_ECC_COUNT(point_add_affine);
+
         const field_type& f = this->field;
         integer_type delta_y = f.sub(right.y, left.y);
         integer_type delta_x = f.sub(right.x, left.x);
@@ -143,11 +248,15 @@ public:
         }
 
         if (left == jacobian_point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return jacobian_point(right);
         } else if (right == point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return left;
         }
 
+        GOST_ECC_COUNT(point_add_mixed);
+
         const field_type& f = this->field;
 
         jacobian_point result;
@@ -161,6 +270,7 @@ public:
         t2 = f.sub(t2, left.y);
 
         if (t1 == 0) {
+            GOST_ECC_COUNT(point_infinity);
             if (t2 == 0) {
                 return this->twice(jacobian_point(right));
             } else {
@@ -184,6 +294,10 @@ public:
         return result;
     }
 
+    jacobian_point add(const jacobian_point& left, const packed_point& right) const {
+        return this->add(left, right.unpack());
+    }
+
     /**
      * @brief See: http://en.wikibooks.org/wiki/Cryptography/Prime_Curve/Jacobian_Coordinates
      *
@@ -194,11 +308,15 @@ public:
      */
     jacobian_point add(const jacobian_point &left, const jacobian_point &right) const {
         if (left == jacobian_point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return right;
         } else if (right == jacobian_point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return left;
         }
 
+        GOST_ECC_COUNT(point_add);
+
         const field_type& f = this->field;
 
         jacobian_point result;
@@ -218,6 +336,7 @@ public:
         s2 = f.mul(right.y, left_z_squared);
 
         if (u1 == u2) {
+            GOST_ECC_COUNT(point_infinity);
             if (s1 != s2) {
                 return jacobian_point::inf;
             } else {
@@ -251,9 +370,12 @@ public:
 
     point twice(const point& p) const {
         if (p == point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return p;
         }
 
+        GOST_ECC_COUNT(point_twice);
+
         const field_type& f = this->field;
         integer_type lambda = f.add(f.mul3(f.mul(p.x, p.x)), this->a);
         lambda = f.mul(lambda, f.mul_inverse(f.mul2(p.y)));
@@ -279,9 +401,12 @@ public:
         }
 
         if (p == jacobian_point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return p;
         }
 
+        GOST_ECC_COUNT(point_twice);
+
         const field_type& f = this->field;
         jacobian_point result;
         integer_type t1, t2, t3;
@@ -318,6 +443,7 @@ public:
      */
     jacobian_point repeated_twice(const jacobian_point& p, unsigned count) const {
         if (p == jacobian_point::inf) {
+            GOST_ECC_COUNT(point_infinity);
             return jacobian_point::inf;
         }
 
@@ -331,6 +457,8 @@ public:
         w           = f.mul(w, w); // W <- Z^4
 
         while (count > 0) {
+            GOST_ECC_COUNT(point_twice);
+
             a           = f.mul(result.x, result.x); // a = X^2
             a           = f.sub(a, w); // a = X^2 - W
             a           = f.mul3(a); // a = 3 (X^2 - W)
@@ -378,54 +506,269 @@ public:
 
     template<unsigned win_left = 8>
     void comb_precompute(const point& base, jacobian_point (&table)[1 << win_left]) const {
-        const unsigned d = field_type::bits / win_left + ((field_type::bits % win_left) ? 1 : 0);
+        jacobian_point teeth[win_left];
+        this->comb_teeth<win_left>(base, teeth);
+        this->comb_fill<win_left>(teeth, table, 0, win_left);
+    }
 
-        jacobian_point pow2[win_left];
-        pow2[0] = jacobian_point(base);
+    template<unsigned win_left = 8>
+    void comb_precompute(const point& base, packed_point (&table)[1 << win_left]) const {
+        struct jacobian_table {
+            jacobian_point points[1 << win_left];
+        };
+
+        std::unique_ptr<jacobian_table> jacobian(new jacobian_table());
+        this->comb_precompute<win_left>(base, jacobian->points);
+        this->pack(jacobian->points, table, 1 << win_left);
+    }
+
+    /**
+     * @brief Convert points to packed form at the cost of a single field inversion.
+     */
+    void pack(const jacobian_point* points, packed_point* result, std::size_t count) const {
+        std::vector<point> affine(count);
+        this->to_affine(points, affine.data(), count);
 
+        for (std::size_t i = 0; i < count; i++) {
+            result[i] = packed_point(affine[i]);
+        }
+    }
+
+    /**
+     * @brief Teeth of a comb: teeth[i] = 2^(i d) base, where d is the number of comb columns.
+     */
+    template<unsigned win_left = 8>
+    void comb_teeth(const point& base, jacobian_point (&teeth)[win_left]) const {
+        const unsigned d = comb_columns<win_left>();
+
+        teeth[0] = jacobian_point(base);
         for (unsigned i = 1; i < win_left; i++) {
-            pow2[i] = this->repeated_twice(pow2[i-1], d);
+            teeth[i] = this->repeated_twice(teeth[i-1], d);
         }
+    }
 
-        for (unsigned i = 0; i < (1 << win_left); i++) {
-            jacobian_point p = jacobian_point::inf;
+    /**
+     * @brief Fill comb table entries [first, first + 2^bits), first must be a multiple of 2^bits.
+     *
+     * Entries are visited in Gray code order, so each one costs a single addition or subtraction
+     * of a tooth to the previous one. Disjoint blocks can be filled concurrently.
+     */
+    template<unsigned win_left = 8>
+    void comb_fill(const jacobian_point (&teeth)[win_left], jacobian_point (&table)[1 << win_left],
+                   unsigned first, unsigned bits) const {
+        jacobian_point p = jacobian_point::inf;
+        for (unsigned offset = bits; offset < win_left; offset++) {
+            if ((first & (1 << offset)) != 0) {
+                p = this->add(p, teeth[offset]);
+            }
+        }
+        table[first] = p;
 
-            for (unsigned offset = 0; offset < win_left; offset++) {
-                if ((i & (1 << offset)) != 0) {
-                    p = this->add(p, pow2[offset]);
-                }
+        for (unsigned j = 1; j < (1u << bits); j++) {
+            unsigned bit = 0;
+            while ((j & (1u << bit)) == 0) {
+                bit++;
             }
 
-            table[i] = p;
+            const unsigned gray = j ^ (j >> 1);
+            p = ((gray & (1u << bit)) != 0) ? this->add(p, teeth[bit]) : this->sub(p, teeth[bit]);
+            table[first | gray] = p;
         }
     }
 
     template<unsigned win_left = 8>
-    point mul_scalar(const jacobian_point (&comb_table)[1 << win_left], integer_type multiplier) const {
-        const unsigned d = field_type::bits / win_left + ((field_type::bits % win_left) ? 1 : 0);
+    point mul_scalar(const jacobian_point (&comb_table)[1 << win_left], const integer_type& multiplier) const {
+        return this->mul_scalar_jacobian<win_left>(comb_table, multiplier).to_affine(*this);
+    }
 
-        integer_type mask = static_cast<integer_type>((double_integer_type(1) << d) - 1);
+    /**
+     * @brief Fixed-base comb multiplication, result is left in Jacobian coordinates.
+     *
+     * Useful for batches, which convert all results to affine coordinates at once.
+     */
+    template<unsigned win_left = 8, typename table_point = jacobian_point>
+    jacobian_point mul_scalar_jacobian(const table_point (&comb_table)[1 << win_left], const integer_type& multiplier,
+                                       unsigned first_column = 0, unsigned last_column = ~0u) const {
+        comb_multiplication<win_left, table_point> multiplication(*this, comb_table, multiplier, first_column, last_column);
+        unsigned budget = ~0u;
+        multiplication.step(budget);
+
+        return multiplication.result();
+    }
 
+    /**
+     * @brief Fixed-base comb multiplication, which can be suspended after any point operation.
+     *
+     * Lets a caller bound the time spent in a single call, see step(). Table entries are
+     * jacobian_point or packed_point.
+     */
+    template<unsigned win_left = 8, typename table_point = jacobian_point>
+    class comb_multiplication {
+        const elliptic_curve& curve;
+        const table_point (&comb_table)[1 << win_left];
         integer_type chunks[win_left];
-        for (unsigned i = 0; i < win_left; i++) {
-            chunks[i] = multiplier & mask;
-            multiplier >>= d;
+
+        unsigned column;
+        unsigned first_column;
+        bool doubled;
+        jacobian_point _result;
+
+    public:
+        /**
+         * @param first_column, last_column Process only columns [first_column, last_column) of
+         * the comb, the result is then sum(2^(i - first_column) * comb_table[key_i]). Splitting
+         * columns between two tables for base and 2^first_column * base lets two threads share one
+         * multiplication.
+         */
+        comb_multiplication(const elliptic_curve& curve, const table_point (&comb_table)[1 << win_left], integer_type multiplier,
+                            unsigned first_column = 0, unsigned last_column = ~0u)
+            :curve(curve), comb_table(comb_table), first_column(first_column), doubled(false), _result(jacobian_point::inf)
+        {
+            const unsigned d = comb_columns<win_left>();
+
+            integer_type mask = static_cast<integer_type>((double_integer_type(1) << d) - 1);
+
+            for (unsigned i = 0; i < win_left; i++) {
+                chunks[i] = multiplier & mask;
+                multiplier >>= d;
+            }
+
+            column = std::max(first_column, std::min(d, last_column));
         }
 
-        jacobian_point result = jacobian_point::inf;
+        /**
+         * @brief Perform at most budget point doublings and additions.
+         * @param budget Decreased by the number of operations performed.
+         * @return true if multiplication is complete.
+         */
+        bool step(unsigned& budget) {
+            for (; column > first_column && budget > 0; budget--) {
+                if (!doubled) {
+                    _result = curve.twice(_result);
+                    doubled = true;
+                    continue;
+                }
 
-        for (unsigned i = d; i > 0; i--) {
-            result = this->twice(result);
+                unsigned key = 0;
+                for (unsigned j = 0; j < win_left; j++) {
+                    key += mp::bit_test(chunks[j], column - 1) << j;
+                }
+
+                _result = curve.add(_result, comb_table[key]);
+                doubled = false;
+                column--;
+            }
+
+            return this->done();
+        }
+
+        bool done() const {
+            return column == first_column;
+        }
+
+        const jacobian_point& result() const {
+            return _result;
+        }
+    };
+
+    /**
+     * @brief Table for regular signed comb multiplication, see mul_scalar_regular().
+     *
+     * table[u] = 2^((win_left - 1) d) base + sum over i < win_left - 1 of (2 u_i - 1) 2^(i d) base,
+     * where u_i is bit i of u and d is the number of comb columns.
+     */
+    template<unsigned win_left = 8>
+    void regular_comb_precompute(const point& base, point (&table)[1 << (win_left - 1)]) const {
+        const unsigned d = comb_columns<win_left>();
+
+        jacobian_point pow2[win_left];
+        pow2[0] = jacobian_point(base);
+        for (unsigned i = 1; i < win_left; i++) {
+            pow2[i] = this->repeated_twice(pow2[i-1], d);
+        }
+
+        jacobian_point jacobian_table[1 << (win_left - 1)];
+        jacobian_table[0] = pow2[win_left - 1];
+        for (unsigned i = 0; i + 1 < win_left; i++) {
+            jacobian_table[0] = this->sub(jacobian_table[0], pow2[i]);
+        }
+
+        // Flipping sign of tooth i from minus to plus adds 2^(i d + 1) base.
+        for (unsigned u = 1; u < (1 << (win_left - 1)); u++) {
+            unsigned i = 0;
+            while ((u >> (i + 1)) != 0) {
+                i++;
+            }
+            jacobian_table[u] = this->add(jacobian_table[u ^ (1 << i)], this->twice(pow2[i]));
+        }
+
+        this->to_affine(jacobian_table, table, 1 << (win_left - 1));
+    }
+
+    /**
+     * @brief Regular signed comb multiplication: every column costs one doubling and one mixed
+     * addition, whatever the multiplier is.
+     *
+     * Odd multiplier k < 2^n, n = win_left * d, is recoded into digits s_i = 2 k_(i+1) - 1 for
+     * i < n - 1 and s_(n-1) = 1, none of which is zero. Every column then selects ±table[u] with
+     * the sign of its top tooth. Lookups go through select(u, negate), which returns table[u] or
+     * its negation, so the caller decides how the table is read.
+     * See: M. Hedabou, P. Pinel, L. Beneteau. Countermeasures for preventing comb method against SCA attacks.
+     */
+    template<unsigned win_left, typename Select>
+    jacobian_point mul_scalar_regular(const Select& select, const integer_type& multiplier) const {
+        const unsigned d = comb_columns<win_left>();
+        const unsigned n = win_left * d;
+
+        // Bit i is 1 for s_i = 1 and 0 for s_i = -1.
+        double_integer_type digits = (double_integer_type(multiplier) >> 1) | (double_integer_type(1) << (n - 1));
+
+        jacobian_point result;
+        for (unsigned column = d; column > 0; column--) {
+            const unsigned top = mp::bit_test(digits, column - 1 + (win_left - 1) * d) ? 1 : 0;
 
             unsigned key = 0;
-            for (unsigned j = 0; j < win_left; j++) {
-                key += mp::bit_test(chunks[j], i-1) << j;
+            for (unsigned i = 0; i + 1 < win_left; i++) {
+                const unsigned bit = mp::bit_test(digits, column - 1 + i * d) ? 1 : 0;
+                key |= (1 ^ bit ^ top) << i;
             }
 
-            result = this->add(result, comb_table[key]);
+            point p = select(key, top == 0);
+            result = (column == d) ? jacobian_point(p) : this->add(this->twice(result), p);
         }
 
-        return result.to_affine(*this);
+        return result;
+    }
+
+    /**
+     * @brief Run independent suspendable multiplications (comb_multiplication,
+     * add_multiplication) one point operation at a time in round-robin order.
+     *
+     * Field operations of neighbouring steps don't depend on each other, so an out-of-order CPU
+     * can overlap their carry chains instead of waiting for each one in turn.
+     */
+    template<typename Multiplication>
+    static void interleave(Multiplication* multiplications, std::size_t count) {
+        bool pending = true;
+
+        while (pending) {
+            pending = false;
+
+            for (std::size_t i = 0; i < count; i++) {
+                unsigned budget = 1;
+                if (!multiplications[i].done() && !multiplications[i].step(budget)) {
+                    pending = true;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Number of columns (doublings) in a comb with win_left teeth.
+     */
+    template<unsigned win_left>
+    static unsigned comb_columns() {
+        return field_type::bits / win_left + ((field_type::bits % win_left) ? 1 : 0);
     }
 
     template<unsigned win_left = 4>
@@ -441,7 +784,7 @@ public:
     }
 
     template<unsigned win_left = 4>
-    jacobian_point mul_scalar(jacobian_point (&p)[1 << (win_left - 2)], const integer_type& multiplier) const {
+    jacobian_point mul_scalar(const jacobian_point (&p)[1 << (win_left - 2)], const integer_type& multiplier) const {
         jacobian_point result = jacobian_point::inf;
 
         short naf_table[field_type::bits + 1];
@@ -463,46 +806,149 @@ public:
         return result;
     }
 
-    template<unsigned win_left = 4, unsigned win_right = 4>
-    jacobian_point add_mul(
-            jacobian_point (&left)[1 << (win_left - 2)], const integer_type& mul_left,
-            jacobian_point (&right)[1 << (win_right - 2)], const integer_type& mul_right
-    ) const {
-        jacobian_point result = jacobian_point::inf;
+    /**
+     * @brief Precompute odd multiples base, 3 base, ... for wNAF in affine coordinates.
+     *
+     * Costs a single field inversion on top of naf_precompute() and makes every addition of
+     * mul_scalar() a mixed one. Suits variable-base multiplications with wide windows.
+     */
+    template<unsigned win_left = 4>
+    void naf_precompute(const point& base, point (&table)[1 << (win_left - 2)]) const {
+        jacobian_point jacobian_table[1 << (win_left - 2)];
+        this->naf_precompute<win_left>(base, jacobian_table);
+        this->to_affine(jacobian_table, table, 1 << (win_left - 2));
+    }
 
-        short naf_table_left[field_type::bits + 1];
-        short naf_table_right[field_type::bits + 1];
+    template<unsigned win_left = 4>
+    void naf_precompute(const point& base, packed_point (&table)[1 << (win_left - 2)]) const {
+        jacobian_point jacobian_table[1 << (win_left - 2)];
+        this->naf_precompute<win_left>(base, jacobian_table);
+        this->pack(jacobian_table, table, 1 << (win_left - 2));
+    }
 
-        std::fill(std::begin(naf_table_left), std::end(naf_table_left), 0);
-        std::fill(std::begin(naf_table_right), std::end(naf_table_right), 0);
+    template<unsigned win_left = 4>
+    jacobian_point mul_scalar(const point (&p)[1 << (win_left - 2)], const integer_type& multiplier) const {
+        jacobian_point result = jacobian_point::inf;
 
-        unsigned naf_length = naf<win_left, integer_type>(mul_left, naf_table_left);
-        naf_length = std::max(naf_length, naf<win_right, integer_type>(mul_right, naf_table_right));
+        short naf_table[field_type::bits + 1];
+        unsigned naf_length = naf<win_left, integer_type>(multiplier, naf_table);
 
         for (unsigned i = naf_length; i > 0; i--) {
             result = this->twice(result);
 
-            short ki = naf_table_left[i-1];
+            short ki = naf_table[i-1];
             if (ki != 0) {
                 if (ki > 0) {
-                    result = this->add(result, left[ki/2]);
+                    result = this->add(result, p[ki/2]);
                 } else {
-                    result = this->sub(result, left[-ki/2]);
+                    result = this->sub(result, p[-ki/2]);
                 }
             }
+        }
 
-            ki = naf_table_right[i-1];
-            if (ki != 0) {
-                if (ki > 0) {
-                    result = this->add(result, right[ki/2]);
-                } else {
-                    result = this->sub(result, right[-ki/2]);
+        return result;
+    }
+
+    template<unsigned win_left = 4, unsigned win_right = 4, typename left_point = jacobian_point, typename right_point = jacobian_point>
+    jacobian_point add_mul(
+            const left_point (&left)[1 << (win_left - 2)], const integer_type& mul_left,
+            const right_point (&right)[1 << (win_right - 2)], const integer_type& mul_right
+    ) const {
+        add_multiplication<win_left, win_right, left_point, right_point> multiplication(*this, left, mul_left, right, mul_right);
+        unsigned budget = ~0u;
+        multiplication.step(budget);
+
+        return multiplication.result();
+    }
+
+    /**
+     * @brief Simultaneous wNAF multiplication mul_left * left + mul_right * right, which can be
+     * suspended after any point operation, see add_mul().
+     */
+    template<unsigned win_left = 4, unsigned win_right = 4, typename left_point = jacobian_point, typename right_point = jacobian_point>
+    class add_multiplication {
+        const elliptic_curve& curve;
+        const left_point (&left)[1 << (win_left - 2)];
+        const right_point (&right)[1 << (win_right - 2)];
+
+        short naf_table_left[field_type::bits + 1];
+        short naf_table_right[field_type::bits + 1];
+
+        unsigned column;
+        enum { sDouble, sLeft, sRight } stage;
+        jacobian_point _result;
+
+        /**
+         * @return true if a point operation has been performed.
+         */
+        template<typename table_point>
+        bool add_digit(short ki, const table_point* table) {
+            if (ki == 0) {
+                return false;
+            }
+
+            if (ki > 0) {
+                _result = curve.add(_result, table[ki/2]);
+            } else {
+                _result = curve.sub(_result, table[-ki/2]);
+            }
+            return true;
+        }
+
+    public:
+        add_multiplication(const elliptic_curve& curve,
+                           const left_point (&left)[1 << (win_left - 2)], const integer_type& mul_left,
+                           const right_point (&right)[1 << (win_right - 2)], const integer_type& mul_right)
+            :curve(curve), left(left), right(right), stage(sDouble), _result(jacobian_point::inf)
+        {
+            std::fill(std::begin(naf_table_left), std::end(naf_table_left), 0);
+            std::fill(std::begin(naf_table_right), std::end(naf_table_right), 0);
+
+            column = naf<win_left, integer_type>(mul_left, naf_table_left);
+            column = std::max(column, naf<win_right, integer_type>(mul_right, naf_table_right));
+        }
+
+        /**
+         * @brief Perform at most budget point doublings and additions.
+         * @param budget Decreased by the number of operations performed.
+         * @return true if multiplication is complete.
+         */
+        bool step(unsigned& budget) {
+            while (column > 0 && budget > 0) {
+                bool performed = true;
+
+                switch (stage) {
+                case sDouble:
+                    _result = curve.twice(_result);
+                    stage = sLeft;
+                    break;
+                case sLeft:
+                    performed = this->add_digit(naf_table_left[column - 1], left);
+                    stage = sRight;
+                    break;
+                case sRight:
+                    performed = this->add_digit(naf_table_right[column - 1], right);
+                    stage = sDouble;
+                    column--;
+                    break;
+                }
+
+                if (performed) {
+                    budget--;
                 }
             }
+
+            return this->done();
         }
 
-        return result;
-    }
+        bool done() const {
+            return column == 0;
+        }
+
+        const jacobian_point& result() const {
+            return _result;
+        }
+    };
 
 
     friend std::ostream& operator<<(std::ostream& out, const point& p) {
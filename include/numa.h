@@ -0,0 +1,115 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace gost_ecc {
+
+/**
+ * @brief Minimal NUMA support on top of Linux system calls, so the library needs no libnuma.
+ *
+ * On other platforms, or if the topology can't be read, the machine is treated as a single node.
+ */
+namespace numa {
+
+/**
+ * @brief Number of NUMA nodes with CPUs.
+ */
+unsigned nodes();
+
+/**
+ * @brief Node of the CPU the calling thread is currently running on.
+ */
+unsigned current_node();
+
+/**
+ * @brief CPUs of the node.
+ */
+std::vector<unsigned> node_cpus(unsigned node);
+
+/**
+ * @brief Restrict calling thread to CPUs of the node.
+ * @return false if affinity couldn't be changed.
+ */
+bool bind_thread(unsigned node);
+
+/**
+ * @brief Allocate page-aligned memory, which is bound to the node.
+ *
+ * Binding is best effort: if the kernel refuses it, memory is still allocated and placed by
+ * the first-touch policy.
+ */
+void* allocate(std::size_t size, unsigned node);
+
+void deallocate(void* ptr, std::size_t size);
+
+template <typename T>
+struct node_delete {
+    node_delete() = default;
+
+    template <typename U>
+    node_delete(const node_delete<U>&)
+    {}
+
+    void operator()(T* ptr) const {
+        if (ptr != nullptr) {
+            ptr->~T();
+            deallocate(const_cast<void*>(static_cast<const void*>(ptr)), sizeof(T));
+        }
+    }
+};
+
+template <typename T>
+using node_ptr = std::unique_ptr<T, node_delete<T> >;
+
+/**
+ * @brief Construct object in memory bound to the node.
+ *
+ * Object is constructed by a temporary thread bound to the node, so pages allocated by the
+ * constructor itself end up on that node too.
+ */
+template <typename T, typename... Args>
+node_ptr<T> make_on_node(unsigned node, Args&&... args);
+
+}
+
+}
+
+#include <thread>
+#include <exception>
+
+namespace gost_ecc {
+namespace numa {
+
+template <typename T, typename... Args>
+node_ptr<T> make_on_node(unsigned node, Args&&... args) {
+    void* memory = allocate(sizeof(T), node);
+    T* object = nullptr;
+    std::exception_ptr error;
+
+    std::thread constructor([&]() {
+        bind_thread(node);
+        try {
+            object = new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            error = std::current_exception();
+        }
+    });
+    constructor.join();
+
+    if (error) {
+        deallocate(memory, sizeof(T));
+        std::rethrow_exception(error);
+    }
+
+    return node_ptr<T>(object);
+}
+
+}
+}
+
+#endif // NUMA_H
@@ -0,0 +1,71 @@
+#ifndef OP_COUNTERS_H
+#define OP_COUNTERS_H
+
+#include <cstdint>
+
+namespace gost_ecc {
+
+/**
+ * @brief Counts of field and curve primitives, compiled in with -DGOST_ECC_OP_COUNTERS.
+ *
+ * Every thread counts into its own block, so counting takes no locks and shares no cache
+ * lines. Blocks of live threads are summed on read, counts of finished threads are kept in a
+ * common total. In normal builds GOST_ECC_COUNT() expands to nothing.
+ *
+ * Field counts include arithmetic modulo the subgroup order q, which is a handful of
+ * operations per signature next to thousands modulo p.
+ */
+namespace op_counters {
+
+enum counter : unsigned {
+    field_mul,
+    field_sqr,
+    field_reduce,
+    field_add,
+    field_sub,
+    field_inverse,
+    point_twice,
+    point_add_mixed,
+    point_add,
+    point_add_affine,
+    point_infinity,
+    counter_count
+};
+
+/**
+ * @return true if counters are compiled in.
+ */
+bool enabled();
+
+void count(counter c);
+
+/**
+ * @param values Receives counter_count values of the calling thread.
+ */
+void read_thread(uint64_t* values);
+
+/**
+ * @param values Receives counter_count values summed over all threads, finished ones included.
+ */
+void read_all(uint64_t* values);
+
+void reset_thread();
+
+/**
+ * @brief Zero counts of all threads. Operations running meanwhile may be partially counted.
+ */
+void reset_all();
+
+const char* name(counter c);
+
+}
+
+}
+
+#ifdef GOST_ECC_OP_COUNTERS
+#define GOST_ECC_COUNT(counter) ::gost_ecc::op_counters::count(::gost_ecc::op_counters::counter)
+#else
+#define GOST_ECC_COUNT(counter) do {} while (false)
+#endif
+
+#endif // OP_COUNTERS_H
@@ -2,9 +2,13 @@
 #define PRIME_FIELD_H
 
 #include <cyclic_array.h>
+#include <op_counters.h>
 
 #include <boost/multiprecision/cpp_int.hpp>
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <vector>
 
 namespace gost_ecc {
 
@@ -49,6 +53,8 @@ public:
     }
 
     integer_type add(const integer_type& left, const integer_type& right) const {
+        GOST_ECC_COUNT(field_add);
+
         pm_integer_type sum;
         mp::add(sum, left, right);
 
@@ -73,6 +79,8 @@ public:
     }
 
     integer_type sub(const integer_type& left, const integer_type& right) const {
+        GOST_ECC_COUNT(field_sub);
+
         pm_integer_type sum = left;
 
         if (left < right) {
@@ -93,6 +101,15 @@ public:
     }
 
     integer_type mul(const integer_type& left, const integer_type& right) const {
+#ifdef GOST_ECC_OP_COUNTERS
+        // Squarings are written as mul(x, x) throughout.
+        if (&left == &right) {
+            GOST_ECC_COUNT(field_sqr);
+        } else {
+            GOST_ECC_COUNT(field_mul);
+        }
+#endif
+
         double_integer_type sum;
         mp::multiply(sum, left, right);
 
@@ -105,6 +122,8 @@ public:
     }
 
     integer_type reduce(const double_integer_type& n) const {
+        GOST_ECC_COUNT(field_reduce);
+
         if (this->reduction_type == rPseudoMersenne) {
             static const pm_integer_type mask = (pm_integer_type(1) << bits) - 1;
 
@@ -130,6 +149,8 @@ public:
     }
 
     integer_type mul_inverse(const integer_type& n) const {
+        GOST_ECC_COUNT(field_inverse);
+
         integer_type s0 = 1, s1 = 0;
         integer_type r0 = n, r1 = this->modulus;
         integer_type quotient, remainder;
@@ -152,30 +173,192 @@ public:
         return s0;
     }
 
+    /**
+     * @brief Simultaneous inversion of several numbers (Montgomery's trick).
+     *
+     * Costs one inversion and 3(count - 1) multiplications instead of count inversions.
+     * Zeroes are skipped and left as is, so a degenerate element doesn't spoil the whole batch.
+     * @param values Numbers to invert, replaced with their inverses.
+     * @param count
+     */
+    void mul_inverse(integer_type* values, std::size_t count) const {
+        std::vector<integer_type> prefix(count);
+        integer_type product = 1;
+
+        for (std::size_t i = 0; i < count; i++) {
+            prefix[i] = product;
+            if (values[i] != 0) {
+                product = this->mul(product, values[i]);
+            }
+        }
+
+        integer_type inv = this->mul_inverse(product);
+
+        for (std::size_t i = count; i > 0; i--) {
+            if (values[i - 1] == 0) {
+                continue;
+            }
+
+            integer_type value = values[i - 1];
+            values[i - 1] = this->mul(inv, prefix[i - 1]);
+            inv = this->mul(inv, value);
+        }
+    }
+
+    /**
+     * @brief Modular exponentiation base^exponent with sliding windows of up to 5 bits.
+     *
+     * Costs about bits(exponent) squarings and bits(exponent) / 6 + 16 multiplications.
+     */
+    integer_type pow(const integer_type& base, const integer_type& exponent) const {
+        const unsigned window = 5;
+
+        integer_type odd_powers[1 << (window - 1)]; // base, base^3, ..., base^31
+        integer_type base_squared = this->mul(base, base);
+        odd_powers[0] = base;
+        for (unsigned i = 1; i < (1 << (window - 1)); i++) {
+            odd_powers[i] = this->mul(odd_powers[i - 1], base_squared);
+        }
+
+        integer_type result = 1;
+        unsigned i = exponent == 0 ? 0 : mp::msb(exponent) + 1;
+
+        while (i > 0) {
+            if (!mp::bit_test(exponent, i - 1)) {
+                result = this->mul(result, result);
+                i--;
+                continue;
+            }
+
+            // Longest window starting at bit i - 1 and ending with a one bit.
+            unsigned length = std::min(window, i);
+            while (!mp::bit_test(exponent, i - length)) {
+                length--;
+            }
+
+            unsigned digit = 0;
+            for (unsigned j = 0; j < length; j++) {
+                result = this->mul(result, result);
+                digit = (digit << 1) | (mp::bit_test(exponent, i - 1 - j) ? 1 : 0);
+            }
+
+            result = this->mul(result, odd_powers[digit / 2]);
+            i -= length;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Square root for modulus = 3 (mod 4): root = n^((modulus + 1) / 4).
+     * @param root Set to one of the two roots if n is a quadratic residue.
+     * @return false if n has no square root.
+     */
+    bool sqrt(const integer_type& n, integer_type& root) const {
+        if ((this->modulus & 3) != 3) {
+            throw std::invalid_argument("Square root requires modulus = 3 (mod 4).");
+        }
+
+        integer_type candidate = this->pow(n, (this->modulus >> 2) + 1);
+        if (this->mul(candidate, candidate) != n) {
+            return false;
+        }
+
+        root = candidate;
+        return true;
+    }
+
+    /**
+     * @brief Read little-endian number of bits / 8 bytes, data may be unaligned.
+     *
+     * Limbs are copied straight into the number, assumes a little-endian host like the rest of
+     * the byte interface.
+     */
     template<typename T>
     static integer_type import_bytes(const T* data) {
-        const mp::limb_type* src = reinterpret_cast<const mp::limb_type*>(data);
+        const unsigned limb_limit = bits / (sizeof(mp::limb_type) * 8);
 
-        integer_type val = 0;
-        for (unsigned i = 0; i < bits / (sizeof(mp::limb_type) * 8); i++) {
-            val += integer_type(src[i]) << (i * sizeof(mp::limb_type) * 8);
-        }
+        integer_type val;
+        val.backend().resize(limb_limit, limb_limit);
+        std::memcpy(val.backend().limbs(), data, limb_limit * sizeof(mp::limb_type));
+        val.backend().normalize();
 
         return val;
     }
 
+    /**
+     * @brief Write number as little-endian bits / 8 bytes, data may be unaligned.
+     */
     template<typename T>
     static T* export_bytes(integer_type val, T* data) {
-        mp::limb_type* dst = reinterpret_cast<mp::limb_type*>(data);
+        const mp::limb_type* limbs = val.backend().limbs();
+        unsigned limb_number = val.backend().size();
+        unsigned limb_limit = bits / (sizeof(mp::limb_type) * 8);
+
+        unsigned char* dst = reinterpret_cast<unsigned char*>(data);
+        std::memcpy(dst, limbs, limb_number * sizeof(mp::limb_type));
+        std::memset(dst + limb_number * sizeof(mp::limb_type), 0, (limb_limit - limb_number) * sizeof(mp::limb_type));
+        return data;
+    }
+
+    /**
+     * @brief Read big-endian number of size bytes, size must not exceed bits / 8.
+     *
+     * Whole limbs are read from the end of data and byte-swapped, only a leading partial limb is
+     * assembled byte by byte.
+     */
+    template<typename T>
+    static integer_type import_bytes_be(const T* data, std::size_t size = bits / 8) {
+        const unsigned limb_limit = bits / (sizeof(mp::limb_type) * 8);
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(data);
 
+        integer_type val;
+        val.backend().resize(limb_limit, limb_limit);
         mp::limb_type* limbs = val.backend().limbs();
+
+        for (unsigned i = 0; i < limb_limit; i++) {
+            mp::limb_type limb = 0;
+
+            if (size >= sizeof(limb)) {
+                size -= sizeof(limb);
+                std::memcpy(&limb, src + size, sizeof(limb));
+                limb = byte_swap(limb);
+            } else {
+                for (std::size_t j = 0; j < size; j++) {
+                    limb = (limb << 8) | src[j];
+                }
+                size = 0;
+            }
+
+            limbs[i] = limb;
+        }
+        val.backend().normalize();
+
+        return val;
+    }
+
+    /**
+     * @brief Write number as big-endian bits / 8 bytes.
+     */
+    template<typename T>
+    static T* export_bytes_be(const integer_type& val, T* data) {
+        const unsigned limb_limit = bits / (sizeof(mp::limb_type) * 8);
+        const mp::limb_type* limbs = val.backend().limbs();
         unsigned limb_number = val.backend().size();
-        unsigned limb_limit = bits / (sizeof(mp::limb_type) * 8);
 
-        std::copy(limbs, limbs + limb_number, dst);
-        std::fill_n(dst + limb_number, limb_limit - limb_number, 0);
+        unsigned char* dst = reinterpret_cast<unsigned char*>(data);
+        for (unsigned i = 0; i < limb_limit; i++) {
+            mp::limb_type limb = (i < limb_number) ? byte_swap(limbs[i]) : 0;
+            std::memcpy(dst + (limb_limit - 1 - i) * sizeof(limb), &limb, sizeof(limb));
+        }
         return data;
     }
+
+private:
+    static mp::limb_type byte_swap(mp::limb_type limb) {
+        static_assert(sizeof(mp::limb_type) == 8, "64-bit limbs expected");
+        return __builtin_bswap64(limb);
+    }
 };
 
 template <unsigned bits>
@@ -0,0 +1,114 @@
+#ifndef RING_H
+#define RING_H
+
+#include <aligned.h>
+
+#include <atomic>
+#include <memory>
+
+namespace gost_ecc {
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer ring buffer.
+ *
+ * Each cell carries a sequence number, which tells producers and consumers whether the cell is
+ * free or holds a value for the current lap, so both sides only contend on their own position
+ * counter. See: D. Vyukov, Bounded MPMC queue.
+ *
+ * Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class ring {
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t mask;
+    std::unique_ptr<cell[]> cells;
+
+    // Producer and consumer positions are kept on separate cache lines.
+    char pad0[cache_line];
+    std::atomic<std::size_t> head;
+    char pad1[cache_line - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> tail;
+    char pad2[cache_line - sizeof(std::atomic<std::size_t>)];
+
+    static std::size_t round_up(std::size_t n) {
+        std::size_t result = 2;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    explicit ring(std::size_t capacity)
+        :mask(round_up(capacity) - 1), cells(new cell[mask + 1]), head(0), tail(0)
+    {
+        for (std::size_t i = 0; i <= mask; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ring(const ring&) = delete;
+    ring& operator=(const ring&) = delete;
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * @return false if the ring is full.
+     */
+    bool push(const T& value) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell& c = cells[pos & mask];
+            std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = value;
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @return false if the ring is empty.
+     */
+    bool pop(T& value) {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell& c = cells[pos & mask];
+            std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = c.value;
+                    c.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}
+
+#endif // RING_H
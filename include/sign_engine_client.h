@@ -0,0 +1,55 @@
+/// @file
+/// @brief Client of gost_ecc_daemon.
+///
+/// libgost_ecc_client exports the contest interface (sign_engine.h), so it can replace the
+/// engine library without changes to the caller: Gost12S512Init() checks that the daemon is
+/// reachable, Gost12S512Sign() and Gost12S512Verify() send requests over a connection of the
+/// calling thread. The socket is taken from the GOST_ECC_SOCKET environment variable,
+/// $XDG_RUNTIME_DIR/gost_ecc.sock or /tmp/gost_ecc-UID/gost_ecc.sock by default. Connections
+/// to a daemon run by another user, except root, are refused. A call which the daemon doesn't
+/// take or answer within GOST_ECC_TIMEOUT_MS milliseconds (10 seconds by default, 0 waits
+/// forever) fails with kStatusInternalError.
+///
+/// Functions below give explicit control over connections. A connection may be used from one
+/// thread at a time.
+
+#ifndef SIGN_ENGINE_CLIENT_H
+#define SIGN_ENGINE_CLIENT_H
+
+#include <sign_engine.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif //__cplusplus
+
+typedef struct Gost12S512Client Gost12S512Client;
+
+/// @brief Connect to the daemon.
+/// @param[in] socketPath Path of the daemon socket, NULL means the default.
+/// @return New connection or NULL in case of error or if the daemon runs as another user.
+Gost12S512Client* Gost12S512ClientConnect( const char* socketPath );
+
+/// @brief Close connection. NULL is ignored.
+void Gost12S512ClientClose( Gost12S512Client* client );
+
+/// @brief Same as Gost12S512Sign(), but performed by the daemon.
+/// @return kStatusInternalError If the daemon is unreachable or doesn't respond in time.
+Gost12S512Status Gost12S512ClientSign( Gost12S512Client* client,
+                                       const char* privateKey,
+                                       const char* rand,
+                                       const char* hash,
+                                       char* signature );
+
+/// @brief Same as Gost12S512Verify(), but performed by the daemon.
+/// @return kStatusInternalError If the daemon is unreachable or doesn't respond in time.
+Gost12S512Status Gost12S512ClientVerify( Gost12S512Client* client,
+                                         const char* publicKeyX,
+                                         const char* publicKeyY,
+                                         const char* hash,
+                                         const char* signature );
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#endif // SIGN_ENGINE_CLIENT_H
@@ -0,0 +1,570 @@
+/// @file
+/// @brief Extended, reentrant interface of the signature engine.
+///
+/// Contest interface (sign_engine.h) keeps a single implicit engine instance. Functions below
+/// operate on explicitly created contexts instead, so a process may hold any number of them.
+///
+/// Thread safety: context owns immutable precomputed tables, which are built in
+/// Gost12S512CtxCreate() and never modified afterwards. All scratch state of sign and verify
+/// lives on the stack of the calling thread, so the same context may be used from any number
+/// of threads concurrently. Gost12S512CtxDestroy() must not race with other calls on the same
+/// context.
+///
+/// Context may optionally own a pool of worker threads, which is used by batch functions to
+/// spread independent jobs over CPUs.
+///
+/// Asynchronous queues (Gost12S512Queue*) accept requests without blocking and process them on
+/// their own worker threads. Any thread may submit and reap, a queue must be destroyed before
+/// the context it was created for.
+
+#ifndef SIGN_ENGINE_EXT_H
+#define SIGN_ENGINE_EXT_H
+
+#include <sign_engine.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif //__cplusplus
+
+/// @brief Opaque engine context.
+typedef struct Gost12S512Ctx Gost12S512Ctx;
+
+/// @brief Elliptic curve parameter sets supported by the engine.
+typedef enum
+{
+     /// id-tc26-gost-3410-12-512-paramSetA, p = 2^512 - 569.
+     kGost12S512ParamSetA,
+     /// id-tc26-gost-3410-12-512-paramSetB, p = 2^511 + 111. Field reduction is generic, so
+     /// operations are slower than with paramSetA.
+     kGost12S512ParamSetB
+} Gost12S512ParamSet;
+
+/// @brief Context option flags.
+typedef enum
+{
+     kGost12S512CtxDefault = 0,
+     /// Start internal worker pool used by batch functions.
+     kGost12S512CtxThreadPool = 1 << 0,
+     /// Cut latency of single Gost12S512CtxSign() and Gost12S512CtxVerify() calls by running
+     /// part of each on a helper thread. Helper busy-waits for work and keeps one CPU core
+     /// occupied, signing also needs an extra comb table (about 240 KB).
+     kGost12S512CtxLowLatency = 1 << 1,
+     /// On multi-socket machines keep a copy of precomputed tables in memory of every NUMA node.
+     /// Calls use the copy local to the CPU they run on, library-owned workers are pinned to
+     /// nodes round-robin. No effect on single-node machines.
+     kGost12S512CtxNumaReplicate = 1 << 2,
+     /// Compute k * P for signing, presigning and key derivation with a regular signed comb:
+     /// the sequence of point operations and table reads doesn't depend on the secret, signing
+     /// is a few percent slower. Field arithmetic itself is still not constant-time.
+     /// kGost12S512CtxLowLatency doesn't speed signing up then, signing runs on the calling
+     /// thread only. Resumable signing is unavailable, see Gost12S512CtxSignStart().
+     kGost12S512CtxRegularSign = 1 << 3,
+     /// Keep kStatusWrongSignature results in the verification cache too, see verifyCacheSize.
+     /// Without it only accepted signatures are remembered, so replays of forged messages are
+     /// verified in full every time.
+     kGost12S512CtxCacheRejected = 1 << 4,
+     /// Build precomputed tables on first use instead of in Gost12S512CtxCreate(). A process
+     /// which only verifies never builds the signing comb table (240 KB), one which only signs
+     /// never builds the verification table (60 KB). The first call of each kind pays for the build.
+     kGost12S512CtxLazyTables = 1 << 5,
+     /// Compact-memory profile: base point tables hold affine points as raw limbs and use smaller
+     /// windows (6-bit comb, 8-bit wNAF), about 16 KB instead of 300 KB. Operations with the base
+     /// point become slower; kGost12S512CtxLowLatency then only speeds up verification.
+     kGost12S512CtxCompact = 1 << 6
+} Gost12S512CtxFlags;
+
+/// @brief Context creation options.
+typedef struct
+{
+     /// Bitwise OR of Gost12S512CtxFlags values.
+     unsigned flags;
+     /// Number of worker threads for kGost12S512CtxThreadPool, 0 means number of CPUs.
+     unsigned threads;
+     /// Number of public keys kept by Gost12S512CtxDecompressKey(), 0 disables the cache.
+     unsigned keyCacheSize;
+     /// Number of verification results kept to answer repeated (key, hash, signature) inputs
+     /// without scalar multiplications, 0 disables the cache. Used by all verify functions taking
+     /// a context, except for resumable verification.
+     unsigned verifyCacheSize;
+} Gost12S512CtxOptions;
+
+/// @brief Signature generation job for batch functions.
+typedef struct
+{
+     const char* privateKey;
+     const char* rand;
+     const char* hash;
+     char* signature;
+     /// Result of the job, see Gost12S512Sign().
+     Gost12S512Status status;
+} Gost12S512SignJob;
+
+/// @brief Signature verification job for batch functions.
+typedef struct
+{
+     const char* publicKeyX;
+     const char* publicKeyY;
+     const char* hash;
+     const char* signature;
+     /// Result of the job, see Gost12S512Verify().
+     Gost12S512Status status;
+} Gost12S512VerifyJob;
+
+/// @brief Fill options with default values.
+/// @param[out] options Options to initialize.
+void Gost12S512CtxOptionsInit( Gost12S512CtxOptions* options );
+
+/// @brief Create engine context and build its precomputed tables.
+/// @param[in] paramset Curve parameter set.
+/// @param[in] options Creation options, NULL means defaults.
+/// @return New context or NULL in case of error.
+Gost12S512Ctx* Gost12S512CtxCreate( Gost12S512ParamSet paramset,
+                                    const Gost12S512CtxOptions* options );
+
+/// @brief Destroy context created by Gost12S512CtxCreate(). NULL is ignored.
+/// @param[in] ctx Context to destroy.
+void Gost12S512CtxDestroy( Gost12S512Ctx* ctx );
+
+/// @brief Approximate memory used by the context: precomputed tables of the engine and its NUMA
+/// replicas plus full capacity of the key and verification caches. Tables not built yet
+/// (kGost12S512CtxLazyTables) are not counted.
+/// @param[in] ctx Context, NULL gives 0.
+/// @return Size in bytes.
+size_t Gost12S512CtxMemoryUsage( const Gost12S512Ctx* ctx );
+
+/// @brief Same as Gost12S512Sign(), but uses given context.
+Gost12S512Status Gost12S512CtxSign( const Gost12S512Ctx* ctx,
+                                    const char* privateKey,
+                                    const char* rand,
+                                    const char* hash,
+                                    char* signature );
+
+/// @brief Same as Gost12S512Verify(), but uses given context.
+Gost12S512Status Gost12S512CtxVerify( const Gost12S512Ctx* ctx,
+                                      const char* publicKeyX,
+                                      const char* publicKeyY,
+                                      const char* hash,
+                                      const char* signature );
+
+/// @brief Sign a batch of independent jobs.
+/// Jobs are spread over the context worker pool if it was started, otherwise processed in the
+/// calling thread. Function returns after all jobs are complete.
+/// @param[in] ctx Context.
+/// @param[in,out] jobs Array of jobs, status of each job is set on return.
+/// @param[in] count Number of jobs.
+/// @return kStatusOk If all jobs have been processed, regardless of their individual results.
+/// @return kStatusBadInput If ctx or jobs is NULL.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxSignBatch( const Gost12S512Ctx* ctx,
+                                         Gost12S512SignJob* jobs,
+                                         size_t count );
+
+/// @brief Verify a batch of independent jobs, see Gost12S512CtxSignBatch().
+Gost12S512Status Gost12S512CtxVerifyBatch( const Gost12S512Ctx* ctx,
+                                           Gost12S512VerifyJob* jobs,
+                                           size_t count );
+
+/// @brief Result of message-independent part of signing, see Gost12S512CtxPresign().
+/// Token holds the nonce in clear and must be kept as secret as the private key. Signing twice
+/// with the same token reveals the private key, each token must be used at most once.
+typedef struct
+{
+     char data[128];
+} Gost12S512Token;
+
+/// @brief Precompute tokens for later Gost12S512CtxSignWithToken() calls.
+/// Performs all the scalar multiplications of signing, which depend neither on the message nor
+/// on the private key, so they can be done when the service is idle. Uses context worker pool
+/// if started. Nonces which are zero or not less than q give tokens rejected by
+/// Gost12S512CtxSignWithToken() with kStatusBadInput, tokens of the other nonces are computed.
+/// @param[in] ctx Context.
+/// @param[in] rand Array of count nonces, see Gost12S512Sign().
+/// @param[out] tokens Array of count tokens.
+/// @param[in] count Number of nonces.
+/// @return kStatusOk If all tokens have been computed.
+/// @return kStatusBadInput If ctx, rand or tokens is NULL or some nonces are zero or not less
+/// than q.
+/// @return kStatusInternalError In other cases, tokens which failed are rejected like the ones
+/// of invalid nonces.
+Gost12S512Status Gost12S512CtxPresign( const Gost12S512Ctx* ctx,
+                                       const char* const* rand,
+                                       Gost12S512Token* tokens,
+                                       size_t count );
+
+/// @brief Sign using a precomputed token, costs two multiplications modulo q.
+/// Result is the same as of Gost12S512Sign() with the nonce the token was made from.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If token is unusable or invalid.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxSignWithToken( const Gost12S512Ctx* ctx,
+                                             const Gost12S512Token* token,
+                                             const char* privateKey,
+                                             const char* hash,
+                                             char* signature );
+
+/// @brief Compute public keys for a batch of private keys.
+/// Uses the fixed-base comb table of the context and one field inversion per chunk of keys.
+/// Chunks are spread over the context worker pool if it was started.
+/// @param[in] ctx Context.
+/// @param[in] privateKeys Array of count private keys, LE.
+/// @param[out] publicKeysX Array of count buffers for X coordinates of public keys, LE.
+/// @param[out] publicKeysY Array of count buffers for Y coordinates of public keys, LE.
+/// @param[in] count Number of keys.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If a pointer is NULL or some private keys are zero or not less than
+/// q, public keys for them are set to zero while others are computed.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxDeriveKeys( const Gost12S512Ctx* ctx,
+                                          const char* const* privateKeys,
+                                          char* const* publicKeysX,
+                                          char* const* publicKeysY,
+                                          size_t count );
+
+/// @brief Restore Y coordinate of a compressed public key.
+/// Compressed key is the X coordinate and the least significant bit of Y, which is obtained
+/// as publicKeyY[0] & 1. Costs a modular square root, i.e. about 600 field multiplications.
+/// Results are cached by the context, so repeated keys cost a lookup.
+/// @param[in] ctx Context.
+/// @param[in] publicKeyX X coordinate of the public key, LE.
+/// @param[in] yParity Least significant bit of Y.
+/// @param[out] publicKeyY Y coordinate of the public key, LE.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If there is no curve point with such X and parity of Y.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxDecompressKey( const Gost12S512Ctx* ctx,
+                                             const char* publicKeyX,
+                                             int yParity,
+                                             char* publicKeyY );
+
+/// @brief Verify signature with a compressed public key, see Gost12S512CtxDecompressKey().
+/// @return kStatusOk If signature is correct.
+/// @return kStatusWrongSignature Signature doesn't correspond to the hash.
+/// @return kStatusBadInput If the public key is invalid.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxVerifyCompressed( const Gost12S512Ctx* ctx,
+                                                const char* publicKeyX,
+                                                int yParity,
+                                                const char* hash,
+                                                const char* signature );
+
+/// @brief Size of the DER signature written by Gost12S512SignatureToDer().
+#define GOST12S512_DER_SIGNATURE_SIZE 131
+
+/// @brief Convert DER signature to the layout of Gost12S512Sign().
+/// Accepts the RFC 4491 encoding, which is s || r big-endian in an OCTET STRING (PKCS#7) or a
+/// BIT STRING (X.509), and SEQUENCE { INTEGER r, INTEGER s }.
+/// @param[in] der Encoded signature.
+/// @param[in] size Size of der in bytes.
+/// @param[out] signature Signature, 128 bytes.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If der is malformed.
+Gost12S512Status Gost12S512SignatureFromDer( const char* der,
+                                             size_t size,
+                                             char* signature );
+
+/// @brief Convert signature produced by Gost12S512Sign() to RFC 4491 OCTET STRING.
+/// @param[in] signature Signature, 128 bytes.
+/// @param[out] der Buffer of GOST12S512_DER_SIGNATURE_SIZE bytes.
+void Gost12S512SignatureToDer( const char* signature,
+                               char* der );
+
+/// @brief Convert DER public key to X and Y coordinates.
+/// Accepts the RFC 4491 OCTET STRING with X || Y little-endian, the subjectPublicKey BIT STRING
+/// wrapping it, and the whole SubjectPublicKeyInfo.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If der is malformed.
+Gost12S512Status Gost12S512PublicKeyFromDer( const char* der,
+                                             size_t size,
+                                             char* publicKeyX,
+                                             char* publicKeyY );
+
+/// @brief Verify DER signature with DER public key, see Gost12S512SignatureFromDer() and
+/// Gost12S512PublicKeyFromDer() for accepted encodings.
+/// @return kStatusOk If signature is correct.
+/// @return kStatusWrongSignature Signature doesn't correspond to the hash.
+/// @return kStatusBadInput If an encoding is malformed.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxVerifyDer( const Gost12S512Ctx* ctx,
+                                         const char* publicKey,
+                                         size_t publicKeySize,
+                                         const char* hash,
+                                         const char* signature,
+                                         size_t signatureSize );
+
+/// @brief VKO key agreement according to R 50.1.113-2016.
+/// Computes K = (UKM * d mod q) * Q, where d is own private key and Q is the peer public key.
+/// Key encryption key is a Streebog hash of X || Y of the shared point, which is left to the
+/// caller, see Gost12S512HashCreate().
+/// @param[in] ctx Context.
+/// @param[in] privateKey Own private key, LE.
+/// @param[in] publicKeyX X coordinate of the peer public key, LE.
+/// @param[in] publicKeyY Y coordinate of the peer public key, LE.
+/// @param[in] ukm User keying material, LE number, zero is replaced by one.
+/// @param[in] ukmSize Size of ukm in bytes, at most 64.
+/// @param[out] sharedX X coordinate of the shared point, LE.
+/// @param[out] sharedY Y coordinate of the shared point, LE.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If the private key is zero or not less than q, the peer public key
+/// is not a point of the curve or ukm is too long.
+/// @return kStatusInternalError In other cases.
+Gost12S512Status Gost12S512CtxAgree( const Gost12S512Ctx* ctx,
+                                     const char* privateKey,
+                                     const char* publicKeyX,
+                                     const char* publicKeyY,
+                                     const char* ukm,
+                                     size_t ukmSize,
+                                     char* sharedX,
+                                     char* sharedY );
+
+/// @brief Opaque asynchronous request queue.
+typedef struct Gost12S512Queue Gost12S512Queue;
+
+/// @brief Kind of asynchronous request.
+typedef enum
+{
+     kGost12S512RequestSign,
+     kGost12S512RequestVerify,
+     /// Compute token for Gost12S512CtxSignWithToken() in background. Completes with
+     /// kStatusBadInput, leaving the token untouched, if the nonce is zero or not less than q.
+     kGost12S512RequestPresign
+} Gost12S512RequestType;
+
+/// @brief Asynchronous request.
+/// All buffers must stay valid until the request is completed.
+typedef struct
+{
+     Gost12S512RequestType type;
+     /// Signing only.
+     const char* privateKey;
+     /// Signing and presigning only.
+     const char* rand;
+     /// Verification only.
+     const char* publicKeyX;
+     /// Verification only.
+     const char* publicKeyY;
+     const char* hash;
+     /// Output for signing, input for verification.
+     char* signature;
+     /// Output for presigning only.
+     Gost12S512Token* token;
+     /// Opaque value passed back in the completion.
+     void* userData;
+} Gost12S512Request;
+
+/// @brief Result of an asynchronous request.
+typedef struct
+{
+     void* userData;
+     Gost12S512Status status;
+} Gost12S512Completion;
+
+/// @brief Completion callback, called on one of queue worker threads.
+typedef void (*Gost12S512CompletionCallback)( const Gost12S512Completion* completion, void* arg );
+
+/// @brief Create asynchronous queue.
+/// Queue workers take all requests available at the moment, up to a limit, and process them as
+/// one batch sharing field inversions. Without callback completions are placed into completion
+/// ring and must be reaped with Gost12S512QueueReap().
+/// @param[in] ctx Context, must outlive the queue.
+/// @param[in] capacity Maximum number of requests in flight (submitted, but not reaped).
+/// @param[in] workers Number of worker threads, 0 means number of CPUs.
+/// @param[in] callback Completion callback or NULL.
+/// @param[in] callbackArg Second argument of callback.
+/// @return New queue or NULL in case of error.
+Gost12S512Queue* Gost12S512QueueCreate( const Gost12S512Ctx* ctx,
+                                        size_t capacity,
+                                        unsigned workers,
+                                        Gost12S512CompletionCallback callback,
+                                        void* callbackArg );
+
+/// @brief Wait for all submitted requests to be processed and destroy queue. NULL is ignored.
+/// Completions which haven't been reaped are discarded.
+void Gost12S512QueueDestroy( Gost12S512Queue* queue );
+
+/// @brief Submit requests, never blocks.
+/// @return Number of leading requests accepted, less than count if the queue is full.
+size_t Gost12S512QueueSubmit( Gost12S512Queue* queue,
+                              const Gost12S512Request* requests,
+                              size_t count );
+
+/// @brief Take completed requests from completion ring, never blocks.
+/// @return Number of completions stored.
+size_t Gost12S512QueueReap( Gost12S512Queue* queue,
+                            Gost12S512Completion* completions,
+                            size_t count );
+
+/// @brief Get eventfd descriptor, which is signalled each time requests are completed.
+/// Descriptor is owned by the queue and may be polled for readability in an event loop.
+/// @return Descriptor or -1 if not supported on this platform.
+int Gost12S512QueueEventFd( const Gost12S512Queue* queue );
+
+/// @brief Opaque resumable sign or verify operation.
+/// Operation is bound to the thread that advances it only by the usual rule: it must not be
+/// used from several threads at the same time.
+typedef struct Gost12S512Operation Gost12S512Operation;
+
+/// @brief Start resumable signing, see Gost12S512Sign().
+/// No point operations are performed until Gost12S512OperationStep() is called, with
+/// kGost12S512CtxLazyTables a base point table not built yet is built by the first step and
+/// counts as one point operation per table entry. Inputs are copied, signature buffer must stay
+/// valid until the operation is complete.
+/// On contexts created with kGost12S512CtxRegularSign the operation completes on the first step
+/// with kStatusBadInput.
+/// @return New operation or NULL in case of error.
+Gost12S512Operation* Gost12S512CtxSignStart( const Gost12S512Ctx* ctx,
+                                             const char* privateKey,
+                                             const char* rand,
+                                             const char* hash,
+                                             char* signature );
+
+/// @brief Start resumable verification, see Gost12S512Verify(). Inputs are copied.
+/// Base point tables are handled as in Gost12S512CtxSignStart().
+/// @return New operation or NULL in case of error.
+Gost12S512Operation* Gost12S512CtxVerifyStart( const Gost12S512Ctx* ctx,
+                                               const char* publicKeyX,
+                                               const char* publicKeyY,
+                                               const char* hash,
+                                               const char* signature );
+
+/// @brief Advance operation by at most budget point operations (doublings and additions).
+/// Signing takes about a hundred of them, verification about seven hundred.
+/// @param[in] operation Operation.
+/// @param[in] budget Maximum number of point operations to perform.
+/// @return 1 if operation is complete, 0 otherwise.
+int Gost12S512OperationStep( Gost12S512Operation* operation, unsigned budget );
+
+/// @brief Result of a complete operation.
+/// @return Same statuses as Gost12S512Sign() and Gost12S512Verify().
+/// @return kStatusInternalError If operation hasn't completed yet.
+Gost12S512Status Gost12S512OperationStatus( const Gost12S512Operation* operation );
+
+/// @brief Destroy operation, complete or not. NULL is ignored.
+void Gost12S512OperationDestroy( Gost12S512Operation* operation );
+
+/// @brief Streaming GOST R 34.11-2012 (Streebog) hash.
+typedef struct Gost12S512Hash Gost12S512Hash;
+
+/// @brief Start hashing a message.
+/// @param[in] digestSize 64 for Streebog-512, 32 for Streebog-256.
+/// @return New hash or NULL if digestSize is invalid or memory is exhausted.
+Gost12S512Hash* Gost12S512HashCreate( size_t digestSize );
+
+/// @brief Hash the next part of the message.
+void Gost12S512HashUpdate( Gost12S512Hash* hash,
+                           const char* data,
+                           size_t size );
+
+/// @brief Write the digest in the LE layout of Gost12S512Sign() and start a new message.
+/// @param[out] digest digestSize bytes.
+void Gost12S512HashFinal( Gost12S512Hash* hash,
+                          char* digest );
+
+/// @brief Destroy hash created by Gost12S512HashCreate(). NULL is ignored.
+void Gost12S512HashDestroy( Gost12S512Hash* hash );
+
+/// @brief Same as Gost12S512CtxSign(), but hashes message with Streebog-512 first.
+Gost12S512Status Gost12S512CtxSignMessage( const Gost12S512Ctx* ctx,
+                                           const char* privateKey,
+                                           const char* rand,
+                                           const char* message,
+                                           size_t size,
+                                           char* signature );
+
+/// @brief Same as Gost12S512CtxVerify(), but hashes message with Streebog-512 first.
+Gost12S512Status Gost12S512CtxVerifyMessage( const Gost12S512Ctx* ctx,
+                                             const char* publicKeyX,
+                                             const char* publicKeyY,
+                                             const char* message,
+                                             size_t size,
+                                             const char* signature );
+
+/// @brief Hash count messages, several at a time, see Gost12S512HashCreate().
+/// @param[in] digestSize 64 for Streebog-512, 32 for Streebog-256.
+/// @param[in] messages Array of count messages.
+/// @param[in] sizes Sizes of messages in bytes.
+/// @param[out] digests Array of count buffers of digestSize bytes.
+/// @return kStatusOk In case of success.
+/// @return kStatusBadInput If digestSize is invalid or an array is NULL.
+Gost12S512Status Gost12S512HashMany( size_t digestSize,
+                                     const char* const* messages,
+                                     const size_t* sizes,
+                                     char* const* digests,
+                                     size_t count );
+
+/// @brief Message verification job for Gost12S512CtxVerifyMessageBatch().
+typedef struct
+{
+     const char* publicKeyX;
+     const char* publicKeyY;
+     const char* message;
+     size_t size;
+     const char* signature;
+     /// Result of the job, see Gost12S512Verify().
+     Gost12S512Status status;
+} Gost12S512VerifyMessageJob;
+
+/// @brief Verify a batch of messages: multi-buffer Streebog-512 of each chunk of jobs followed
+/// by Gost12S512CtxVerifyBatch() of the digests, both on the context's thread pool if any.
+/// @return Same as Gost12S512CtxVerifyBatch().
+Gost12S512Status Gost12S512CtxVerifyMessageBatch( const Gost12S512Ctx* ctx,
+                                                  Gost12S512VerifyMessageJob* jobs,
+                                                  size_t count );
+
+/// @brief Field and curve primitives counted in builds with GOST_ECC_OP_COUNTERS.
+typedef enum
+{
+     /// Field multiplications, squarings excluded.
+     kGost12S512CounterFieldMul,
+     kGost12S512CounterFieldSqr,
+     /// Reductions of double-width products, one per multiplication or squaring.
+     kGost12S512CounterFieldReduce,
+     kGost12S512CounterFieldAdd,
+     kGost12S512CounterFieldSub,
+     kGost12S512CounterFieldInverse,
+     kGost12S512CounterPointTwice,
+     /// Jacobian plus affine point.
+     kGost12S512CounterPointAddMixed,
+     /// Jacobian plus Jacobian point.
+     kGost12S512CounterPointAdd,
+     kGost12S512CounterPointAddAffine,
+     /// Additions and doublings which met the point at infinity or equal points.
+     kGost12S512CounterPointInfinity,
+     kGost12S512CounterCount
+} Gost12S512Counter;
+
+/// @brief Which counts Gost12S512CountersRead() and Gost12S512CountersReset() cover.
+typedef enum
+{
+     /// Operations of the calling thread.
+     kGost12S512CountersThread,
+     /// Operations of all threads, including finished ones and library-owned workers.
+     kGost12S512CountersAll
+} Gost12S512CountersScope;
+
+/// @brief Read operation counts.
+///
+/// Counting is compiled in only when the library is configured with -DGOST_ECC_OP_COUNTERS=ON,
+/// in normal builds the primitives carry no trace of it. Each thread counts separately, so
+/// counting adds no contention.
+/// @param[out] values Receives kGost12S512CounterCount counts indexed by Gost12S512Counter.
+/// @return kStatusInternalError If counters are not compiled in.
+/// @return kStatusBadInput Unknown scope.
+Gost12S512Status Gost12S512CountersRead( Gost12S512CountersScope scope,
+                                         uint64_t* values );
+
+/// @brief Zero operation counts. Operations running meanwhile on other threads may be partially
+/// counted for kGost12S512CountersAll.
+/// @return Same as Gost12S512CountersRead().
+Gost12S512Status Gost12S512CountersReset( Gost12S512CountersScope scope );
+
+/// @return Name of the counter, e.g. "field_mul", or NULL if it is unknown.
+const char* Gost12S512CounterName( Gost12S512Counter counter );
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#endif // SIGN_ENGINE_EXT_H
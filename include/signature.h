@@ -2,9 +2,15 @@
 #define SIGNATURE_H
 
 #include <sign_engine.h>
+#include <sign_engine_ext.h>
 
 #include <elliptic_curve.h>
+#include <spin_worker.h>
+#include <aligned.h>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 
 namespace gost_ecc {
 
@@ -18,20 +24,317 @@ class signature
     static const unsigned comb_window = 10;
     static const unsigned dynamic_naf_window = 6;
     static const unsigned static_naf_window = 10;
+    static const unsigned vko_naf_window = 6;
+    static const std::size_t ukm_max_size = 64;
+    static const unsigned regular_window = 8;
+
+    /**
+     * Number of multiplications batch functions interleave in one thread, see elliptic_curve::interleave().
+     */
+    static const std::size_t interleave_lanes = 4;
 
     ec curve;
     pf subgroup;
     ec::point basePoint;
-    ec::jacobian_point basePointTable[1 << comb_window];
-    ec::jacobian_point basePointNafTable[1 << (static_naf_window - 2)];
+
+    /**
+     * Smaller tables of packed affine points for kGost12S512CtxCompact, about 16 KB together.
+     */
+    static const unsigned compact_comb_window = 6;
+    static const unsigned compact_naf_window = 8;
+
+    struct comb_table {
+        ec::jacobian_point points[1 << comb_window];
+    };
+
+    struct naf_table {
+        ec::jacobian_point points[1 << (static_naf_window - 2)];
+    };
+
+    struct compact_comb_table {
+        ec::packed_point points[1 << compact_comb_window];
+    };
+
+    struct compact_naf_table {
+        ec::packed_point points[1 << (compact_naf_window - 2)];
+    };
+
+    /**
+     * @brief Table built by the constructor, or on first use with kGost12S512CtxLazyTables.
+     *
+     * Tables are allocated on their own cache lines, see aligned_new().
+     */
+    template <typename T>
+    class lazy_table {
+        mutable aligned_ptr<T> table;
+        mutable std::once_flag once;
+        mutable std::atomic<bool> built;
+
+    public:
+        lazy_table()
+            :built(false)
+        {}
+
+        lazy_table(const lazy_table& that)
+            :built(false)
+        {
+            if (that.built) {
+                this->table = aligned_new<T>(*that.table);
+                this->built = true;
+            }
+        }
+
+        template <typename F>
+        const T& get(F build) const {
+            std::call_once(this->once, [this, &build]() {
+                if (!this->built) {
+                    aligned_ptr<T> table = aligned_new<T>();
+                    build(*table);
+                    this->table = std::move(table);
+                    this->built = true;
+                }
+            });
+
+            return *this->table;
+        }
+
+        bool ready() const {
+            return this->built;
+        }
+
+        std::size_t memory_usage() const {
+            return this->built ? sizeof(T) : 0;
+        }
+    };
+
+    /**
+     * Comb table for signing and wNAF table for verification, compact or full ones.
+     */
+    const bool compact;
+    lazy_table<comb_table> basePointTable;
+    lazy_table<naf_table> basePointNafTable;
+    lazy_table<compact_comb_table> basePointCompactTable;
+    lazy_table<compact_naf_table> basePointCompactNafTable;
+
+    const comb_table& base_comb() const;
+    const naf_table& base_naf() const;
+    const compact_comb_table& base_compact_comb() const;
+    const compact_naf_table& base_compact_naf() const;
+
+    /**
+     * @brief Build comb table for base, filling blocks of entries in parallel.
+     */
+    void comb_build(const ec::point& base, comb_table& table) const;
+
+    /**
+     * Comb table for 2^h * basePoint, where h is half the number of comb columns.
+     * Built for kGost12S512CtxLowLatency only.
+     */
+    aligned_ptr<comb_table> basePointTableHigh;
+
+    /**
+     * Affine table for regular signing as raw limbs x || y, scanned in full on every lookup.
+     * Built for kGost12S512CtxRegularSign only.
+     */
+    struct regular_table {
+        static const unsigned limbs = 16;
+        uint64_t entries[1 << (regular_window - 1)][limbs];
+    };
+
+    aligned_ptr<regular_table> basePointRegularTable;
+
+    /**
+     * @brief k * basePoint with the regular comb if enabled, with the ordinary comb otherwise.
+     */
+    ec::jacobian_point mul_base(const pf::integer_type& k) const;
+
+    /**
+     * @brief k * basePoint with the compact or the full comb, for public multipliers.
+     */
+    ec::jacobian_point mul_base_public(const pf::integer_type& k) const;
+
+    /**
+     * @brief result[i] = k[i] * basePoint for all non-zero k[i], interleaving multiplications.
+     * Results for zero k[i] are unspecified.
+     */
+    void mul_base(const pf::integer_type* k, ec::jacobian_point* result, std::size_t count) const;
+
+    template <unsigned window, typename table_point>
+    void mul_base_interleaved(const table_point (&table)[1 << window], const pf::integer_type* k,
+                              ec::jacobian_point* result, std::size_t count) const;
+
+    /**
+     * @brief C[i] = z_1 P + z_2 Q for verification jobs, interleaving multiplications.
+     * @param v Inverses of hashes modulo q.
+     */
+    template <unsigned window, typename table_point>
+    void verify_interleaved(const table_point (&table)[1 << (window - 2)], const Gost12S512VerifyJob* jobs,
+                            const pf::integer_type* r, const pf::integer_type* v,
+                            ec::jacobian_point* C, std::size_t count) const;
+
+    template <unsigned window, typename table_point, typename table_type>
+    class sign_operation;
+    template <unsigned window, typename table_point, typename table_type>
+    class verify_operation;
+    class finished_operation;
+
+    /**
+     * @brief Base point table for a resumable operation.
+     *
+     * A lazy table is built by the first step which needs it rather than when the operation
+     * starts, building counts as one point operation per table entry.
+     * @return nullptr if budget ran out, the table is then ready for the next step.
+     */
+    template <typename T>
+    const T* operation_table(const lazy_table<T>& table, const T& (signature::*get)() const, unsigned& budget) const;
+
+    pf::integer_type hash_to_e(const byte* hash) const;
+    Gost12S512Status sign_result(const pf::integer_type& d, const pf::integer_type& e,
+                                 const pf::integer_type& k, const ec::point& C, byte* signature) const;
+    Gost12S512Status sign_result(const pf::integer_type& d, const pf::integer_type& e,
+                                 const pf::integer_type& k, const pf::integer_type& r, byte* signature) const;
 
 public:
+    /**
+     * @brief Sign or verify operation, which is performed in small steps.
+     *
+     * Allows a cooperative scheduler to interleave a long operation with other work without
+     * threads: each step() performs a bounded number of point operations.
+     */
+    class operation {
+    protected:
+        Gost12S512Status _status;
+        bool _done;
+
+        operation()
+            :_status(kStatusInternalError), _done(false)
+        {}
+
+        void finish(Gost12S512Status status) {
+            _status = status;
+            _done = true;
+        }
+
+    public:
+        virtual ~operation() {}
+
+        /**
+         * @brief Advance operation.
+         * @param budget Maximum number of point doublings and additions (conversion to affine
+         * coordinates counts as one) to perform, decreased by the number actually performed.
+         * @return true if operation is complete.
+         */
+        virtual bool step(unsigned& budget) = 0;
+
+        bool done() const {
+            return _done;
+        }
+
+        /**
+         * @brief Result of a complete operation.
+         */
+        Gost12S512Status status() const {
+            return _status;
+        }
+    };
+
+    /**
+     * @param flags Gost12S512CtxFlags, which affect precomputed tables. Independent tables are
+     * built concurrently on temporary threads.
+     */
     signature(u_int64_t (&modulus)[8], u_int64_t (&a)[8], u_int64_t (&b)[8],
               u_int64_t (&subgroupModulus)[8],
-              u_int64_t (&base_x)[8], u_int64_t (&base_y)[8]);
+              u_int64_t (&base_x)[8], u_int64_t (&base_y)[8],
+              unsigned flags = kGost12S512CtxDefault);
+
+    /**
+     * @brief Deep copy, used to replicate tables into memory of another NUMA node.
+     */
+    signature(const signature& that);
+
+    Gost12S512Status sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature) const;
+    Gost12S512Status verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature) const;
+
+    /**
+     * @brief Process several independent jobs at once.
+     *
+     * Field inversions of all jobs (conversion to affine coordinates and, for verification,
+     * inversion of the hash modulo q) are batched, so a batch of n jobs needs two inversions
+     * instead of 2n.
+     */
+    void sign(Gost12S512SignJob* jobs, std::size_t count) const;
+    void verify(Gost12S512VerifyJob* jobs, std::size_t count) const;
+
+    /**
+     * @brief Low-latency signing, which splits comb multiplication between the calling thread and
+     * helper. Requires kGost12S512CtxLowLatency, falls back to ordinary signing if helper is busy.
+     */
+    Gost12S512Status sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature, spin_worker& helper) const;
+
+    /**
+     * @brief Low-latency verification: helper computes z1 * P with the comb table, while the
+     * calling thread computes z2 * Q. Falls back to ordinary verification if helper is busy.
+     */
+    Gost12S512Status verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature, spin_worker& helper) const;
+
+    /**
+     * @brief Message-independent part of signing: r = (k * P).x mod q for each nonce k.
+     *
+     * Conversion to affine coordinates is shared by the whole batch. Nonces which are zero or not
+     * less than q produce tokens with zero r, which are rejected by sign(token, ...), and get
+     * kStatusBadInput in statuses.
+     */
+    void presign(const char* const* rand, Gost12S512Token* tokens, Gost12S512Status* statuses, std::size_t count) const;
+
+    /**
+     * @brief Finish signing with a token from presign(): s = r * d + k * e mod q.
+     */
+    Gost12S512Status sign(const Gost12S512Token& token, const byte* private_key, const byte* hash, byte* signature) const;
+
+    /**
+     * @brief Compute public keys Q = d * P with the comb table, sharing conversion to affine
+     * coordinates between all keys.
+     *
+     * Public keys for private keys which are zero or not less than q are set to zero.
+     * @return false if there were such keys.
+     */
+    bool derive_keys(const char* const* private_keys, char* const* public_keys_x, char* const* public_keys_y, std::size_t count) const;
+
+    /**
+     * @brief Restore Y coordinate of a public key from X and parity of Y.
+     * @return kStatusBadInput if there is no such point on the curve.
+     */
+    Gost12S512Status decompress(const byte* public_key_x, bool y_odd, byte* public_key_y) const;
+
+    /**
+     * @brief VKO key agreement (R 50.1.113-2016): K = (UKM * d mod q) * Q.
+     *
+     * Q is multiplied with a wNAF over an affine table of its odd multiples, so that every
+     * addition is a mixed one. The public key is checked to be a finite point of the curve.
+     * @param ukm Little-endian user keying material of at most 64 bytes, zero is replaced by one.
+     */
+    Gost12S512Status agree(const byte* private_key, const byte* public_key_x, const byte* public_key_y,
+                           const byte* ukm, std::size_t ukm_size, byte* shared_x, byte* shared_y) const;
+
+    /**
+     * @brief Bytes taken by the engine and the tables it has built so far.
+     */
+    std::size_t memory_usage() const;
+
+    /**
+     * @brief Start resumable signing, see operation.
+     *
+     * Inputs are copied, signature buffer must stay valid until the operation is complete.
+     * Lazy tables are left to the steps, see operation_table(). With the regular comb the operation is complete at once with kStatusBadInput, the
+     * ordinary comb it steps through would give away the nonce.
+     */
+    std::unique_ptr<operation> start_sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature) const;
 
-    Gost12S512Status sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature);
-    Gost12S512Status verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature);
+    /**
+     * @brief Start resumable verification, see operation. Inputs are copied, lazy tables are
+     * left to the steps.
+     */
+    std::unique_ptr<operation> start_verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature) const;
 };
 
 }
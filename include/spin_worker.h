@@ -0,0 +1,52 @@
+#ifndef SPIN_WORKER_H
+#define SPIN_WORKER_H
+
+#include <atomic>
+#include <thread>
+
+namespace gost_ecc {
+
+/**
+ * @brief Helper thread, which busy-waits for a task.
+ *
+ * Handing a task over costs a couple of cache line transfers instead of a thread wakeup, so it
+ * pays off even for sub-millisecond tasks. The price is a CPU core kept busy while idle: after
+ * a while without tasks the worker falls back to yielding between polls.
+ *
+ * Worker runs one task at a time. A caller which got true from post() must call wait() before
+ * anyone else can post.
+ */
+class spin_worker {
+public:
+    using task = void (*)(void* arg);
+
+    spin_worker();
+    ~spin_worker();
+
+    spin_worker(const spin_worker&) = delete;
+    spin_worker& operator=(const spin_worker&) = delete;
+
+    /**
+     * @return false if the worker is busy with another caller's task, run the task yourself then.
+     */
+    bool post(task t, void* arg);
+
+    /**
+     * @brief Spin until the posted task is complete.
+     */
+    void wait();
+
+private:
+    enum state_type { sIdle, sClaimed, sReady, sDone, sStopping };
+
+    std::atomic<int> state;
+    task current_task;
+    void* current_arg;
+    std::thread thread;
+
+    void run();
+};
+
+}
+
+#endif // SPIN_WORKER_H
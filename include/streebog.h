@@ -0,0 +1,123 @@
+#ifndef STREEBOG_H
+#define STREEBOG_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gost_ecc {
+
+/**
+ * @brief GOST R 34.11-2012 (Streebog) hash function with 256 or 512-bit digest.
+ *
+ * Digest is written in the byte order of the standard's little-endian vectors, so a 512-bit
+ * digest can be passed to signature::sign() and signature::verify() as is.
+ */
+class streebog {
+public:
+    using byte = unsigned char;
+
+    static const std::size_t block_size = 64;
+
+    /**
+     * 512-bit value as little-endian 64-bit words.
+     */
+    struct block {
+        uint64_t words[8];
+    };
+
+    /**
+     * @param digest_size 32 or 64 bytes, anything else throws std::invalid_argument.
+     */
+    explicit streebog(std::size_t digest_size = 64);
+
+    std::size_t digest_size() const {
+        return this->size;
+    }
+
+    /**
+     * @brief Start a new message, discarding anything hashed so far.
+     */
+    void reset();
+
+    void update(const byte* data, std::size_t length);
+
+    /**
+     * @brief Write digest_size() bytes of the digest and reset().
+     */
+    void final(byte* digest);
+
+    /**
+     * @brief One-shot hash of a message.
+     */
+    static void hash(std::size_t digest_size, const byte* data, std::size_t length, byte* digest);
+
+    /**
+     * @brief Number of messages hash_many() processes side by side.
+     */
+    static const std::size_t lanes = 4;
+
+    /**
+     * @brief Hash count independent messages, several at a time.
+     *
+     * Compressions of up to lanes messages run in lockstep, in AVX2 registers when the CPU
+     * supports it. A lane which finishes its message takes the next one, so messages of
+     * different lengths keep all lanes busy.
+     */
+    static void hash_many(std::size_t digest_size, const byte* const* data, const std::size_t* lengths,
+                          byte* const* digests, std::size_t count);
+
+    /**
+     * @brief Compression function g_N(h, m) with N given as a 64-bit counter of hashed bits.
+     *
+     * N never exceeds 2^64 bits in practice, so its upper words are always zero.
+     */
+    static void compress(block& h, const block& m, uint64_t N);
+
+    /**
+     * @brief compress() of count <= lanes independent inputs.
+     */
+    static void compress(block* const* h, const block* const* m, const uint64_t* N, std::size_t count);
+
+    /**
+     * @brief Implementations of compress() of several inputs.
+     *
+     * By default the AVX2 kernel is used if the CPU has it and it wins a short timing race
+     * against the generic one on first use. The GOST_ECC_STREEBOG_KERNEL environment variable
+     * set to "generic" or "avx2" replaces the race.
+     */
+    enum class kernel {
+        automatic,
+        generic,
+        avx2
+    };
+
+    /**
+     * @brief Override the kernel choice for the whole process, for tests and diagnostics.
+     * @return false if the kernel isn't available on this CPU or build, nothing changes then.
+     */
+    static bool use_kernel(kernel choice);
+
+    /**
+     * @brief Sigma += m modulo 2^512.
+     */
+    static void add(block& sigma, const block& m);
+
+    /**
+     * @brief Load a padded final block: data, one 0x01 byte, zeros.
+     * @param length Less than block_size.
+     */
+    static block pad(const byte* data, std::size_t length);
+
+private:
+    std::size_t size;
+    block h;
+    block sigma;
+    uint64_t N;
+
+    byte buffer[block_size];
+    std::size_t buffered;
+};
+
+}
+
+#endif // STREEBOG_H
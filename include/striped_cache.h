@@ -0,0 +1,91 @@
+#ifndef STRIPED_CACHE_H
+#define STRIPED_CACHE_H
+
+#include <aligned.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace gost_ecc {
+
+/**
+ * @brief Bounded thread-safe map for caching results of expensive computations.
+ *
+ * Keys are spread between independently locked stripes by their hash, so threads working with
+ * different keys rarely wait for each other. Each stripe holds at most capacity / stripes
+ * entries and evicts the oldest one when full.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key> >
+class striped_cache {
+    struct stripe {
+        std::mutex mutex;
+        std::unordered_map<Key, Value, Hash> entries;
+        std::deque<Key> order;
+    };
+
+    const Hash hash;
+    const std::size_t stripe_capacity;
+    aligned_array<stripe> stripes;
+
+    stripe& stripe_for(const Key& key, std::size_t& key_hash) {
+        key_hash = this->hash(key);
+        return this->stripes[key_hash % this->stripes.size()];
+    }
+
+public:
+    /**
+     * @param capacity Maximum total number of entries, rounded up to a multiple of stripes.
+     * @param stripes Number of locks.
+     */
+    explicit striped_cache(std::size_t capacity, std::size_t stripes = 16)
+        :hash(), stripe_capacity((capacity + stripes - 1) / stripes), stripes(stripes)
+    {}
+
+    /**
+     * @return true and copy of cached value to value if key is present.
+     */
+    bool find(const Key& key, Value& value) {
+        std::size_t key_hash;
+        stripe& s = this->stripe_for(key, key_hash);
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.entries.find(key);
+        if (it == s.entries.end()) {
+            return false;
+        }
+
+        value = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Insert or replace value for key, evicting the oldest entry of a full stripe.
+     */
+    void insert(const Key& key, const Value& value) {
+        if (this->stripe_capacity == 0) {
+            return;
+        }
+
+        std::size_t key_hash;
+        stripe& s = this->stripe_for(key, key_hash);
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto inserted = s.entries.insert(std::make_pair(key, value));
+        if (!inserted.second) {
+            inserted.first->second = value;
+            return;
+        }
+
+        s.order.push_back(key);
+        if (s.order.size() > this->stripe_capacity) {
+            s.entries.erase(s.order.front());
+            s.order.pop_front();
+        }
+    }
+};
+
+}
+
+#endif // STRIPED_CACHE_H
@@ -0,0 +1,26 @@
+#ifndef TABLE_SCAN_H
+#define TABLE_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gost_ecc {
+
+/**
+ * @brief Table lookup, which reads every entry regardless of index.
+ *
+ * Memory access pattern and timing don't depend on index, so secret-derived indices don't leak
+ * through the cache. Uses AVX2 when the CPU supports it and entry_limbs is a multiple of 4.
+ * @param table entries * entry_limbs limbs.
+ * @param out entry_limbs limbs, set to table entry index.
+ */
+void scan_select(const uint64_t* table, std::size_t entries, std::size_t entry_limbs, std::size_t index, uint64_t* out);
+
+/**
+ * @brief Branch-free out = condition ? a : b, out may alias a or b.
+ */
+void masked_select(bool condition, const uint64_t* a, const uint64_t* b, uint64_t* out, std::size_t limbs);
+
+}
+
+#endif // TABLE_SCAN_H
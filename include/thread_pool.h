@@ -0,0 +1,87 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <aligned.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gost_ecc {
+
+/**
+ * @brief Work-stealing pool of worker threads.
+ *
+ * Each worker owns a task deque. Tasks are distributed between deques round-robin, a worker
+ * takes tasks from the back of its own deque and steals from the front of the others' when it
+ * runs out of work. Per-worker state is kept on separate cache lines.
+ */
+class thread_pool {
+public:
+    using task = std::function<void()>;
+
+    /**
+     * @param threads Number of worker threads, 0 means number of available CPUs.
+     * @param on_start Called by each worker with its index before it takes any tasks, e.g. to
+     * set CPU affinity.
+     */
+    explicit thread_pool(unsigned threads = 0, std::function<void(unsigned)> on_start = nullptr);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    void submit(task t);
+
+    /**
+     * @brief Call body(i) for every i in [0, count) on the pool and wait for completion.
+     *
+     * Range is split into chunks of adjacent indices, several per worker, so that stealing can
+     * balance uneven work. If body throws, the first exception is rethrown in the caller after
+     * all chunks have finished.
+     */
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    static unsigned hardware_threads();
+
+    /**
+     * @brief Run tasks on temporary threads, at most hardware_threads() at once, and wait for all
+     * of them. Runs them in the calling thread on single-CPU machines.
+     *
+     * For one-off work such as building tables, when no pool exists yet. Rethrows the first
+     * exception thrown by a task.
+     */
+    static void run_parallel(const std::vector<std::function<void()> >& tasks);
+
+private:
+    struct worker {
+        std::mutex mutex;
+        std::deque<task> tasks;
+        std::thread thread;
+    };
+
+    aligned_array<worker> workers;
+    std::function<void(unsigned)> on_start;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<std::size_t> pending;
+    std::atomic<unsigned> next_worker;
+    bool stopping;
+
+    bool try_pop(unsigned self, task& t);
+    void run(unsigned self);
+    void stop();
+};
+
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,183 @@
+#include <context.h>
+#include <streebog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+/**
+ * Jobs are handed to the engine in chunks, so that each chunk shares its field inversions.
+ * Without a pool the whole batch is a single chunk, with a pool chunks are made large enough
+ * to give each worker a few of them, but not smaller than this.
+ */
+const std::size_t min_chunk_size = 16;
+
+void run_chunks(const Gost12S512Ctx* ctx, std::size_t count, const std::function<void(std::size_t, std::size_t)>& body) {
+    if (!ctx->pool) {
+        body(0, count);
+        return;
+    }
+
+    const std::size_t chunks_per_worker = 4;
+    const std::size_t target = ctx->pool->size() * chunks_per_worker;
+    const std::size_t chunk_size = std::max(min_chunk_size, (count + target - 1) / target);
+
+    const std::size_t chunks = (count + chunk_size - 1) / chunk_size;
+    ctx->pool->parallel_for(chunks, [&body, count, chunk_size](std::size_t i) {
+        const std::size_t begin = i * chunk_size;
+        body(begin, std::min(count, begin + chunk_size) - begin);
+    });
+}
+
+}
+
+Gost12S512Status Gost12S512CtxSignBatch(const Gost12S512Ctx* ctx, Gost12S512SignJob* jobs, size_t count) {
+    if (ctx == nullptr || (jobs == nullptr && count > 0)) {
+        return kStatusBadInput;
+    }
+
+    try {
+        run_chunks(ctx, count, [ctx, jobs](std::size_t begin, std::size_t size) {
+            try {
+                ctx->local_engine().sign(jobs + begin, size);
+            } catch (const std::exception&) {
+                for (std::size_t i = begin; i < begin + size; i++) {
+                    jobs[i].status = kStatusInternalError;
+                }
+            }
+        });
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+
+    return kStatusOk;
+}
+
+Gost12S512Status Gost12S512CtxVerifyBatch(const Gost12S512Ctx* ctx, Gost12S512VerifyJob* jobs, size_t count) {
+    if (ctx == nullptr || (jobs == nullptr && count > 0)) {
+        return kStatusBadInput;
+    }
+
+    try {
+        run_chunks(ctx, count, [ctx, jobs](std::size_t begin, std::size_t size) {
+            try {
+                ctx->verify(jobs + begin, size);
+            } catch (const std::exception&) {
+                for (std::size_t i = begin; i < begin + size; i++) {
+                    jobs[i].status = kStatusInternalError;
+                }
+            }
+        });
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+
+    return kStatusOk;
+}
+
+Gost12S512Status Gost12S512CtxVerifyMessageBatch(const Gost12S512Ctx* ctx, Gost12S512VerifyMessageJob* jobs, size_t count) {
+    if (ctx == nullptr || (jobs == nullptr && count > 0)) {
+        return kStatusBadInput;
+    }
+
+    using ::gost_ecc::streebog;
+
+    try {
+        run_chunks(ctx, count, [ctx, jobs](std::size_t begin, std::size_t size) {
+            try {
+                std::vector<const streebog::byte*> messages(size);
+                std::vector<std::size_t> sizes(size);
+                std::vector<std::array<uint64_t, 8> > hashes(size);
+                std::vector<streebog::byte*> digests(size);
+
+                for (std::size_t i = 0; i < size; i++) {
+                    messages[i] = reinterpret_cast<const streebog::byte*>(jobs[begin + i].message);
+                    sizes[i] = jobs[begin + i].size;
+                    digests[i] = reinterpret_cast<streebog::byte*>(hashes[i].data());
+                }
+                streebog::hash_many(64, messages.data(), sizes.data(), digests.data(), size);
+
+                std::vector<Gost12S512VerifyJob> verify_jobs(size);
+                for (std::size_t i = 0; i < size; i++) {
+                    verify_jobs[i].publicKeyX = jobs[begin + i].publicKeyX;
+                    verify_jobs[i].publicKeyY = jobs[begin + i].publicKeyY;
+                    verify_jobs[i].hash = reinterpret_cast<const char*>(hashes[i].data());
+                    verify_jobs[i].signature = jobs[begin + i].signature;
+                }
+                ctx->verify(verify_jobs.data(), size);
+
+                for (std::size_t i = 0; i < size; i++) {
+                    jobs[begin + i].status = verify_jobs[i].status;
+                }
+            } catch (const std::exception&) {
+                for (std::size_t i = begin; i < begin + size; i++) {
+                    jobs[i].status = kStatusInternalError;
+                }
+            }
+        });
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+
+    return kStatusOk;
+}
+
+Gost12S512Status Gost12S512CtxPresign(const Gost12S512Ctx* ctx, const char* const* rand, Gost12S512Token* tokens, size_t count) {
+    if (ctx == nullptr || ((rand == nullptr || tokens == nullptr) && count > 0)) {
+        return kStatusBadInput;
+    }
+
+    std::atomic<bool> all_valid(true);
+    std::atomic<bool> failed(false);
+
+    try {
+        run_chunks(ctx, count, [ctx, rand, tokens, &all_valid, &failed](std::size_t begin, std::size_t size) {
+            try {
+                std::vector<Gost12S512Status> statuses(size);
+                ctx->local_engine().presign(rand + begin, tokens + begin, statuses.data(), size);
+                if (std::find(statuses.begin(), statuses.end(), kStatusBadInput) != statuses.end()) {
+                    all_valid = false;
+                }
+            } catch (const std::exception&) {
+                // Zero tokens of the chunk are rejected by Gost12S512CtxSignWithToken().
+                std::memset(tokens + begin, 0, size * sizeof(Gost12S512Token));
+                failed = true;
+            }
+        });
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+
+    if (failed) {
+        return kStatusInternalError;
+    }
+    return all_valid ? kStatusOk : kStatusBadInput;
+}
+
+Gost12S512Status Gost12S512CtxDeriveKeys(const Gost12S512Ctx* ctx,
+                                         const char* const* privateKeys,
+                                         char* const* publicKeysX,
+                                         char* const* publicKeysY,
+                                         size_t count) {
+    if (ctx == nullptr || ((privateKeys == nullptr || publicKeysX == nullptr || publicKeysY == nullptr) && count > 0)) {
+        return kStatusBadInput;
+    }
+
+    std::atomic<bool> all_valid(true);
+
+    try {
+        run_chunks(ctx, count, [ctx, privateKeys, publicKeysX, publicKeysY, &all_valid](std::size_t begin, std::size_t size) {
+            if (!ctx->local_engine().derive_keys(privateKeys + begin, publicKeysX + begin, publicKeysY + begin, size)) {
+                all_valid = false;
+            }
+        });
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+
+    return all_valid ? kStatusOk : kStatusBadInput;
+}
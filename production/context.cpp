@@ -0,0 +1,330 @@
+#include <context.h>
+#include <curve.h>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <stdexcept>
+
+using ::gost_ecc::byte;
+using ::gost_ecc::signature;
+
+namespace {
+
+::gost_ecc::aligned_ptr<signature> create_engine(Gost12S512ParamSet paramset, unsigned flags) {
+    switch (paramset) {
+    case kGost12S512ParamSetA:
+        return ::gost_ecc::aligned_new<signature>(::gost_ecc::p, ::gost_ecc::a, ::gost_ecc::b, ::gost_ecc::q, ::gost_ecc::x0, ::gost_ecc::y0, flags);
+    case kGost12S512ParamSetB:
+        return ::gost_ecc::aligned_new<signature>(::gost_ecc::paramset_b::p, ::gost_ecc::paramset_b::a, ::gost_ecc::paramset_b::b,
+                                                  ::gost_ecc::paramset_b::q, ::gost_ecc::paramset_b::x0, ::gost_ecc::paramset_b::y0, flags);
+    }
+
+    throw std::invalid_argument("Unknown parameter set.");
+}
+
+}
+
+void Gost12S512CtxOptionsInit(Gost12S512CtxOptions* options) {
+    options->flags = kGost12S512CtxDefault;
+    options->threads = 0;
+    options->keyCacheSize = 4096;
+    options->verifyCacheSize = 0;
+}
+
+Gost12S512Ctx* Gost12S512CtxCreate(Gost12S512ParamSet paramset, const Gost12S512CtxOptions* options) {
+    try {
+        std::unique_ptr<Gost12S512Ctx> ctx(new Gost12S512Ctx());
+        ctx->paramset = paramset;
+
+        if (options != nullptr) {
+            ctx->options = *options;
+        } else {
+            Gost12S512CtxOptionsInit(&ctx->options);
+        }
+
+        ctx->engine = create_engine(paramset, ctx->options.flags);
+
+        if ((ctx->options.flags & kGost12S512CtxNumaReplicate) && ::gost_ecc::numa::nodes() > 1) {
+            for (unsigned node = 0; node < ::gost_ecc::numa::nodes(); node++) {
+                ctx->replicas.push_back(::gost_ecc::numa::make_on_node<const signature>(node, *ctx->engine));
+            }
+        }
+
+        if (ctx->options.flags & kGost12S512CtxThreadPool) {
+            const Gost12S512Ctx* self = ctx.get();
+            ctx->pool.reset(new ::gost_ecc::thread_pool(ctx->options.threads, [self](unsigned index) {
+                self->bind_worker(index);
+            }));
+        }
+
+        if (ctx->options.flags & kGost12S512CtxLowLatency) {
+            ctx->helper.reset(new ::gost_ecc::spin_worker());
+        }
+
+        if (ctx->options.keyCacheSize > 0) {
+            ctx->key_cache.reset(new ::gost_ecc::striped_cache<Gost12S512Ctx::compressed_key, std::array<uint64_t, 8>,
+                                 Gost12S512Ctx::compressed_key_hash>(ctx->options.keyCacheSize));
+        }
+
+        if (ctx->options.verifyCacheSize > 0) {
+            ctx->verify_cache.reset(new ::gost_ecc::striped_cache<Gost12S512Ctx::verify_input, Gost12S512Status,
+                                    Gost12S512Ctx::verify_input_hash>(ctx->options.verifyCacheSize));
+        }
+        return ctx.release();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+uint64_t Gost12S512Ctx::fingerprint(const uint64_t* limbs, std::size_t count, uint64_t tweak) {
+    static const uint64_t seed = []() {
+        uint64_t value = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        try {
+            std::random_device device;
+            value ^= (static_cast<uint64_t>(device()) << 32) ^ device();
+        } catch (const std::exception&) {
+            // The clock alone still differs between processes.
+        }
+        return value;
+    }();
+
+    uint64_t mixed = (seed ^ tweak) * 0x9e3779b97f4a7c15ull;
+    for (std::size_t i = 0; i < count; i++) {
+        mixed = (mixed ^ limbs[i]) * 0xff51afd7ed558ccdull;
+        mixed ^= mixed >> 32;
+    }
+    return mixed;
+}
+
+bool Gost12S512Ctx::find_verified(const Gost12S512VerifyJob& job, verify_input& input, Gost12S512Status& status) const {
+    if (!this->verify_cache) {
+        return false;
+    }
+
+    char* data = reinterpret_cast<char*>(input.data.data());
+    data = std::copy(job.publicKeyX, job.publicKeyX + 64, data);
+    data = std::copy(job.publicKeyY, job.publicKeyY + 64, data);
+    data = std::copy(job.hash, job.hash + 64, data);
+    std::copy(job.signature, job.signature + 128, data);
+
+    return this->verify_cache->find(input, status);
+}
+
+void Gost12S512Ctx::remember_verified(const verify_input& input, Gost12S512Status status) const {
+    if (this->verify_cache && (status == kStatusOk ||
+            (status == kStatusWrongSignature && (this->options.flags & kGost12S512CtxCacheRejected)))) {
+        this->verify_cache->insert(input, status);
+    }
+}
+
+void Gost12S512Ctx::verify(Gost12S512VerifyJob* jobs, std::size_t count) const {
+    if (!this->verify_cache) {
+        this->local_engine().verify(jobs, count);
+        return;
+    }
+
+    std::vector<verify_input> inputs;
+    std::vector<Gost12S512VerifyJob> missed;
+    std::vector<std::size_t> missed_index;
+
+    verify_input input;
+    for (std::size_t i = 0; i < count; i++) {
+        if (!this->find_verified(jobs[i], input, jobs[i].status)) {
+            inputs.push_back(input);
+            missed.push_back(jobs[i]);
+            missed_index.push_back(i);
+        }
+    }
+
+    this->local_engine().verify(missed.data(), missed.size());
+
+    for (std::size_t i = 0; i < missed.size(); i++) {
+        jobs[missed_index[i]].status = missed[i].status;
+        this->remember_verified(inputs[i], missed[i].status);
+    }
+}
+
+void Gost12S512CtxDestroy(Gost12S512Ctx* ctx) {
+    delete ctx;
+}
+
+size_t Gost12S512CtxMemoryUsage(const Gost12S512Ctx* ctx) {
+    if (ctx == nullptr) {
+        return 0;
+    }
+
+    size_t usage = sizeof(Gost12S512Ctx) + ctx->engine->memory_usage();
+
+    for (const auto& replica : ctx->replicas) {
+        usage += replica->memory_usage();
+    }
+
+    usage += ctx->options.keyCacheSize * (sizeof(Gost12S512Ctx::compressed_key) + sizeof(std::array<uint64_t, 8>));
+    usage += ctx->options.verifyCacheSize * sizeof(Gost12S512Ctx::verify_input);
+
+    return usage;
+}
+
+Gost12S512Status Gost12S512CtxSign(const Gost12S512Ctx* ctx,
+                                   const char* privateKey,
+                                   const char* rand,
+                                   const char* hash,
+                                   char* signature) {
+    if (ctx == nullptr) {
+        return kStatusInternalError;
+    }
+
+    try {
+        if (ctx->helper) {
+            return ctx->local_engine().sign(reinterpret_cast<const byte*>(privateKey),
+                                     reinterpret_cast<const byte*>(rand),
+                                     reinterpret_cast<const byte*>(hash),
+                                     reinterpret_cast<byte*>(signature),
+                                     *ctx->helper);
+        }
+
+        return ctx->local_engine().sign(reinterpret_cast<const byte*>(privateKey),
+                                 reinterpret_cast<const byte*>(rand),
+                                 reinterpret_cast<const byte*>(hash),
+                                 reinterpret_cast<byte*>(signature));
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+}
+
+Gost12S512Status Gost12S512CtxVerify(const Gost12S512Ctx* ctx,
+                                     const char* publicKeyX,
+                                     const char* publicKeyY,
+                                     const char* hash,
+                                     const char* signature) {
+    if (ctx == nullptr) {
+        return kStatusInternalError;
+    }
+
+    try {
+        Gost12S512VerifyJob job = {publicKeyX, publicKeyY, hash, signature, kStatusInternalError};
+        Gost12S512Ctx::verify_input input;
+        if (ctx->find_verified(job, input, job.status)) {
+            return job.status;
+        }
+
+        if (ctx->helper) {
+            job.status = ctx->local_engine().verify(reinterpret_cast<const byte*>(publicKeyX),
+                                             reinterpret_cast<const byte*>(publicKeyY),
+                                             reinterpret_cast<const byte*>(hash),
+                                             reinterpret_cast<const byte*>(signature),
+                                             *ctx->helper);
+        } else {
+            ctx->local_engine().verify(&job, 1);
+        }
+
+        ctx->remember_verified(input, job.status);
+        return job.status;
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+}
+
+Gost12S512Status Gost12S512CtxDecompressKey(const Gost12S512Ctx* ctx,
+                                            const char* publicKeyX,
+                                            int yParity,
+                                            char* publicKeyY) {
+    if (ctx == nullptr) {
+        return kStatusInternalError;
+    }
+    if (publicKeyX == nullptr || publicKeyY == nullptr) {
+        return kStatusBadInput;
+    }
+
+    try {
+        Gost12S512Ctx::compressed_key key;
+        std::copy(publicKeyX, publicKeyX + sizeof(key.x), reinterpret_cast<char*>(key.x.data()));
+        key.y_odd = (yParity & 1) != 0;
+
+        std::array<uint64_t, 8> y;
+        if (ctx->key_cache && ctx->key_cache->find(key, y)) {
+            std::copy(reinterpret_cast<const char*>(y.data()), reinterpret_cast<const char*>(y.data()) + sizeof(y), publicKeyY);
+            return kStatusOk;
+        }
+
+        Gost12S512Status status = ctx->local_engine().decompress(reinterpret_cast<const byte*>(key.x.data()), key.y_odd,
+                                                                 reinterpret_cast<byte*>(y.data()));
+        if (status != kStatusOk) {
+            return status;
+        }
+
+        if (ctx->key_cache) {
+            ctx->key_cache->insert(key, y);
+        }
+
+        std::copy(reinterpret_cast<const char*>(y.data()), reinterpret_cast<const char*>(y.data()) + sizeof(y), publicKeyY);
+        return kStatusOk;
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+}
+
+Gost12S512Status Gost12S512CtxVerifyCompressed(const Gost12S512Ctx* ctx,
+                                               const char* publicKeyX,
+                                               int yParity,
+                                               const char* hash,
+                                               const char* signature) {
+    char publicKeyY[64];
+    Gost12S512Status status = Gost12S512CtxDecompressKey(ctx, publicKeyX, yParity, publicKeyY);
+    if (status != kStatusOk) {
+        return status;
+    }
+
+    return Gost12S512CtxVerify(ctx, publicKeyX, publicKeyY, hash, signature);
+}
+
+Gost12S512Status Gost12S512CtxSignWithToken(const Gost12S512Ctx* ctx,
+                                            const Gost12S512Token* token,
+                                            const char* privateKey,
+                                            const char* hash,
+                                            char* signature) {
+    if (ctx == nullptr) {
+        return kStatusInternalError;
+    }
+    if (token == nullptr) {
+        return kStatusBadInput;
+    }
+
+    try {
+        return ctx->local_engine().sign(*token,
+                                        reinterpret_cast<const byte*>(privateKey),
+                                        reinterpret_cast<const byte*>(hash),
+                                        reinterpret_cast<byte*>(signature));
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+}
+
+Gost12S512Status Gost12S512CtxAgree(const Gost12S512Ctx* ctx,
+                                    const char* privateKey,
+                                    const char* publicKeyX,
+                                    const char* publicKeyY,
+                                    const char* ukm,
+                                    size_t ukmSize,
+                                    char* sharedX,
+                                    char* sharedY) {
+    if (ctx == nullptr) {
+        return kStatusInternalError;
+    }
+    if (ukm == nullptr && ukmSize > 0) {
+        return kStatusBadInput;
+    }
+
+    try {
+        return ctx->local_engine().agree(reinterpret_cast<const byte*>(privateKey),
+                                         reinterpret_cast<const byte*>(publicKeyX),
+                                         reinterpret_cast<const byte*>(publicKeyY),
+                                         reinterpret_cast<const byte*>(ukm), ukmSize,
+                                         reinterpret_cast<byte*>(sharedX),
+                                         reinterpret_cast<byte*>(sharedY));
+    } catch (const std::exception&) {
+        return kStatusInternalError;
+    }
+}
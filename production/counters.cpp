@@ -0,0 +1,44 @@
+#include <sign_engine_ext.h>
+#include <op_counters.h>
+
+namespace op_counters = ::gost_ecc::op_counters;
+
+static_assert(static_cast<unsigned>(kGost12S512CounterCount) == op_counters::counter_count,
+              "C and C++ counter lists differ");
+
+Gost12S512Status Gost12S512CountersRead(Gost12S512CountersScope scope,
+                                        uint64_t* values) {
+    if (!op_counters::enabled()) {
+        return kStatusInternalError;
+    }
+
+    switch (scope) {
+    case kGost12S512CountersThread:
+        op_counters::read_thread(values);
+        return kStatusOk;
+    case kGost12S512CountersAll:
+        op_counters::read_all(values);
+        return kStatusOk;
+    }
+    return kStatusBadInput;
+}
+
+Gost12S512Status Gost12S512CountersReset(Gost12S512CountersScope scope) {
+    if (!op_counters::enabled()) {
+        return kStatusInternalError;
+    }
+
+    switch (scope) {
+    case kGost12S512CountersThread:
+        op_counters::reset_thread();
+        return kStatusOk;
+    case kGost12S512CountersAll:
+        op_counters::reset_all();
+        return kStatusOk;
+    }
+    return kStatusBadInput;
+}
+
+const char* Gost12S512CounterName(Gost12S512Counter counter) {
+    return op_counters::name(static_cast<op_counters::counter>(counter));
+}
@@ -85,4 +85,71 @@ uint64_t y0[8] =
  0xA61B8816E25450E6,
  0x7503CFE87A836AE3};
 
+/**
+ * id-tc26-gost-3410-12-512-paramSetB (RFC 7836), p = 2^511 + 111.
+ */
+namespace paramset_b {
+
+uint64_t p[8] = // 2^511 + 111
+{0x000000000000006F,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x8000000000000000};
+
+uint64_t a[8] = // -3 mod p
+{0x000000000000006C,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x8000000000000000};
+
+uint64_t b[8] =
+{0xFB8CCBC7C5140116,
+ 0x50F78BEE1FA3106E,
+ 0x7F8B276FAD1AB69C,
+ 0x3E965D2DB1416D21,
+ 0xBF85DC806C4B289F,
+ 0xB97C7D614AF138BC,
+ 0x7E3E06CF6F5E2517,
+ 0x687D1B459DC84145};
+
+uint64_t q[8] =
+{0xC6346C54374F25BD,
+ 0x8B996712101BEA0E,
+ 0xACFDB77BD9D40CFA,
+ 0x49A1EC142565A545,
+ 0x0000000000000001,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x8000000000000000};
+
+uint64_t x0[8] =
+{0x0000000000000002,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000,
+ 0x0000000000000000};
+
+uint64_t y0[8] =
+{0x7E21340780FE41BD,
+ 0x28041055F94CEEEC,
+ 0x152CBCAAF8C03988,
+ 0xDCB228FD1EDF4A39,
+ 0xBE6DD9E6C8EC7335,
+ 0x3C123B697578C213,
+ 0x2C071E3647A8940F,
+ 0x1A8F7EDA389B094C};
+
+}
+
 }
@@ -0,0 +1,54 @@
+#include <sign_engine_ext.h>
+#include <der.h>
+
+namespace der = ::gost_ecc::der;
+
+static_assert(GOST12S512_DER_SIGNATURE_SIZE == der::signature_size, "DER signature size mismatch");
+
+Gost12S512Status Gost12S512SignatureFromDer(const char* der,
+                                            size_t size,
+                                            char* signature) {
+    if (der == nullptr || signature == nullptr ||
+            !der::read_signature(reinterpret_cast<const der::byte*>(der), size, reinterpret_cast<der::byte*>(signature))) {
+        return kStatusBadInput;
+    }
+    return kStatusOk;
+}
+
+void Gost12S512SignatureToDer(const char* signature,
+                              char* der) {
+    der::write_signature(reinterpret_cast<const der::byte*>(signature), reinterpret_cast<der::byte*>(der));
+}
+
+Gost12S512Status Gost12S512PublicKeyFromDer(const char* der,
+                                            size_t size,
+                                            char* publicKeyX,
+                                            char* publicKeyY) {
+    if (der == nullptr || publicKeyX == nullptr || publicKeyY == nullptr ||
+            !der::read_public_key(reinterpret_cast<const der::byte*>(der), size,
+                                  reinterpret_cast<der::byte*>(publicKeyX), reinterpret_cast<der::byte*>(publicKeyY))) {
+        return kStatusBadInput;
+    }
+    return kStatusOk;
+}
+
+Gost12S512Status Gost12S512CtxVerifyDer(const Gost12S512Ctx* ctx,
+                                        const char* publicKey,
+                                        size_t publicKeySize,
+                                        const char* hash,
+                                        const char* signature,
+                                        size_t signatureSize) {
+    char publicKeyX[64], publicKeyY[64], rawSignature[128];
+
+    Gost12S512Status status = Gost12S512PublicKeyFromDer(publicKey, publicKeySize, publicKeyX, publicKeyY);
+    if (status != kStatusOk) {
+        return status;
+    }
+
+    status = Gost12S512SignatureFromDer(signature, signatureSize, rawSignature);
+    if (status != kStatusOk) {
+        return status;
+    }
+
+    return Gost12S512CtxVerify(ctx, publicKeyX, publicKeyY, hash, rawSignature);
+}
@@ -0,0 +1,82 @@
+#include <sign_engine_ext.h>
+#include <streebog.h>
+
+#include <stdexcept>
+
+using ::gost_ecc::streebog;
+
+struct Gost12S512Hash {
+    streebog impl;
+
+    explicit Gost12S512Hash(size_t digestSize)
+        :impl(digestSize)
+    {}
+};
+
+Gost12S512Hash* Gost12S512HashCreate(size_t digestSize) {
+    try {
+        return new Gost12S512Hash(digestSize);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void Gost12S512HashUpdate(Gost12S512Hash* hash,
+                          const char* data,
+                          size_t size) {
+    if (hash != nullptr) {
+        hash->impl.update(reinterpret_cast<const streebog::byte*>(data), size);
+    }
+}
+
+void Gost12S512HashFinal(Gost12S512Hash* hash,
+                         char* digest) {
+    if (hash != nullptr) {
+        hash->impl.final(reinterpret_cast<streebog::byte*>(digest));
+    }
+}
+
+void Gost12S512HashDestroy(Gost12S512Hash* hash) {
+    delete hash;
+}
+
+Gost12S512Status Gost12S512HashMany(size_t digestSize,
+                                    const char* const* messages,
+                                    const size_t* sizes,
+                                    char* const* digests,
+                                    size_t count) {
+    if ((digestSize != 32 && digestSize != 64) ||
+            ((messages == nullptr || sizes == nullptr || digests == nullptr) && count > 0)) {
+        return kStatusBadInput;
+    }
+
+    streebog::hash_many(digestSize, reinterpret_cast<const streebog::byte* const*>(messages), sizes,
+                        reinterpret_cast<streebog::byte* const*>(digests), count);
+    return kStatusOk;
+}
+
+Gost12S512Status Gost12S512CtxSignMessage(const Gost12S512Ctx* ctx,
+                                          const char* privateKey,
+                                          const char* rand,
+                                          const char* message,
+                                          size_t size,
+                                          char* signature) {
+    alignas(8) char hash[64];
+    streebog::hash(sizeof(hash), reinterpret_cast<const streebog::byte*>(message), size,
+                   reinterpret_cast<streebog::byte*>(hash));
+
+    return Gost12S512CtxSign(ctx, privateKey, rand, hash, signature);
+}
+
+Gost12S512Status Gost12S512CtxVerifyMessage(const Gost12S512Ctx* ctx,
+                                            const char* publicKeyX,
+                                            const char* publicKeyY,
+                                            const char* message,
+                                            size_t size,
+                                            const char* signature) {
+    alignas(8) char hash[64];
+    streebog::hash(sizeof(hash), reinterpret_cast<const streebog::byte*>(message), size,
+                   reinterpret_cast<streebog::byte*>(hash));
+
+    return Gost12S512CtxVerify(ctx, publicKeyX, publicKeyY, hash, signature);
+}
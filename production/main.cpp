@@ -1,36 +1,41 @@
-#include <curve.h>
-#include <signature.h>
-
-#include <iostream>
-#include <algorithm>
 #include <sign_engine.h>
-#include <cryptopp/ecp.h>
+#include <sign_engine_ext.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace {
 
-using namespace CryptoPP;
+/**
+ * Created once under the mutex, read by Sign and Verify without it.
+ */
+std::atomic<Gost12S512Ctx*> default_ctx(nullptr);
+std::mutex default_ctx_mutex;
 
-::gost_ecc::signature* s;
+}
 
 Gost12S512Status Gost12S512Init() {
-    s = new ::gost_ecc::signature(::gost_ecc::p, ::gost_ecc::a, ::gost_ecc::b, ::gost_ecc::q, ::gost_ecc::x0, ::gost_ecc::y0);
-    return kStatusOk;
+    std::lock_guard<std::mutex> lock(default_ctx_mutex);
+
+    Gost12S512Ctx* ctx = default_ctx.load(std::memory_order_relaxed);
+    if (ctx == nullptr) {
+        ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, nullptr);
+        default_ctx.store(ctx, std::memory_order_release);
+    }
+
+    return (ctx != nullptr) ? kStatusOk : kStatusInternalError;
 }
 
 Gost12S512Status Gost12S512Sign( const char* privateKey,
                                  const char* rand,
                                  const char* hash,
                                  char* signature ) {
-    return s->sign(reinterpret_cast<const byte*>(privateKey),
-                   reinterpret_cast<const byte*>(rand),
-                   reinterpret_cast<const byte*>(hash),
-                   reinterpret_cast<byte*>(signature));
+    return Gost12S512CtxSign(default_ctx.load(std::memory_order_acquire), privateKey, rand, hash, signature);
 }
 
 Gost12S512Status Gost12S512Verify( const char* publicKeyX,
                                    const char* publicKeyY,
                                    const char* hash,
                                    const char* signature ) {
-    return s->verify(reinterpret_cast<const byte*>(publicKeyX),
-                   reinterpret_cast<const byte*>(publicKeyY),
-                   reinterpret_cast<const byte*>(hash),
-                   reinterpret_cast<const byte*>(signature));
+    return Gost12S512CtxVerify(default_ctx.load(std::memory_order_acquire), publicKeyX, publicKeyY, hash, signature);
 }
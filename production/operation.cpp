@@ -0,0 +1,80 @@
+#include <context.h>
+
+using ::gost_ecc::byte;
+
+struct Gost12S512Operation {
+    std::unique_ptr< ::gost_ecc::signature::operation> impl;
+    Gost12S512Status error;
+};
+
+Gost12S512Operation* Gost12S512CtxSignStart(const Gost12S512Ctx* ctx,
+                                            const char* privateKey,
+                                            const char* rand,
+                                            const char* hash,
+                                            char* signature) {
+    if (ctx == nullptr) {
+        return nullptr;
+    }
+
+    try {
+        std::unique_ptr<Gost12S512Operation> op(new Gost12S512Operation());
+        op->impl = ctx->local_engine().start_sign(reinterpret_cast<const byte*>(privateKey),
+                                           reinterpret_cast<const byte*>(rand),
+                                           reinterpret_cast<const byte*>(hash),
+                                           reinterpret_cast<byte*>(signature));
+        op->error = kStatusOk;
+        return op.release();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+Gost12S512Operation* Gost12S512CtxVerifyStart(const Gost12S512Ctx* ctx,
+                                              const char* publicKeyX,
+                                              const char* publicKeyY,
+                                              const char* hash,
+                                              const char* signature) {
+    if (ctx == nullptr) {
+        return nullptr;
+    }
+
+    try {
+        std::unique_ptr<Gost12S512Operation> op(new Gost12S512Operation());
+        op->impl = ctx->local_engine().start_verify(reinterpret_cast<const byte*>(publicKeyX),
+                                             reinterpret_cast<const byte*>(publicKeyY),
+                                             reinterpret_cast<const byte*>(hash),
+                                             reinterpret_cast<const byte*>(signature));
+        op->error = kStatusOk;
+        return op.release();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+int Gost12S512OperationStep(Gost12S512Operation* operation, unsigned budget) {
+    if (operation == nullptr) {
+        return 1;
+    }
+    if (operation->error != kStatusOk) {
+        return 1;
+    }
+
+    try {
+        return operation->impl->step(budget) ? 1 : 0;
+    } catch (const std::exception&) {
+        operation->error = kStatusInternalError;
+        return 1;
+    }
+}
+
+Gost12S512Status Gost12S512OperationStatus(const Gost12S512Operation* operation) {
+    if (operation == nullptr || operation->error != kStatusOk || !operation->impl->done()) {
+        return kStatusInternalError;
+    }
+
+    return operation->impl->status();
+}
+
+void Gost12S512OperationDestroy(Gost12S512Operation* operation) {
+    delete operation;
+}
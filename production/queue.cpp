@@ -0,0 +1,288 @@
+#include <context.h>
+#include <ring.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+using ::gost_ecc::ring;
+
+struct Gost12S512Queue {
+    /**
+     * Upper bound for a micro-batch. Workers take whatever is available up to this limit, so
+     * batches grow with load and a lone request is served immediately.
+     */
+    static const std::size_t max_batch = 16;
+
+    /**
+     * Number of empty polls before a worker goes to sleep.
+     */
+    static const unsigned spin_limit = 1024;
+
+    const Gost12S512Ctx* ctx;
+    const std::size_t capacity;
+
+    ring<Gost12S512Request> submissions;
+    ring<Gost12S512Completion> completions;
+
+    Gost12S512CompletionCallback callback;
+    void* callback_arg;
+
+    int event_fd;
+
+    // Requests submitted and not yet reaped (or not yet passed to callback).
+    std::atomic<std::size_t> in_flight;
+    // Requests submitted and not yet taken by a worker.
+    std::atomic<std::size_t> pending;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<unsigned> sleeping;
+    bool stopping;
+
+    std::vector<std::thread> workers;
+
+    Gost12S512Queue(const Gost12S512Ctx* ctx, std::size_t capacity,
+                    Gost12S512CompletionCallback callback, void* callback_arg)
+        :ctx(ctx), capacity(capacity), submissions(capacity), completions(capacity),
+          callback(callback), callback_arg(callback_arg), event_fd(-1),
+          in_flight(0), pending(0), sleeping(0), stopping(false)
+    {
+#ifdef __linux__
+        this->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+
+    ~Gost12S512Queue() {
+        this->stop();
+
+        if (this->event_fd >= 0) {
+#ifdef __linux__
+            close(this->event_fd);
+#endif
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->sleep_mutex);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+        this->workers.clear();
+    }
+
+    void notify(std::size_t submitted) {
+        if (this->sleeping > 0) {
+            std::lock_guard<std::mutex> lock(this->sleep_mutex);
+            if (submitted > max_batch) {
+                this->wake.notify_all();
+            } else {
+                this->wake.notify_one();
+            }
+        }
+    }
+
+    bool wait_for_requests() {
+        for (unsigned i = 0; i < spin_limit; i++) {
+            if (this->pending > 0) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->sleeping++;
+        this->wake.wait(lock, [this]() { return this->stopping || this->pending > 0; });
+        this->sleeping--;
+
+        return this->pending > 0;
+    }
+
+    void run(unsigned index) {
+        this->ctx->bind_worker(index);
+
+        std::vector<Gost12S512Request> batch;
+        std::vector<Gost12S512SignJob> sign_jobs;
+        std::vector<Gost12S512VerifyJob> verify_jobs;
+        std::vector<void*> sign_data, verify_data;
+        std::vector<const char*> presign_rand;
+        std::vector<Gost12S512Token> presign_tokens;
+        std::vector<Gost12S512Status> presign_statuses;
+        std::vector<const Gost12S512Request*> presign_requests;
+
+        batch.reserve(max_batch);
+
+        while (this->wait_for_requests()) {
+            Gost12S512Request request;
+            batch.clear();
+            while (batch.size() < max_batch && this->submissions.pop(request)) {
+                batch.push_back(request);
+            }
+            this->pending -= batch.size();
+
+            sign_jobs.clear();
+            verify_jobs.clear();
+            sign_data.clear();
+            verify_data.clear();
+            presign_rand.clear();
+            presign_requests.clear();
+
+            for (const Gost12S512Request& r : batch) {
+                if (r.type == kGost12S512RequestPresign) {
+                    presign_rand.push_back(r.rand);
+                    presign_requests.push_back(&r);
+                } else if (r.type == kGost12S512RequestSign) {
+                    Gost12S512SignJob job = {r.privateKey, r.rand, r.hash, r.signature, kStatusInternalError};
+                    sign_jobs.push_back(job);
+                    sign_data.push_back(r.userData);
+                } else {
+                    Gost12S512VerifyJob job = {r.publicKeyX, r.publicKeyY, r.hash, r.signature, kStatusInternalError};
+                    verify_jobs.push_back(job);
+                    verify_data.push_back(r.userData);
+                }
+            }
+
+            try {
+                this->ctx->local_engine().sign(sign_jobs.data(), sign_jobs.size());
+            } catch (const std::exception&) {
+                for (Gost12S512SignJob& job : sign_jobs) {
+                    job.status = kStatusInternalError;
+                }
+            }
+
+            try {
+                this->ctx->verify(verify_jobs.data(), verify_jobs.size());
+            } catch (const std::exception&) {
+                for (Gost12S512VerifyJob& job : verify_jobs) {
+                    job.status = kStatusInternalError;
+                }
+            }
+
+            presign_tokens.resize(presign_rand.size());
+            presign_statuses.resize(presign_rand.size());
+            try {
+                this->ctx->local_engine().presign(presign_rand.data(), presign_tokens.data(), presign_statuses.data(),
+                                                  presign_rand.size());
+            } catch (const std::exception&) {
+                std::fill(presign_statuses.begin(), presign_statuses.end(), kStatusInternalError);
+            }
+
+            for (std::size_t i = 0; i < presign_requests.size(); i++) {
+                if (presign_statuses[i] == kStatusOk) {
+                    *presign_requests[i]->token = presign_tokens[i];
+                }
+                this->complete(presign_requests[i]->userData, presign_statuses[i]);
+            }
+            for (std::size_t i = 0; i < sign_jobs.size(); i++) {
+                this->complete(sign_data[i], sign_jobs[i].status);
+            }
+            for (std::size_t i = 0; i < verify_jobs.size(); i++) {
+                this->complete(verify_data[i], verify_jobs[i].status);
+            }
+
+#ifdef __linux__
+            if (this->event_fd >= 0 && !batch.empty()) {
+                eventfd_write(this->event_fd, batch.size());
+            }
+#endif
+        }
+    }
+
+    void complete(void* user_data, Gost12S512Status status) {
+        Gost12S512Completion completion = {user_data, status};
+
+        if (this->callback != nullptr) {
+            this->callback(&completion, this->callback_arg);
+            this->in_flight--;
+        } else {
+            // Can't fail: number of requests in flight never exceeds ring capacity.
+            this->completions.push(completion);
+        }
+    }
+};
+
+Gost12S512Queue* Gost12S512QueueCreate(const Gost12S512Ctx* ctx, size_t capacity, unsigned workers,
+                                       Gost12S512CompletionCallback callback, void* callbackArg) {
+    if (ctx == nullptr || capacity == 0) {
+        return nullptr;
+    }
+
+    try {
+        std::unique_ptr<Gost12S512Queue> queue(new Gost12S512Queue(ctx, capacity, callback, callbackArg));
+
+        if (workers == 0) {
+            workers = ::gost_ecc::thread_pool::hardware_threads();
+        }
+
+        try {
+            for (unsigned i = 0; i < workers; i++) {
+                queue->workers.push_back(std::thread(&Gost12S512Queue::run, queue.get(), i));
+            }
+        } catch (...) {
+            queue->stop();
+            throw;
+        }
+
+        return queue.release();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void Gost12S512QueueDestroy(Gost12S512Queue* queue) {
+    delete queue;
+}
+
+size_t Gost12S512QueueSubmit(Gost12S512Queue* queue, const Gost12S512Request* requests, size_t count) {
+    if (queue == nullptr || requests == nullptr) {
+        return 0;
+    }
+
+    size_t accepted = 0;
+    for (; accepted < count; accepted++) {
+        if (queue->in_flight.fetch_add(1) >= queue->capacity) {
+            queue->in_flight--;
+            break;
+        }
+
+        queue->pending++;
+        queue->submissions.push(requests[accepted]);
+    }
+
+    if (accepted > 0) {
+        queue->notify(accepted);
+    }
+
+    return accepted;
+}
+
+size_t Gost12S512QueueReap(Gost12S512Queue* queue, Gost12S512Completion* completions, size_t count) {
+    if (queue == nullptr || completions == nullptr) {
+        return 0;
+    }
+
+    size_t reaped = 0;
+    while (reaped < count && queue->completions.pop(completions[reaped])) {
+        reaped++;
+    }
+    queue->in_flight -= reaped;
+
+    return reaped;
+}
+
+int Gost12S512QueueEventFd(const Gost12S512Queue* queue) {
+    return (queue != nullptr) ? queue->event_fd : -1;
+}
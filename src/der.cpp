@@ -0,0 +1,183 @@
+#include <der.h>
+
+#include <algorithm>
+
+namespace gost_ecc {
+namespace der {
+
+namespace {
+
+const std::size_t number_size = 64;
+
+enum : byte {
+    tInteger = 0x02,
+    tBitString = 0x03,
+    tOctetString = 0x04,
+    tSequence = 0x30
+};
+
+/**
+ * @brief Read one element with the expected tag and advance data past it.
+ */
+bool read_element(const byte*& data, const byte* end, byte tag, const byte*& value, std::size_t& size) {
+    if (end - data < 2 || data[0] != tag) {
+        return false;
+    }
+
+    std::size_t length = data[1];
+    data += 2;
+
+    if (length & 0x80) {
+        std::size_t length_bytes = length & 0x7f;
+        if (length_bytes == 0 || length_bytes > 2 || static_cast<std::size_t>(end - data) < length_bytes) {
+            return false;
+        }
+
+        length = 0;
+        for (std::size_t i = 0; i < length_bytes; i++) {
+            length = (length << 8) | *data++;
+        }
+
+        // DER takes the shortest form, anything else is BER.
+        if (length < 0x80 || (length_bytes == 2 && length < 0x100)) {
+            return false;
+        }
+    }
+
+    if (static_cast<std::size_t>(end - data) < length) {
+        return false;
+    }
+
+    value = data;
+    size = length;
+    data += length;
+    return true;
+}
+
+/**
+ * @brief Read BIT STRING without unused bits.
+ */
+bool read_bit_string(const byte*& data, const byte* end, const byte*& value, std::size_t& size) {
+    if (!read_element(data, end, tBitString, value, size) || size == 0 || value[0] != 0) {
+        return false;
+    }
+
+    value++;
+    size--;
+    return true;
+}
+
+/**
+ * @brief Convert big-endian number of size bytes into number_size little-endian bytes.
+ */
+bool reverse_number(const byte* value, std::size_t size, byte* result) {
+    while (size > number_size && *value == 0) {
+        value++;
+        size--;
+    }
+
+    if (size > number_size) {
+        return false;
+    }
+
+    std::reverse_copy(value, value + size, result);
+    std::fill(result + size, result + number_size, 0);
+    return true;
+}
+
+bool read_integer(const byte*& data, const byte* end, byte* result) {
+    const byte* value;
+    std::size_t size;
+
+    // Negative numbers are no valid signature parts, leading zero is only allowed before a set top bit.
+    if (!read_element(data, end, tInteger, value, size) || size == 0 || (value[0] & 0x80)) {
+        return false;
+    }
+    if (size > 1 && value[0] == 0 && !(value[1] & 0x80)) {
+        return false;
+    }
+
+    return reverse_number(value, size, result);
+}
+
+}
+
+bool read_signature(const byte* data, std::size_t size, byte* signature) {
+    const byte* end = data + size;
+    const byte* value;
+    std::size_t value_size;
+
+    if (size > 0 && data[0] == tSequence) {
+        if (!read_element(data, end, tSequence, value, value_size) || data != end) {
+            return false;
+        }
+
+        const byte* value_end = value + value_size;
+        return read_integer(value, value_end, signature) &&
+                read_integer(value, value_end, signature + number_size) &&
+                value == value_end;
+    }
+
+    bool read = (size > 0 && data[0] == tBitString) ?
+                read_bit_string(data, end, value, value_size) :
+                read_element(data, end, tOctetString, value, value_size);
+
+    if (!read || data != end || value_size != 2 * number_size) {
+        return false;
+    }
+
+    std::reverse_copy(value + number_size, value + 2 * number_size, signature);
+    std::reverse_copy(value, value + number_size, signature + number_size);
+    return true;
+}
+
+void write_signature(const byte* signature, byte* data) {
+    data[0] = tOctetString;
+    data[1] = 0x81;
+    data[2] = 2 * number_size;
+
+    std::reverse_copy(signature + number_size, signature + 2 * number_size, data + 3);
+    std::reverse_copy(signature, signature + number_size, data + 3 + number_size);
+}
+
+bool read_public_key(const byte* data, std::size_t size, byte* public_key_x, byte* public_key_y) {
+    const byte* end = data + size;
+    const byte* value;
+    std::size_t value_size;
+
+    if (size > 0 && data[0] == tSequence) {
+        // SubjectPublicKeyInfo: algorithm identifier followed by subjectPublicKey.
+        if (!read_element(data, end, tSequence, value, value_size) || data != end) {
+            return false;
+        }
+
+        const byte* algorithm;
+        std::size_t algorithm_size;
+        end = value + value_size;
+        data = value;
+
+        if (!read_element(data, end, tSequence, algorithm, algorithm_size)) {
+            return false;
+        }
+    }
+
+    if (data != end && data[0] == tBitString) {
+        if (!read_bit_string(data, end, value, value_size) || data != end) {
+            return false;
+        }
+
+        data = value;
+        end = value + value_size;
+    }
+
+    if (!read_element(data, end, tOctetString, value, value_size) || data != end || value_size != 2 * number_size) {
+        return false;
+    }
+
+    std::copy(value, value + number_size, public_key_x);
+    std::copy(value + number_size, value + 2 * number_size, public_key_y);
+    return true;
+}
+
+}
+}
@@ -0,0 +1,148 @@
+#include <numa.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <cstdlib>
+#endif
+
+namespace gost_ecc {
+namespace numa {
+
+namespace {
+
+#ifdef __linux__
+/**
+ * Memory policy from <numaif.h>, which is a part of libnuma development files.
+ */
+const int mpol_bind = 2;
+
+const char* const sysfs_node = "/sys/devices/system/node/node";
+
+/**
+ * @brief Parse CPU list in sysfs format, such as "0-3,8-11".
+ */
+std::vector<unsigned> parse_cpu_list(const std::string& list) {
+    std::vector<unsigned> cpus;
+    std::istringstream in(list);
+    std::string range;
+
+    while (std::getline(in, range, ',')) {
+        std::size_t dash = range.find('-');
+        try {
+            unsigned first = std::stoul(range.substr(0, dash));
+            unsigned last = (dash == std::string::npos) ? first : std::stoul(range.substr(dash + 1));
+            for (unsigned cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            // Skip malformed entries, such as trailing newline.
+        }
+    }
+
+    return cpus;
+}
+#endif
+
+}
+
+std::vector<unsigned> node_cpus(unsigned node) {
+#ifdef __linux__
+    std::ifstream in(sysfs_node + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (std::getline(in, list)) {
+        return parse_cpu_list(list);
+    }
+#else
+    (void)node;
+#endif
+    return std::vector<unsigned>();
+}
+
+unsigned nodes() {
+    static const unsigned count = []() {
+        unsigned n = 0;
+        while (!node_cpus(n).empty()) {
+            n++;
+        }
+        return (n > 0) ? n : 1;
+    }();
+
+    return count;
+}
+
+unsigned current_node() {
+#ifdef __linux__
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 && node < nodes()) {
+        return node;
+    }
+#endif
+    return 0;
+}
+
+bool bind_thread(unsigned node) {
+#ifdef __linux__
+    std::vector<unsigned> cpus = node_cpus(node);
+    if (cpus.empty()) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+void* allocate(std::size_t size, unsigned node) {
+#ifdef __linux__
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    // Kernel only looks at the first maxnode - 1 bits of the mask.
+    const unsigned long mask_bits = sizeof(unsigned long) * 8;
+    if (node < mask_bits - 1) {
+        unsigned long mask = 1ul << node;
+        syscall(SYS_mbind, memory, size, mpol_bind, &mask, mask_bits, 0);
+    }
+
+    return memory;
+#else
+    (void)node;
+    void* memory = std::malloc(size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+#endif
+}
+
+void deallocate(void* ptr, std::size_t size) {
+#ifdef __linux__
+    munmap(ptr, size);
+#else
+    (void)size;
+    std::free(ptr);
+#endif
+}
+
+}
+}
@@ -0,0 +1,142 @@
+#include <op_counters.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+
+namespace gost_ecc {
+
+namespace op_counters {
+
+namespace {
+
+/**
+ * Written only by its thread, atomics just let other threads read and reset it.
+ */
+struct block {
+    std::atomic<uint64_t> values[counter_count];
+
+    block() {
+        for (auto& value : this->values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void reset() {
+        for (auto& value : this->values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct registry {
+    std::mutex mutex;
+    std::set<block*> live;
+    uint64_t finished[counter_count] = {};
+};
+
+/**
+ * Never destroyed: threads may finish after static destructors have run.
+ */
+registry& blocks() {
+    static registry* instance = new registry();
+    return *instance;
+}
+
+struct thread_block {
+    block counts;
+
+    thread_block() {
+        registry& r = blocks();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.insert(&this->counts);
+    }
+
+    ~thread_block() {
+        registry& r = blocks();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (unsigned i = 0; i < counter_count; i++) {
+            r.finished[i] += this->counts.values[i].load(std::memory_order_relaxed);
+        }
+        r.live.erase(&this->counts);
+    }
+};
+
+block& own() {
+    static thread_local thread_block instance;
+    return instance.counts;
+}
+
+const char* const names[counter_count] = {
+    "field_mul",
+    "field_sqr",
+    "field_reduce",
+    "field_add",
+    "field_sub",
+    "field_inverse",
+    "point_twice",
+    "point_add_mixed",
+    "point_add",
+    "point_add_affine",
+    "point_infinity"
+};
+
+}
+
+bool enabled() {
+#ifdef GOST_ECC_OP_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void count(counter c) {
+    std::atomic<uint64_t>& value = own().values[c];
+    value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void read_thread(uint64_t* values) {
+    const block& counts = own();
+    for (unsigned i = 0; i < counter_count; i++) {
+        values[i] = counts.values[i].load(std::memory_order_relaxed);
+    }
+}
+
+void read_all(uint64_t* values) {
+    registry& r = blocks();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    for (unsigned i = 0; i < counter_count; i++) {
+        values[i] = r.finished[i];
+    }
+    for (const block* counts : r.live) {
+        for (unsigned i = 0; i < counter_count; i++) {
+            values[i] += counts->values[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void reset_thread() {
+    own().reset();
+}
+
+void reset_all() {
+    registry& r = blocks();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    for (auto& value : r.finished) {
+        value = 0;
+    }
+    for (block* counts : r.live) {
+        counts->reset();
+    }
+}
+
+const char* name(counter c) {
+    return (c < counter_count) ? names[c] : nullptr;
+}
+
+}
+
+}
@@ -1,6 +1,12 @@
 #include <signature.h>
+#include <table_scan.h>
+#include <thread_pool.h>
 
+#include <algorithm>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <vector>
 
 namespace gost_ecc {
 
@@ -8,10 +14,12 @@ const unsigned signature_size = 64 * 2;
 
 signature::signature(u_int64_t (&modulus)[8], u_int64_t (&a)[8], u_int64_t (&b)[8],
                      u_int64_t (&subgroupModulus)[8],
-                     u_int64_t (&base_x)[8], u_int64_t (&base_y)[8])
+                     u_int64_t (&base_x)[8], u_int64_t (&base_y)[8],
+                     unsigned flags)
     :curve(pf::import_bytes(modulus), pf::import_bytes(a), pf::import_bytes(b)),
       subgroup(pf::import_bytes(subgroupModulus)),
-      basePoint(pf::import_bytes(base_x), pf::import_bytes(base_y))
+      basePoint(pf::import_bytes(base_x), pf::import_bytes(base_y)),
+      compact((flags & kGost12S512CtxCompact) != 0)
 {
 #ifdef DEBUG
     std::cout << "p: " << this->curve.field.modulus << std::endl
@@ -19,21 +27,251 @@ signature::signature(u_int64_t (&modulus)[8], u_int64_t (&a)[8], u_int64_t (&b)[
                     << "m: " << this->subgroup.modulus << std::endl
                        << "x_p: " << this->basePoint.x << std::endl << "y_p: " << this->basePoint.y << std::endl << std::endl;
 #endif
-    this->curve.comb_precompute<comb_window>(this->basePoint, this->basePointTable);
-    this->curve.naf_precompute<static_naf_window>(this->basePoint, this->basePointNafTable);
+    std::vector<std::function<void()> > tasks;
+
+    if (!(flags & kGost12S512CtxLazyTables) && this->compact) {
+        tasks.push_back([this]() {
+            this->base_compact_comb();
+        });
+        tasks.push_back([this]() {
+            this->base_compact_naf();
+        });
+    } else if (!(flags & kGost12S512CtxLazyTables)) {
+        tasks.push_back([this]() {
+            this->base_comb();
+        });
+        tasks.push_back([this]() {
+            this->base_naf();
+        });
+    }
+
+    if ((flags & kGost12S512CtxLowLatency) && !this->compact) {
+        this->basePointTableHigh = aligned_new<comb_table>();
+        tasks.push_back([this]() {
+            const unsigned h = ec::comb_columns<comb_window>() / 2;
+            ec::point basePointHigh = this->curve.repeated_twice(ec::jacobian_point(this->basePoint), h).to_affine(this->curve);
+            this->comb_build(basePointHigh, *this->basePointTableHigh);
+        });
+    }
+
+    if (flags & kGost12S512CtxRegularSign) {
+        this->basePointRegularTable = aligned_new<regular_table>();
+        tasks.push_back([this]() {
+            ec::point table[1 << (regular_window - 1)];
+            this->curve.regular_comb_precompute<regular_window>(this->basePoint, table);
+
+            for (unsigned i = 0; i < (1 << (regular_window - 1)); i++) {
+                pf::export_bytes(table[i].x, this->basePointRegularTable->entries[i]);
+                pf::export_bytes(table[i].y, this->basePointRegularTable->entries[i] + regular_table::limbs / 2);
+            }
+        });
+    }
+
+    thread_pool::run_parallel(tasks);
 
-    std::cout << sizeof(this->basePointTable) << " " << sizeof(this->basePointNafTable) << " " <<
-                 ((sizeof(this->basePointTable) + sizeof(this->basePointNafTable))/1024) << " " <<
-                 sizeof(ec::jacobian_point) << std::endl;
+#ifdef DEBUG
+    std::cout << "memory: " << this->memory_usage() << std::endl;
+#endif
 }
 
-Gost12S512Status signature::sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature) {
+signature::signature(const signature& that)
+    :curve(that.curve), subgroup(that.subgroup), basePoint(that.basePoint), compact(that.compact),
+      basePointTable(that.basePointTable), basePointNafTable(that.basePointNafTable),
+      basePointCompactTable(that.basePointCompactTable), basePointCompactNafTable(that.basePointCompactNafTable)
+{
+    if (that.basePointTableHigh) {
+        this->basePointTableHigh = aligned_new<comb_table>(*that.basePointTableHigh);
+    }
+
+    if (that.basePointRegularTable) {
+        this->basePointRegularTable = aligned_new<regular_table>(*that.basePointRegularTable);
+    }
+}
+
+Gost12S512Status signature::sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature) const {
+    Gost12S512SignJob job = {
+        reinterpret_cast<const char*>(private_key),
+        reinterpret_cast<const char*>(rand),
+        reinterpret_cast<const char*>(hash),
+        reinterpret_cast<char*>(signature),
+        kStatusInternalError
+    };
+
+    this->sign(&job, 1);
+    return job.status;
+}
+
+Gost12S512Status signature::verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature) const {
+    Gost12S512VerifyJob job = {
+        reinterpret_cast<const char*>(public_key_x),
+        reinterpret_cast<const char*>(public_key_y),
+        reinterpret_cast<const char*>(hash),
+        reinterpret_cast<const char*>(signature),
+        kStatusInternalError
+    };
+
+    this->verify(&job, 1);
+    return job.status;
+}
+
+const signature::comb_table& signature::base_comb() const {
+    return this->basePointTable.get([this](comb_table& table) {
+        this->comb_build(this->basePoint, table);
+    });
+}
+
+const signature::naf_table& signature::base_naf() const {
+    return this->basePointNafTable.get([this](naf_table& table) {
+        this->curve.naf_precompute<static_naf_window>(this->basePoint, table.points);
+    });
+}
+
+const signature::compact_comb_table& signature::base_compact_comb() const {
+    return this->basePointCompactTable.get([this](compact_comb_table& table) {
+        this->curve.comb_precompute<compact_comb_window>(this->basePoint, table.points);
+    });
+}
+
+const signature::compact_naf_table& signature::base_compact_naf() const {
+    return this->basePointCompactNafTable.get([this](compact_naf_table& table) {
+        this->curve.naf_precompute<compact_naf_window>(this->basePoint, table.points);
+    });
+}
+
+std::size_t signature::memory_usage() const {
+    std::size_t usage = sizeof(*this) + this->basePointTable.memory_usage() + this->basePointNafTable.memory_usage() +
+            this->basePointCompactTable.memory_usage() + this->basePointCompactNafTable.memory_usage();
+
+    if (this->basePointTableHigh) {
+        usage += sizeof(comb_table);
+    }
+    if (this->basePointRegularTable) {
+        usage += sizeof(regular_table);
+    }
+    return usage;
+}
+
+void signature::comb_build(const ec::point& base, comb_table& table) const {
+    ec::jacobian_point teeth[comb_window];
+    this->curve.comb_teeth<comb_window>(base, teeth);
+
+    // Eight blocks, each starting with a few additions and continuing with one per entry.
+    const unsigned block_bits = comb_window - 3;
+    std::vector<std::function<void()> > tasks;
+
+    for (unsigned first = 0; first < (1u << comb_window); first += 1u << block_bits) {
+        tasks.push_back([this, &teeth, &table, first, block_bits]() {
+            this->curve.comb_fill<comb_window>(teeth, table.points, first, block_bits);
+        });
+    }
+
+    thread_pool::run_parallel(tasks);
+}
+
+signature::ec::jacobian_point signature::mul_base_public(const pf::integer_type& k) const {
+    if (this->compact) {
+        return this->curve.mul_scalar_jacobian<compact_comb_window>(this->base_compact_comb().points, k);
+    }
+    return this->curve.mul_scalar_jacobian<comb_window>(this->base_comb().points, k);
+}
+
+signature::ec::jacobian_point signature::mul_base(const pf::integer_type& k) const {
+    if (!this->basePointRegularTable) {
+        return this->mul_base_public(k);
+    }
+
+    // Regular recoding needs an odd multiplier, for even k compute (q - k) P = -kP and negate.
+    const unsigned limbs = regular_table::limbs / 2;
+    uint64_t multiplier[limbs], negated[limbs];
+    pf::export_bytes(k, multiplier);
+    pf::export_bytes(this->subgroup.modulus - k, negated);
+
+    const bool even = (multiplier[0] & 1) == 0;
+    masked_select(even, negated, multiplier, multiplier, limbs);
+
+    const regular_table& table = *this->basePointRegularTable;
+    const ec::field_type& field = this->curve.field;
+
+    auto select = [&table, &field](unsigned key, bool negate) {
+        uint64_t entry[regular_table::limbs], y_negated[limbs];
+        scan_select(table.entries[0], 1 << (regular_window - 1), regular_table::limbs, key, entry);
+
+        pf::export_bytes(field.inverse(pf::import_bytes(entry + limbs)), y_negated);
+        masked_select(negate, y_negated, entry + limbs, entry + limbs, limbs);
+
+        return ec::point(pf::import_bytes(entry), pf::import_bytes(entry + limbs));
+    };
+
+    ec::jacobian_point result = this->curve.mul_scalar_regular<regular_window>(select, pf::import_bytes(multiplier));
+
+    uint64_t y[limbs];
+    pf::export_bytes(result.y, y);
+    pf::export_bytes(field.inverse(result.y), negated);
+    masked_select(even, negated, y, y, limbs);
+    result.y = pf::import_bytes(y);
+
+    return result;
+}
+
+void signature::mul_base(const pf::integer_type* k, ec::jacobian_point* result, std::size_t count) const {
+    if (this->basePointRegularTable) {
+        // Zero only marks inputs the callers have already rejected, zero nonces included, they
+        // are multiplied by one so that k isn't branched on. The product is never used.
+        const unsigned limbs = regular_table::limbs / 2;
+        const uint64_t one[limbs] = {1};
+
+        for (std::size_t i = 0; i < count; i++) {
+            uint64_t multiplier[limbs];
+            pf::export_bytes(k[i], multiplier);
+
+            uint64_t any = 0;
+            for (unsigned j = 0; j < limbs; j++) {
+                any |= multiplier[j];
+            }
+            masked_select(any == 0, one, multiplier, multiplier, limbs);
+
+            result[i] = this->mul_base(pf::import_bytes(multiplier));
+        }
+        return;
+    }
+
+    if (this->compact) {
+        this->mul_base_interleaved<compact_comb_window>(this->base_compact_comb().points, k, result, count);
+    } else {
+        this->mul_base_interleaved<comb_window>(this->base_comb().points, k, result, count);
+    }
+}
+
+template <unsigned window, typename table_point>
+void signature::mul_base_interleaved(const table_point (&table)[1 << window], const pf::integer_type* k,
+                                     ec::jacobian_point* result, std::size_t count) const {
+    std::vector<ec::comb_multiplication<window, table_point> > lanes;
+    std::vector<std::size_t> lane_jobs;
+    lanes.reserve(interleave_lanes);
+
+    for (std::size_t i = 0; i < count; i++) {
+        if (k[i] != 0) {
+            lanes.emplace_back(this->curve, table, k[i]);
+            lane_jobs.push_back(i);
+        }
+
+        if (lanes.size() == interleave_lanes || (i + 1 == count && !lanes.empty())) {
+            ec::interleave(lanes.data(), lanes.size());
+
+            for (std::size_t j = 0; j < lanes.size(); j++) {
+                result[lane_jobs[j]] = lanes[j].result();
+            }
+            lanes.clear();
+            lane_jobs.clear();
+        }
+    }
+}
+
+signature::pf::integer_type signature::hash_to_e(const byte* hash) const {
     pf::integer_type alpha = pf::import_bytes(hash);
-    pf::integer_type d = pf::import_bytes(private_key);
 
 #ifdef DEBUG
     std::cout << "alpha: " << alpha << std::endl;
-    std::cout << "d: " << d << std::endl;
 #endif
 
     pf::integer_type e = this->subgroup.acquire(alpha);
@@ -44,24 +282,22 @@ Gost12S512Status signature::sign(const byte* private_key, const byte* rand, cons
     std::cout << "e: " << e << std::endl;
 #endif
 
-    pf::integer_type k = pf::import_bytes(rand);
-    if(k >= this->subgroup.modulus) {
-        return kStatusBadInput;
-    }
-
-#ifdef DEBUG
-    std::cout << "k: " << k << std::endl;
-#endif
-
-    ec::point C = this->curve.mul_scalar<comb_window>(this->basePointTable, k);
+    return e;
+}
 
+Gost12S512Status signature::sign_result(const pf::integer_type& d, const pf::integer_type& e,
+                                        const pf::integer_type& k, const ec::point& C, byte* signature) const {
 #ifdef DEBUG
     std::cout << "x_c: " << C.x << std::endl << "y_c: " << C.y << std::endl;
 #endif
 
-    pf::integer_type r = this->subgroup.acquire(C.x);
+    return this->sign_result(d, e, k, this->subgroup.acquire(C.x), signature);
+}
 
+Gost12S512Status signature::sign_result(const pf::integer_type& d, const pf::integer_type& e,
+                                        const pf::integer_type& k, const pf::integer_type& r, byte* signature) const {
 #ifdef DEBUG
+    std::cout << "d: " << d << std::endl;
     std::cout << "r: " << r << std::endl;
 #endif
 
@@ -96,42 +332,507 @@ Gost12S512Status signature::sign(const byte* private_key, const byte* rand, cons
     return kStatusOk;
 }
 
-Gost12S512Status signature::verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature) {
-    pf::integer_type r = pf::import_bytes(signature);
-    pf::integer_type s = pf::import_bytes(signature + signature_size / 2);
+void signature::sign(Gost12S512SignJob* jobs, std::size_t count) const {
+    std::vector<pf::integer_type> k(count);
+    std::vector<ec::jacobian_point> C_jacobian(count, ec::jacobian_point::inf);
+    std::vector<ec::point> C(count);
 
-    pf::integer_type alpha = pf::import_bytes(hash);
+    for (std::size_t i = 0; i < count; i++) {
+        k[i] = pf::import_bytes(jobs[i].rand);
+        if (k[i] == 0 || k[i] >= this->subgroup.modulus) {
+            jobs[i].status = kStatusBadInput;
+            k[i] = 0;
+            continue;
+        }
 
-    pf::integer_type e = this->subgroup.acquire(alpha);
-    if (e == 0) {
-        e = 1;
+#ifdef DEBUG
+        std::cout << "k: " << k[i] << std::endl;
+#endif
+
+        jobs[i].status = kStatusOk;
+    }
+
+    this->mul_base(k.data(), C_jacobian.data(), count);
+
+    this->curve.to_affine(C_jacobian.data(), C.data(), count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        if (jobs[i].status != kStatusOk) {
+            continue;
+        }
+
+        jobs[i].status = this->sign_result(pf::import_bytes(jobs[i].privateKey),
+                                           this->hash_to_e(reinterpret_cast<const byte*>(jobs[i].hash)),
+                                           k[i], C[i], reinterpret_cast<byte*>(jobs[i].signature));
+    }
+}
+
+void signature::verify(Gost12S512VerifyJob* jobs, std::size_t count) const {
+    std::vector<pf::integer_type> r(count);
+    std::vector<pf::integer_type> v(count);
+    std::vector<ec::jacobian_point> C_jacobian(count, ec::jacobian_point::inf);
+    std::vector<ec::point> C(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        r[i] = pf::import_bytes(jobs[i].signature);
+        v[i] = this->hash_to_e(reinterpret_cast<const byte*>(jobs[i].hash));
+    }
+
+    this->subgroup.mul_inverse(v.data(), count);
+
+    if (this->compact) {
+        this->verify_interleaved<compact_naf_window>(this->base_compact_naf().points, jobs, r.data(), v.data(),
+                                                     C_jacobian.data(), count);
+    } else {
+        this->verify_interleaved<static_naf_window>(this->base_naf().points, jobs, r.data(), v.data(),
+                                                    C_jacobian.data(), count);
+    }
+
+    this->curve.to_affine(C_jacobian.data(), C.data(), count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        pf::integer_type R = this->subgroup.acquire(C[i].x);
+
+        if (R == r[i]) {
+            jobs[i].status = kStatusOk;
+        } else {
+            jobs[i].status = kStatusWrongSignature;
+        }
+    }
+}
+
+template <unsigned window, typename table_point>
+void signature::verify_interleaved(const table_point (&table)[1 << (window - 2)], const Gost12S512VerifyJob* jobs,
+                                   const pf::integer_type* r, const pf::integer_type* v,
+                                   ec::jacobian_point* C, std::size_t count) const {
+    using multiplication_type = ec::add_multiplication<dynamic_naf_window, window, ec::jacobian_point, table_point>;
+
+    struct odd_multiples {
+        ec::jacobian_point points[1 << (dynamic_naf_window - 2)];
+    };
+
+    // Multiplications keep references to tables, which therefore must not move.
+    std::unique_ptr<odd_multiples[]> tablesQ(new odd_multiples[interleave_lanes]);
+    std::vector<multiplication_type> lanes;
+    lanes.reserve(interleave_lanes);
+
+    for (std::size_t i = 0; i < count; i++) {
+        pf::integer_type s = pf::import_bytes(jobs[i].signature + signature_size / 2);
+
+        pf::integer_type z_1 = this->subgroup.mul(s, v[i]);
+        pf::integer_type z_2 = this->subgroup.mul(r[i], v[i]);
+        z_2 = this->subgroup.inverse(z_2);
+
+        ec::point Q(pf::import_bytes(jobs[i].publicKeyX), pf::import_bytes(jobs[i].publicKeyY));
+
+        ec::jacobian_point (&tableQ)[1 << (dynamic_naf_window - 2)] = tablesQ[lanes.size()].points;
+        this->curve.naf_precompute<dynamic_naf_window>(Q, tableQ);
+
+        lanes.emplace_back(this->curve, tableQ, z_2, table, z_1);
+
+        if (lanes.size() == interleave_lanes || i + 1 == count) {
+            ec::interleave(lanes.data(), lanes.size());
+
+            for (std::size_t j = 0; j < lanes.size(); j++) {
+                C[i + 1 - lanes.size() + j] = lanes[j].result();
+            }
+            lanes.clear();
+        }
+    }
+}
+
+void signature::presign(const char* const* rand, Gost12S512Token* tokens, Gost12S512Status* statuses, std::size_t count) const {
+    std::vector<pf::integer_type> k(count);
+    std::vector<ec::jacobian_point> C_jacobian(count, ec::jacobian_point::inf);
+    std::vector<ec::point> C(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        k[i] = pf::import_bytes(rand[i]);
+        if (k[i] >= this->subgroup.modulus) {
+            k[i] = 0;
+        }
+        statuses[i] = (k[i] != 0) ? kStatusOk : kStatusBadInput;
+    }
+
+    this->mul_base(k.data(), C_jacobian.data(), count);
+
+    this->curve.to_affine(C_jacobian.data(), C.data(), count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        // Zero r marks the token as unusable.
+        pf::integer_type r = (k[i] != 0) ? this->subgroup.acquire(C[i].x) : pf::integer_type(0);
+
+        pf::export_bytes(k[i], tokens[i].data);
+        pf::export_bytes(r, tokens[i].data + signature_size / 2);
+    }
+}
+
+Gost12S512Status signature::sign(const Gost12S512Token& token, const byte* private_key, const byte* hash, byte* signature) const {
+    pf::integer_type k = pf::import_bytes(token.data);
+    pf::integer_type r = pf::import_bytes(token.data + signature_size / 2);
+
+    if (k == 0 || k >= this->subgroup.modulus || r >= this->subgroup.modulus) {
+        return kStatusBadInput;
+    }
+
+    return this->sign_result(pf::import_bytes(private_key), this->hash_to_e(hash), k, r, signature);
+}
+
+bool signature::derive_keys(const char* const* private_keys, char* const* public_keys_x, char* const* public_keys_y, std::size_t count) const {
+    std::vector<pf::integer_type> d(count);
+    std::vector<ec::jacobian_point> Q_jacobian(count, ec::jacobian_point::inf);
+    std::vector<ec::point> Q(count);
+    bool all_valid = true;
+
+    for (std::size_t i = 0; i < count; i++) {
+        d[i] = pf::import_bytes(private_keys[i]);
+        if (d[i] == 0 || d[i] >= this->subgroup.modulus) {
+            all_valid = false;
+            d[i] = 0;
+        }
     }
 
-    pf::integer_type v = this->subgroup.mul_inverse(e);
+    this->mul_base(d.data(), Q_jacobian.data(), count);
+
+    this->curve.to_affine(Q_jacobian.data(), Q.data(), count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        if (d[i] == 0 || Q[i] == ec::point::inf) {
+            Q[i] = ec::point(0, 0);
+        }
+
+        pf::export_bytes(Q[i].x, public_keys_x[i]);
+        pf::export_bytes(Q[i].y, public_keys_y[i]);
+    }
+
+    return all_valid;
+}
+
+Gost12S512Status signature::decompress(const byte* public_key_x, bool y_odd, byte* public_key_y) const {
+    ec::point Q;
+    if (!this->curve.decompress(pf::import_bytes(public_key_x), y_odd, Q)) {
+        return kStatusBadInput;
+    }
+
+    pf::export_bytes(Q.y, public_key_y);
+    return kStatusOk;
+}
+
+Gost12S512Status signature::agree(const byte* private_key, const byte* public_key_x, const byte* public_key_y,
+                                   const byte* ukm, std::size_t ukm_size, byte* shared_x, byte* shared_y) const {
+    if (ukm_size > ukm_max_size) {
+        return kStatusBadInput;
+    }
+
+    ec::point Q(pf::import_bytes(public_key_x), pf::import_bytes(public_key_y));
+    pf::integer_type d = pf::import_bytes(private_key);
+
+    // Cofactor of the curve is 1, so any finite point of the curve belongs to the subgroup.
+    if (d == 0 || d >= this->subgroup.modulus || !this->curve.contains(Q)) {
+        return kStatusBadInput;
+    }
+
+    uint64_t ukm_limbs[8] = {};
+    std::copy(ukm, ukm + ukm_size, reinterpret_cast<byte*>(ukm_limbs));
+    pf::integer_type u = this->subgroup.acquire(pf::import_bytes(ukm_limbs));
+    if (u == 0) {
+        u = 1;
+    }
+
+    ec::point table[1 << (vko_naf_window - 2)];
+    this->curve.naf_precompute<vko_naf_window>(Q, table);
+
+    ec::point K = this->curve.mul_scalar<vko_naf_window>(table, this->subgroup.mul(u, d)).to_affine(this->curve);
+    if (K == ec::point::inf) {
+        return kStatusInternalError;
+    }
+
+    pf::export_bytes(K.x, shared_x);
+    pf::export_bytes(K.y, shared_y);
+    return kStatusOk;
+}
+
+namespace {
+
+/**
+ * @brief Part of an operation handed over to spin_worker.
+ */
+template <typename F>
+struct helper_task {
+    F body;
+    std::exception_ptr error;
+
+    static void run(void* arg) {
+        helper_task* self = static_cast<helper_task*>(arg);
+        try {
+            self->body();
+        } catch (...) {
+            self->error = std::current_exception();
+        }
+    }
+
+    /**
+     * @brief Run body on helper, or in the calling thread if helper is busy.
+     * @return true if body was posted to helper and helper.wait() must be called.
+     */
+    bool post(spin_worker& helper) {
+        if (helper.post(&helper_task::run, this)) {
+            return true;
+        }
+
+        body();
+        return false;
+    }
+
+    void wait(spin_worker& helper) {
+        helper.wait();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+template <typename F>
+helper_task<F> make_helper_task(F body) {
+    return helper_task<F>{body, nullptr};
+}
+
+}
+
+Gost12S512Status signature::sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature, spin_worker& helper) const {
+    if (!this->basePointTableHigh || this->basePointRegularTable || this->compact) {
+        return this->sign(private_key, rand, hash, signature);
+    }
+
+    pf::integer_type k = pf::import_bytes(rand);
+    if (k == 0 || k >= this->subgroup.modulus) {
+        return kStatusBadInput;
+    }
+
+    const unsigned h = ec::comb_columns<comb_window>() / 2;
+
+    ec::jacobian_point high;
+    auto task = make_helper_task([this, &k, &high, h]() {
+        high = this->curve.mul_scalar_jacobian<comb_window>(this->basePointTableHigh->points, k, h);
+    });
+    bool posted = task.post(helper);
+
+    ec::jacobian_point low = this->curve.mul_scalar_jacobian<comb_window>(this->base_comb().points, k, 0, h);
+
+    if (posted) {
+        task.wait(helper);
+    }
+
+    ec::point C = this->curve.add(low, high).to_affine(this->curve);
+
+    return this->sign_result(pf::import_bytes(private_key), this->hash_to_e(hash), k, C, signature);
+}
+
+Gost12S512Status signature::verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature, spin_worker& helper) const {
+    pf::integer_type r = pf::import_bytes(signature);
+    pf::integer_type s = pf::import_bytes(signature + signature_size / 2);
+    pf::integer_type v = this->subgroup.mul_inverse(this->hash_to_e(hash));
 
     pf::integer_type z_1 = this->subgroup.mul(s, v);
     pf::integer_type z_2 = this->subgroup.mul(r, v);
     z_2 = this->subgroup.inverse(z_2);
 
+    // Comb multiplication is several times cheaper than the Q half, so it easily fits into the
+    // time the calling thread spends on table precomputation and wNAF multiplication.
+    ec::jacobian_point P_part;
+    auto task = make_helper_task([this, &z_1, &P_part]() {
+        P_part = this->mul_base_public(z_1);
+    });
+    bool posted = task.post(helper);
+
     ec::point Q(pf::import_bytes(public_key_x), pf::import_bytes(public_key_y));
 
     ec::jacobian_point tableQ[1 << (dynamic_naf_window - 2)];
     this->curve.naf_precompute<dynamic_naf_window>(Q, tableQ);
 
-    ec::point C = this->curve.add_mul<dynamic_naf_window, static_naf_window>(tableQ, z_2, this->basePointNafTable, z_1).to_affine(this->curve);
+    ec::jacobian_point Q_part = this->curve.mul_scalar<dynamic_naf_window>(tableQ, z_2);
 
-//    ec::point C = this->curve.add(
-//                this->curve.mul_scalar<dynamic_naf_window>(tableQ, z_2),
-//                this->curve.mul_scalar<comb_window>(this->basePointTable, z_1)
-//                ).to_affine(this->curve);
+    if (posted) {
+        task.wait(helper);
+    }
 
-    pf::integer_type R = this->subgroup.acquire(C.x);
+    ec::point C = this->curve.add(Q_part, P_part).to_affine(this->curve);
 
-    if (R == r) {
-        return kStatusOk;
-    } else {
-        return kStatusWrongSignature;
+    return (this->subgroup.acquire(C.x) == r) ? kStatusOk : kStatusWrongSignature;
+}
+
+template <typename T>
+const T* signature::operation_table(const lazy_table<T>& table, const T& (signature::*get)() const, unsigned& budget) const {
+    if (table.ready()) {
+        return &(this->*get)();
+    }
+    if (budget == 0) {
+        return nullptr;
+    }
+
+    const unsigned entries = sizeof(T::points) / sizeof(T::points[0]);
+    const T& built = (this->*get)();
+    budget -= std::min(budget, entries);
+
+    return (budget > 0) ? &built : nullptr;
+}
+
+template <unsigned window, typename table_point, typename table_type>
+class signature::sign_operation : public signature::operation {
+    using multiplication_type = ec::comb_multiplication<window, table_point>;
+    using table_getter = const table_type& (signature::*)() const;
+
+    const signature& engine;
+    const lazy_table<table_type>& table;
+    const table_getter get_table;
+    const pf::integer_type d;
+    const pf::integer_type e;
+    const pf::integer_type k;
+    byte* const result;
+
+    std::unique_ptr<multiplication_type> multiplication;
+
+public:
+    sign_operation(const signature& engine, const lazy_table<table_type>& table, table_getter get_table,
+                   const byte* private_key, const byte* rand, const byte* hash, byte* signature)
+        :engine(engine), table(table), get_table(get_table),
+          d(pf::import_bytes(private_key)), e(engine.hash_to_e(hash)), k(pf::import_bytes(rand)), result(signature)
+    {
+        if (k == 0 || k >= engine.subgroup.modulus) {
+            this->finish(kStatusBadInput);
+        }
+    }
+
+    bool step(unsigned& budget) override {
+        if (this->done()) {
+            return true;
+        }
+
+        if (!multiplication) {
+            const table_type* base = engine.operation_table(table, get_table, budget);
+            if (base == nullptr) {
+                return false;
+            }
+            multiplication.reset(new multiplication_type(engine.curve, base->points, k));
+        }
+
+        if (!multiplication->step(budget) || budget == 0) {
+            return false;
+        }
+
+        budget--;
+        ec::point C = multiplication->result().to_affine(engine.curve);
+        this->finish(engine.sign_result(d, e, k, C, result));
+
+        return true;
+    }
+};
+
+template <unsigned window, typename table_point, typename table_type>
+class signature::verify_operation : public signature::operation {
+    using multiplication_type = ec::add_multiplication<dynamic_naf_window, window, ec::jacobian_point, table_point>;
+    using table_getter = const table_type& (signature::*)() const;
+
+    const signature& engine;
+    const lazy_table<table_type>& table;
+    const table_getter get_table;
+    pf::integer_type r;
+    pf::integer_type z_1;
+    pf::integer_type z_2;
+
+    ec::jacobian_point tableQ[1 << (dynamic_naf_window - 2)];
+    ec::jacobian_point doubledQ;
+    unsigned precomputed;
+
+    std::unique_ptr<multiplication_type> multiplication;
+
+    /**
+     * Same as elliptic_curve::naf_precompute(), but one point operation at a time.
+     */
+    bool precompute(unsigned& budget) {
+        const unsigned table_size = sizeof(tableQ) / sizeof(tableQ[0]);
+
+        for (; precomputed < table_size && budget > 0; budget--, precomputed++) {
+            if (precomputed == 0) {
+                doubledQ = engine.curve.twice(tableQ[0]);
+            } else {
+                tableQ[precomputed] = engine.curve.add(doubledQ, tableQ[precomputed - 1]);
+            }
+        }
+
+        return precomputed == table_size;
+    }
+
+public:
+    verify_operation(const signature& engine, const lazy_table<table_type>& table, table_getter get_table,
+                     const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature)
+        :engine(engine), table(table), get_table(get_table), r(pf::import_bytes(signature)), precomputed(0)
+    {
+        pf::integer_type s = pf::import_bytes(signature + signature_size / 2);
+        pf::integer_type v = engine.subgroup.mul_inverse(engine.hash_to_e(hash));
+
+        z_1 = engine.subgroup.mul(s, v);
+        z_2 = engine.subgroup.inverse(engine.subgroup.mul(r, v));
+
+        tableQ[0] = ec::jacobian_point(ec::point(pf::import_bytes(public_key_x), pf::import_bytes(public_key_y)));
+    }
+
+    bool step(unsigned& budget) override {
+        if (this->done() || !this->precompute(budget)) {
+            return this->done();
+        }
+
+        if (!multiplication) {
+            const table_type* base = engine.operation_table(table, get_table, budget);
+            if (base == nullptr) {
+                return false;
+            }
+            multiplication.reset(new multiplication_type(engine.curve, tableQ, z_2, base->points, z_1));
+        }
+
+        if (!multiplication->step(budget) || budget == 0) {
+            return false;
+        }
+
+        budget--;
+        ec::point C = multiplication->result().to_affine(engine.curve);
+        this->finish((engine.subgroup.acquire(C.x) == r) ? kStatusOk : kStatusWrongSignature);
+
+        return true;
+    }
+};
+
+class signature::finished_operation : public signature::operation {
+public:
+    explicit finished_operation(Gost12S512Status status) {
+        this->finish(status);
+    }
+
+    bool step(unsigned&) override {
+        return true;
+    }
+};
+
+std::unique_ptr<signature::operation> signature::start_sign(const byte* private_key, const byte* rand, const byte* hash, byte* signature) const {
+    // Steps of the ordinary comb would leak the nonce, which regular signing exists to prevent.
+    if (this->basePointRegularTable) {
+        return std::unique_ptr<operation>(new finished_operation(kStatusBadInput));
+    }
+    if (this->compact) {
+        return std::unique_ptr<operation>(new sign_operation<compact_comb_window, ec::packed_point, compact_comb_table>(
+                *this, this->basePointCompactTable, &signature::base_compact_comb, private_key, rand, hash, signature));
+    }
+    return std::unique_ptr<operation>(new sign_operation<comb_window, ec::jacobian_point, comb_table>(
+            *this, this->basePointTable, &signature::base_comb, private_key, rand, hash, signature));
+}
+
+std::unique_ptr<signature::operation> signature::start_verify(const byte* public_key_x, const byte* public_key_y, const byte* hash, const byte* signature) const {
+    if (this->compact) {
+        return std::unique_ptr<operation>(new verify_operation<compact_naf_window, ec::packed_point, compact_naf_table>(
+                *this, this->basePointCompactNafTable, &signature::base_compact_naf, public_key_x, public_key_y, hash, signature));
     }
+    return std::unique_ptr<operation>(new verify_operation<static_naf_window, ec::jacobian_point, naf_table>(
+            *this, this->basePointNafTable, &signature::base_naf, public_key_x, public_key_y, hash, signature));
 }
 
 }
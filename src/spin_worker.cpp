@@ -0,0 +1,85 @@
+#include <spin_worker.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace gost_ecc {
+
+namespace {
+
+/**
+ * Number of polls with pause hint before falling back to yielding the CPU.
+ */
+const unsigned spin_limit = 1 << 16;
+
+inline void relax(unsigned& spins) {
+    if (spins < spin_limit) {
+        spins++;
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+}
+
+spin_worker::spin_worker()
+    :state(sIdle), current_task(nullptr), current_arg(nullptr), thread(&spin_worker::run, this)
+{
+}
+
+spin_worker::~spin_worker() {
+    int expected = sIdle;
+    unsigned spins = 0;
+    while (!this->state.compare_exchange_weak(expected, sStopping, std::memory_order_acq_rel)) {
+        expected = sIdle;
+        relax(spins);
+    }
+
+    this->thread.join();
+}
+
+bool spin_worker::post(task t, void* arg) {
+    int expected = sIdle;
+    if (!this->state.compare_exchange_strong(expected, sClaimed, std::memory_order_acquire)) {
+        return false;
+    }
+
+    this->current_task = t;
+    this->current_arg = arg;
+    this->state.store(sReady, std::memory_order_release);
+
+    return true;
+}
+
+void spin_worker::wait() {
+    unsigned spins = 0;
+    while (this->state.load(std::memory_order_acquire) != sDone) {
+        relax(spins);
+    }
+
+    this->state.store(sIdle, std::memory_order_release);
+}
+
+void spin_worker::run() {
+    unsigned spins = 0;
+
+    for (;;) {
+        int current = this->state.load(std::memory_order_acquire);
+
+        if (current == sReady) {
+            this->current_task(this->current_arg);
+            this->state.store(sDone, std::memory_order_release);
+            spins = 0;
+        } else if (current == sStopping) {
+            return;
+        } else {
+            relax(spins);
+        }
+    }
+}
+
+}
@@ -0,0 +1,573 @@
+#include <streebog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define STREEBOG_AVX2
+#endif
+
+namespace gost_ecc {
+
+namespace {
+
+/**
+ * Substitution Pi of the standard.
+ */
+const unsigned char pi[256] = {
+    0xfc, 0xee, 0xdd, 0x11, 0xcf, 0x6e, 0x31, 0x16, 0xfb, 0xc4, 0xfa, 0xda, 0x23, 0xc5, 0x04, 0x4d,
+    0xe9, 0x77, 0xf0, 0xdb, 0x93, 0x2e, 0x99, 0xba, 0x17, 0x36, 0xf1, 0xbb, 0x14, 0xcd, 0x5f, 0xc1,
+    0xf9, 0x18, 0x65, 0x5a, 0xe2, 0x5c, 0xef, 0x21, 0x81, 0x1c, 0x3c, 0x42, 0x8b, 0x01, 0x8e, 0x4f,
+    0x05, 0x84, 0x02, 0xae, 0xe3, 0x6a, 0x8f, 0xa0, 0x06, 0x0b, 0xed, 0x98, 0x7f, 0xd4, 0xd3, 0x1f,
+    0xeb, 0x34, 0x2c, 0x51, 0xea, 0xc8, 0x48, 0xab, 0xf2, 0x2a, 0x68, 0xa2, 0xfd, 0x3a, 0xce, 0xcc,
+    0xb5, 0x70, 0x0e, 0x56, 0x08, 0x0c, 0x76, 0x12, 0xbf, 0x72, 0x13, 0x47, 0x9c, 0xb7, 0x5d, 0x87,
+    0x15, 0xa1, 0x96, 0x29, 0x10, 0x7b, 0x9a, 0xc7, 0xf3, 0x91, 0x78, 0x6f, 0x9d, 0x9e, 0xb2, 0xb1,
+    0x32, 0x75, 0x19, 0x3d, 0xff, 0x35, 0x8a, 0x7e, 0x6d, 0x54, 0xc6, 0x80, 0xc3, 0xbd, 0x0d, 0x57,
+    0xdf, 0xf5, 0x24, 0xa9, 0x3e, 0xa8, 0x43, 0xc9, 0xd7, 0x79, 0xd6, 0xf6, 0x7c, 0x22, 0xb9, 0x03,
+    0xe0, 0x0f, 0xec, 0xde, 0x7a, 0x94, 0xb0, 0xbc, 0xdc, 0xe8, 0x28, 0x50, 0x4e, 0x33, 0x0a, 0x4a,
+    0xa7, 0x97, 0x60, 0x73, 0x1e, 0x00, 0x62, 0x44, 0x1a, 0xb8, 0x38, 0x82, 0x64, 0x9f, 0x26, 0x41,
+    0xad, 0x45, 0x46, 0x92, 0x27, 0x5e, 0x55, 0x2f, 0x8c, 0xa3, 0xa5, 0x7d, 0x69, 0xd5, 0x95, 0x3b,
+    0x07, 0x58, 0xb3, 0x40, 0x86, 0xac, 0x1d, 0xf7, 0x30, 0x37, 0x6b, 0xe4, 0x88, 0xd9, 0xe7, 0x89,
+    0xe1, 0x1b, 0x83, 0x49, 0x4c, 0x3f, 0xf8, 0xfe, 0x8d, 0x53, 0xaa, 0x90, 0xca, 0xd8, 0x85, 0x61,
+    0x20, 0x71, 0x67, 0xa4, 0x2d, 0x2b, 0x09, 0x5b, 0xcb, 0x9b, 0x25, 0xd0, 0xbe, 0xe5, 0x6c, 0x52,
+    0x59, 0xa6, 0x74, 0xd2, 0xe6, 0xf4, 0xb4, 0xc0, 0xd1, 0x66, 0xaf, 0xc2, 0x39, 0x4b, 0x63, 0xb6
+};
+
+/**
+ * Rows of the matrix A of the linear transformation l, first row corresponds to the most
+ * significant bit of a 64-bit word.
+ */
+const uint64_t A[64] = {
+    0x8e20faa72ba0b470, 0x47107ddd9b505a38, 0xad08b0e0c3282d1c, 0xd8045870ef14980e,
+    0x6c022c38f90a4c07, 0x3601161cf205268d, 0x1b8e0b0e798c13c8, 0x83478b07b2468764,
+    0xa011d380818e8f40, 0x5086e740ce47c920, 0x2843fd2067adea10, 0x14aff010bdd87508,
+    0x0ad97808d06cb404, 0x05e23c0468365a02, 0x8c711e02341b2d01, 0x46b60f011a83988e,
+    0x90dab52a387ae76f, 0x486dd4151c3dfdb9, 0x24b86a840e90f0d2, 0x125c354207487869,
+    0x092e94218d243cba, 0x8a174a9ec8121e5d, 0x4585254f64090fa0, 0xaccc9ca9328a8950,
+    0x9d4df05d5f661451, 0xc0a878a0a1330aa6, 0x60543c50de970553, 0x302a1e286fc58ca7,
+    0x18150f14b9ec46dd, 0x0c84890ad27623e0, 0x0642ca05693b9f70, 0x0321658cba93c138,
+    0x86275df09ce8aaa8, 0x439da0784e745554, 0xafc0503c273aa42a, 0xd960281e9d1d5215,
+    0xe230140fc0802984, 0x71180a8960409a42, 0xb60c05ca30204d21, 0x5b068c651810a89e,
+    0x456c34887a3805b9, 0xac361a443d1c8cd2, 0x561b0d22900e4669, 0x2b838811480723ba,
+    0x9bcf4486248d9f5d, 0xc3e9224312c8c1a0, 0xeffa11af0964ee50, 0xf97d86d98a327728,
+    0xe4fa2054a80b329c, 0x727d102a548b194e, 0x39b008152acb8227, 0x9258048415eb419d,
+    0x492c024284fbaec0, 0xaa16012142f35760, 0x550b8e9e21f7a530, 0xa48b474f9ef5dc18,
+    0x70a6a56e2440598e, 0x3853dc371220a247, 0x1ca76e95091051ad, 0x0edd37c48a08a6d8,
+    0x07e095624504536c, 0x8d70c431ac02a736, 0xc83862965601dd1b, 0x641c314b2b8ee083
+};
+
+/**
+ * Iteration constants C_1..C_12 of the key schedule.
+ */
+const streebog::block C[12] = {
+    {{ 0xdd806559f2a64507, 0x05767436cc744d23, 0xa2422a08a460d315, 0x4b7ce09192676901,
+       0x714eb88d7585c4fc, 0x2f6a76432e45d016, 0xebcb2f81c0657c1f, 0xb1085bda1ecadae9 }},
+    {{ 0xe679047021b19bb7, 0x55dda21bd7cbcd56, 0x5cb561c2db0aa7ca, 0x9ab5176b12d69958,
+       0x61d55e0f16b50131, 0xf3feea720a232b98, 0x4fe39d460f70b5d7, 0x6fa3b58aa99d2f1a }},
+    {{ 0x991e96f50aba0ab2, 0xc2b6f443867adb31, 0xc1c93a376062db09, 0xd3e20fe490359eb1,
+       0xf2ea7514b1297b7b, 0x06f15e5f529c1f8b, 0x0a39fc286a3d8435, 0xf574dcac2bce2fc7 }},
+    {{ 0x220cbebc84e3d12e, 0x3453eaa193e837f1, 0xd8b71333935203be, 0xa9d72c82ed03d675,
+       0x9d721cad685e353f, 0x488e857e335c3c7d, 0xf948e1a05d71e4dd, 0xef1fdfb3e81566d2 }},
+    {{ 0x601758fd7c6cfe57, 0x7a56a27ea9ea63f5, 0xdfff00b723271a16, 0xbfcd1747253af5a3,
+       0x359e35d7800fffbd, 0x7f151c1f1686104a, 0x9a3f410c6ca92363, 0x4bea6bacad474799 }},
+    {{ 0xfa68407a46647d6e, 0xbf71c57236904f35, 0x0af21f66c2bec6b6, 0xcffaa6b71c9ab7b4,
+       0x187f9ab49af08ec6, 0x2d66c4f95142a46c, 0x6fa4c33b7a3039c0, 0xae4faeae1d3ad3d9 }},
+    {{ 0x8886564d3a14d493, 0x3517454ca23c4af3, 0x06476983284a0504, 0x0992abc52d822c37,
+       0xd3473e33197a93c9, 0x399ec6c7e6bf87c9, 0x51ac86febf240954, 0xf4c70e16eeaac5ec }},
+    {{ 0xa47f0dd4bf02e71e, 0x36acc2355951a8d9, 0x69d18d2bd1a5c42f, 0xf4892bcb929b0690,
+       0x89b4443b4ddbc49a, 0x4eb7f8719c36de1e, 0x03e7aa020c6e4141, 0x9b1f5b424d93c9a7 }},
+    {{ 0x7261445183235adb, 0x0e38dc92cb1f2a60, 0x7b2b8a9aa6079c54, 0x800a440bdbb2ceb1,
+       0x3cd955b7e00d0984, 0x3a7d3a1b25894224, 0x944c9ad8ec165fde, 0x378f5a541631229b }},
+    {{ 0x74b4c7fb98459ced, 0x3698fad1153bb6c3, 0x7a1e6c303b7652f4, 0x9fe76702af69334b,
+       0x1fffe18a1b336103, 0x8941e71cff8a78db, 0x382ae548b2e4f3f3, 0xabbedea680056f52 }},
+    {{ 0x6bcaa4cd81f32d1b, 0xdea2594ac06fd85d, 0xefbacd1d7d476e98, 0x8a1d71efea48b9ca,
+       0x2001802114846679, 0xd8fa6bbbebab0761, 0x3002c6cd635afe94, 0x7bcd9ed0efc889fb }},
+    {{ 0x48bc924af11bd720, 0xfaf417d5d9b21b99, 0xe71da4aa88e12852, 0x5d80ef9d1891cc86,
+       0xf82012d430219f9b, 0xcda43c32bcdf1d77, 0xd21380b00449b17a, 0x378ee767f11631ba }}
+};
+
+/**
+ * L(P(S(x))) as eight lookups per output word: lps[j][b] is the contribution of byte value b
+ * found in input word j. 16 KB, built once on first use.
+ */
+struct lps_tables {
+    uint64_t lps[8][256];
+
+    lps_tables() {
+        for (unsigned j = 0; j < 8; j++) {
+            for (unsigned b = 0; b < 256; b++) {
+                uint64_t value = 0;
+
+                for (unsigned bit = 0; bit < 8; bit++) {
+                    if ((pi[b] >> bit) & 1) {
+                        value ^= A[63 - 8 * j - bit];
+                    }
+                }
+                this->lps[j][b] = value;
+            }
+        }
+    }
+};
+
+const lps_tables& tables() {
+    static const lps_tables instance;
+    return instance;
+}
+
+inline void lps(const lps_tables& t, const uint64_t (&in)[8], uint64_t (&out)[8]) {
+    uint64_t a0 = in[0], a1 = in[1], a2 = in[2], a3 = in[3], a4 = in[4], a5 = in[5], a6 = in[6], a7 = in[7];
+
+    // Output word i takes byte i of every input word, so shifting inputs by a byte per output
+    // keeps all lookups at constant offsets.
+    for (unsigned i = 0; i < 8; i++) {
+        out[i] = t.lps[0][a0 & 0xff] ^ t.lps[1][a1 & 0xff] ^ t.lps[2][a2 & 0xff] ^ t.lps[3][a3 & 0xff] ^
+                 t.lps[4][a4 & 0xff] ^ t.lps[5][a5 & 0xff] ^ t.lps[6][a6 & 0xff] ^ t.lps[7][a7 & 0xff];
+        a0 >>= 8; a1 >>= 8; a2 >>= 8; a3 >>= 8; a4 >>= 8; a5 >>= 8; a6 >>= 8; a7 >>= 8;
+    }
+}
+
+inline void xor_words(const uint64_t (&a)[8], const uint64_t (&b)[8], uint64_t (&out)[8]) {
+    for (unsigned i = 0; i < 8; i++) {
+        out[i] = a[i] ^ b[i];
+    }
+}
+
+void compress_generic(streebog::block* const* h, const streebog::block* const* m, const uint64_t* N, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        streebog::compress(*h[i], *m[i], N[i]);
+    }
+}
+
+#ifdef STREEBOG_AVX2
+/**
+ * Word w of all lanes in one register, lane i in element i. Missing lanes are zero.
+ */
+__attribute__((target("avx2")))
+inline void load_lanes(const streebog::block* const* in, std::size_t count, __m256i (&out)[8]) {
+    for (unsigned w = 0; w < 8; w++) {
+        long long words[streebog::lanes] = {};
+        for (std::size_t i = 0; i < count; i++) {
+            words[i] = static_cast<long long>(in[i]->words[w]);
+        }
+        out[w] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+    }
+}
+
+__attribute__((target("avx2")))
+inline void lps_avx2(const lps_tables& t, const __m256i (&in)[8], __m256i (&out)[8]) {
+    const __m256i byte_mask = _mm256_set1_epi64x(0xff);
+    __m256i a[8];
+
+    for (unsigned j = 0; j < 8; j++) {
+        a[j] = in[j];
+    }
+
+    for (unsigned i = 0; i < 8; i++) {
+        __m256i acc = _mm256_setzero_si256();
+
+        for (unsigned j = 0; j < 8; j++) {
+            const __m256i index = _mm256_and_si256(a[j], byte_mask);
+            acc = _mm256_xor_si256(acc, _mm256_i64gather_epi64(reinterpret_cast<const long long*>(t.lps[j]), index, 8));
+            a[j] = _mm256_srli_epi64(a[j], 8);
+        }
+        out[i] = acc;
+    }
+}
+
+__attribute__((target("avx2")))
+void compress_avx2(streebog::block* const* h, const streebog::block* const* m, const uint64_t* N, std::size_t count) {
+    const lps_tables& t = tables();
+
+    __m256i H[8], M[8], K[8], state[8], tmp[8];
+    load_lanes(h, count, H);
+    load_lanes(m, count, M);
+
+    long long counters[streebog::lanes] = {};
+    for (std::size_t i = 0; i < count; i++) {
+        counters[i] = static_cast<long long>(N[i]);
+    }
+
+    tmp[0] = _mm256_xor_si256(H[0], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counters)));
+    for (unsigned w = 1; w < 8; w++) {
+        tmp[w] = H[w];
+    }
+    lps_avx2(t, tmp, K);
+
+    for (unsigned w = 0; w < 8; w++) {
+        tmp[w] = _mm256_xor_si256(K[w], M[w]);
+    }
+    for (unsigned r = 0; r < 12; r++) {
+        lps_avx2(t, tmp, state);
+        for (unsigned w = 0; w < 8; w++) {
+            tmp[w] = _mm256_xor_si256(K[w], _mm256_set1_epi64x(static_cast<long long>(C[r].words[w])));
+        }
+        lps_avx2(t, tmp, K);
+        for (unsigned w = 0; w < 8; w++) {
+            tmp[w] = _mm256_xor_si256(state[w], K[w]);
+        }
+    }
+
+    for (unsigned w = 0; w < 8; w++) {
+        long long words[streebog::lanes];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(words), _mm256_xor_si256(H[w], _mm256_xor_si256(tmp[w], M[w])));
+
+        for (std::size_t i = 0; i < count; i++) {
+            h[i]->words[w] = static_cast<uint64_t>(words[i]);
+        }
+    }
+}
+#endif
+
+typedef void (*compress_function)(streebog::block* const*, const streebog::block* const*, const uint64_t*, std::size_t);
+
+/**
+ * Time of a few full-width compressions.
+ */
+std::chrono::steady_clock::duration time_compress(compress_function compress) {
+    streebog::block blocks[streebog::lanes] = {};
+    streebog::block* h[streebog::lanes];
+    const streebog::block* m[streebog::lanes];
+    const uint64_t N[streebog::lanes] = {};
+
+    for (std::size_t i = 0; i < streebog::lanes; i++) {
+        h[i] = &blocks[i];
+        m[i] = &blocks[(i + 1) % streebog::lanes];
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < 32; i++) {
+        compress(h, m, N, streebog::lanes);
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+/**
+ * Kernel implementing choice, null if it isn't available.
+ */
+compress_function kernel_function(streebog::kernel choice) {
+    switch (choice) {
+    case streebog::kernel::generic:
+        return compress_generic;
+    case streebog::kernel::avx2:
+#ifdef STREEBOG_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            return compress_avx2;
+        }
+#endif
+        return nullptr;
+    case streebog::kernel::automatic:
+        break;
+    }
+    return nullptr;
+}
+
+compress_function pick_compress() {
+    const char* forced = std::getenv("GOST_ECC_STREEBOG_KERNEL");
+    if (forced != nullptr) {
+        compress_function function = nullptr;
+        if (std::strcmp(forced, "generic") == 0) {
+            function = kernel_function(streebog::kernel::generic);
+        } else if (std::strcmp(forced, "avx2") == 0) {
+            function = kernel_function(streebog::kernel::avx2);
+        }
+        if (function != nullptr) {
+            return function;
+        }
+    }
+
+#ifdef STREEBOG_AVX2
+    // Gathers are slower than scalar loads on some CPUs and microcode revisions (e.g. with
+    // the Gather Data Sampling mitigation), so the AVX2 path has to win a quick race first.
+    if (__builtin_cpu_supports("avx2")) {
+        time_compress(compress_avx2);
+        if (time_compress(compress_avx2) < time_compress(compress_generic)) {
+            return compress_avx2;
+        }
+    }
+#endif
+    return compress_generic;
+}
+
+/**
+ * Kernel set by streebog::use_kernel(), null for the automatic choice.
+ */
+std::atomic<compress_function> forced_compress(nullptr);
+
+/**
+ * Progress of one message in hash_many().
+ */
+struct lane {
+    enum stage_type {
+        blocks,
+        padding,
+        length,
+        checksum,
+        done
+    };
+
+    std::size_t message;
+    const streebog::byte* data;
+    std::size_t left;
+    stage_type stage;
+
+    streebog::block h;
+    streebog::block sigma;
+    uint64_t N;
+
+    /**
+     * Input of the next compression.
+     */
+    streebog::block m;
+    uint64_t m_N;
+
+    void start(std::size_t message, const streebog::byte* data, std::size_t length, std::size_t digest_size) {
+        const uint64_t iv = (digest_size == 32) ? 0x0101010101010101ull : 0;
+
+        this->message = message;
+        this->data = data;
+        this->left = length;
+        this->stage = blocks;
+        for (unsigned i = 0; i < 8; i++) {
+            this->h.words[i] = iv;
+            this->sigma.words[i] = 0;
+        }
+        this->N = 0;
+    }
+
+    /**
+     * Set m and m_N for the next compression and account for it in the checksum and length.
+     */
+    void next() {
+        if (this->stage == blocks && this->left < streebog::block_size) {
+            this->stage = padding;
+        }
+
+        switch (this->stage) {
+        case blocks:
+            std::memcpy(this->m.words, this->data, streebog::block_size);
+            this->m_N = this->N;
+            this->data += streebog::block_size;
+            this->left -= streebog::block_size;
+            this->N += 8 * streebog::block_size;
+            streebog::add(this->sigma, this->m);
+            break;
+        case padding:
+            this->m = streebog::pad(this->data, this->left);
+            this->m_N = this->N;
+            this->N += 8 * this->left;
+            streebog::add(this->sigma, this->m);
+            this->stage = length;
+            break;
+        case length:
+            this->m = streebog::block{{ this->N, 0, 0, 0, 0, 0, 0, 0 }};
+            this->m_N = 0;
+            this->stage = checksum;
+            break;
+        case checksum:
+        case done:
+            this->m = this->sigma;
+            this->m_N = 0;
+            this->stage = done;
+            break;
+        }
+    }
+};
+
+}
+
+streebog::streebog(std::size_t digest_size)
+    :size(digest_size)
+{
+    if (digest_size != 32 && digest_size != 64) {
+        throw std::invalid_argument("Streebog digest size must be 32 or 64 bytes");
+    }
+    this->reset();
+}
+
+void streebog::reset() {
+    const uint64_t iv = (this->size == 32) ? 0x0101010101010101ull : 0;
+
+    for (unsigned i = 0; i < 8; i++) {
+        this->h.words[i] = iv;
+        this->sigma.words[i] = 0;
+    }
+    this->N = 0;
+    this->buffered = 0;
+}
+
+void streebog::update(const byte* data, std::size_t length) {
+    if (this->buffered > 0) {
+        const std::size_t chunk = std::min(length, block_size - this->buffered);
+        std::memcpy(this->buffer + this->buffered, data, chunk);
+        this->buffered += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (this->buffered < block_size) {
+            return;
+        }
+
+        block m;
+        std::memcpy(m.words, this->buffer, block_size);
+        compress(this->h, m, this->N);
+        add(this->sigma, m);
+        this->N += 8 * block_size;
+        this->buffered = 0;
+    }
+
+    for (; length >= block_size; data += block_size, length -= block_size) {
+        block m;
+        std::memcpy(m.words, data, block_size);
+        compress(this->h, m, this->N);
+        add(this->sigma, m);
+        this->N += 8 * block_size;
+    }
+
+    std::memcpy(this->buffer, data, length);
+    this->buffered = length;
+}
+
+void streebog::final(byte* digest) {
+    const block m = pad(this->buffer, this->buffered);
+    compress(this->h, m, this->N);
+    add(this->sigma, m);
+    this->N += 8 * this->buffered;
+
+    const block length = {{ this->N, 0, 0, 0, 0, 0, 0, 0 }};
+    compress(this->h, length, 0);
+    compress(this->h, this->sigma, 0);
+
+    // Streebog-256 is the most significant half of the final state.
+    std::memcpy(digest, reinterpret_cast<const byte*>(this->h.words) + (64 - this->size), this->size);
+    this->reset();
+}
+
+void streebog::hash(std::size_t digest_size, const byte* data, std::size_t length, byte* digest) {
+    streebog hash(digest_size);
+    hash.update(data, length);
+    hash.final(digest);
+}
+
+void streebog::hash_many(std::size_t digest_size, const byte* const* data, const std::size_t* lengths,
+                         byte* const* digests, std::size_t count) {
+    if (digest_size != 32 && digest_size != 64) {
+        throw std::invalid_argument("Streebog digest size must be 32 or 64 bytes");
+    }
+
+    lane state[lanes];
+    lane* active[lanes];
+    std::size_t active_count = 0;
+    std::size_t next_message = 0;
+
+    for (; active_count < lanes && next_message < count; active_count++, next_message++) {
+        state[active_count].start(next_message, data[next_message], lengths[next_message], digest_size);
+        active[active_count] = &state[active_count];
+    }
+
+    block* h[lanes];
+    const block* m[lanes];
+    uint64_t N[lanes];
+
+    while (active_count > 0) {
+        for (std::size_t i = 0; i < active_count; i++) {
+            active[i]->next();
+            h[i] = &active[i]->h;
+            m[i] = &active[i]->m;
+            N[i] = active[i]->m_N;
+        }
+
+        compress(h, m, N, active_count);
+
+        for (std::size_t i = 0; i < active_count;) {
+            lane& current = *active[i];
+            if (current.stage != lane::done) {
+                i++;
+                continue;
+            }
+
+            std::memcpy(digests[current.message], reinterpret_cast<const byte*>(current.h.words) + (64 - digest_size),
+                        digest_size);
+
+            if (next_message < count) {
+                current.start(next_message, data[next_message], lengths[next_message], digest_size);
+                next_message++;
+                i++;
+            } else {
+                active[i] = active[--active_count];
+            }
+        }
+    }
+}
+
+void streebog::compress(block* const* h, const block* const* m, const uint64_t* N, std::size_t count) {
+    static const compress_function vectorized = pick_compress();
+
+    const compress_function forced = forced_compress.load(std::memory_order_relaxed);
+    if (count == 1) {
+        compress(*h[0], *m[0], N[0]);
+    } else {
+        (forced != nullptr ? forced : vectorized)(h, m, N, count);
+    }
+}
+
+bool streebog::use_kernel(kernel choice) {
+    const compress_function function = kernel_function(choice);
+    if (function == nullptr && choice != kernel::automatic) {
+        return false;
+    }
+
+    forced_compress.store(function, std::memory_order_relaxed);
+    return true;
+}
+
+void streebog::compress(block& h, const block& m, uint64_t N) {
+    const lps_tables& t = tables();
+
+    uint64_t K[8];
+    uint64_t state[8];
+    uint64_t tmp[8];
+
+    xor_words(h.words, {N, 0, 0, 0, 0, 0, 0, 0}, tmp);
+    lps(t, tmp, K);
+
+    // E(K, m): twelve rounds of X[K_i] LPS with the key schedule K_{i+1} = LPS(K_i ^ C_i).
+    xor_words(K, m.words, tmp);
+    for (unsigned i = 0; i < 12; i++) {
+        lps(t, tmp, state);
+        xor_words(K, C[i].words, tmp);
+        lps(t, tmp, K);
+        xor_words(state, K, tmp);
+    }
+
+    for (unsigned i = 0; i < 8; i++) {
+        h.words[i] ^= tmp[i] ^ m.words[i];
+    }
+}
+
+void streebog::add(block& sigma, const block& m) {
+    uint64_t carry = 0;
+
+    for (unsigned i = 0; i < 8; i++) {
+        const uint64_t sum = sigma.words[i] + m.words[i];
+        const uint64_t result = sum + carry;
+        carry = (sum < m.words[i]) | (result < sum);
+        sigma.words[i] = result;
+    }
+}
+
+streebog::block streebog::pad(const byte* data, std::size_t length) {
+    byte padded[block_size] = {};
+    std::memcpy(padded, data, length);
+    padded[length] = 1;
+
+    block m;
+    std::memcpy(m.words, padded, block_size);
+    return m;
+}
+
+}
@@ -0,0 +1,89 @@
+#include <table_scan.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define TABLE_SCAN_AVX2
+#endif
+
+namespace gost_ecc {
+
+namespace {
+
+/**
+ * @return All ones if a == b, zero otherwise, without branches.
+ */
+inline uint64_t equal_mask(uint64_t a, uint64_t b) {
+    uint64_t diff = a ^ b;
+    return ((diff | (0 - diff)) >> 63) - 1;
+}
+
+void scan_select_generic(const uint64_t* table, std::size_t entries, std::size_t entry_limbs, std::size_t index, uint64_t* out) {
+    for (std::size_t j = 0; j < entry_limbs; j++) {
+        out[j] = 0;
+    }
+
+    for (std::size_t i = 0; i < entries; i++) {
+        const uint64_t mask = equal_mask(i, index);
+        const uint64_t* entry = table + i * entry_limbs;
+
+        for (std::size_t j = 0; j < entry_limbs; j++) {
+            out[j] |= entry[j] & mask;
+        }
+    }
+}
+
+#ifdef TABLE_SCAN_AVX2
+__attribute__((target("avx2")))
+void scan_select_avx2(const uint64_t* table, std::size_t entries, std::size_t entry_limbs, std::size_t index, uint64_t* out) {
+    const std::size_t vectors = entry_limbs / 4;
+
+    for (std::size_t j = 0; j < vectors; j++) {
+        __m256i acc = _mm256_setzero_si256();
+        const __m256i target = _mm256_set1_epi64x(static_cast<long long>(index));
+        __m256i position = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi64x(1);
+
+        for (std::size_t i = 0; i < entries; i++) {
+            const __m256i mask = _mm256_cmpeq_epi64(position, target);
+            const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table + i * entry_limbs) + j);
+            acc = _mm256_or_si256(acc, _mm256_and_si256(value, mask));
+            position = _mm256_add_epi64(position, one);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out) + j, acc);
+    }
+}
+#endif
+
+typedef void (*scan_function)(const uint64_t*, std::size_t, std::size_t, std::size_t, uint64_t*);
+
+scan_function pick_scan() {
+#ifdef TABLE_SCAN_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return scan_select_avx2;
+    }
+#endif
+    return scan_select_generic;
+}
+
+}
+
+void scan_select(const uint64_t* table, std::size_t entries, std::size_t entry_limbs, std::size_t index, uint64_t* out) {
+    static const scan_function vectorized = pick_scan();
+
+    if (entry_limbs % 4 == 0) {
+        vectorized(table, entries, entry_limbs, index, out);
+    } else {
+        scan_select_generic(table, entries, entry_limbs, index, out);
+    }
+}
+
+void masked_select(bool condition, const uint64_t* a, const uint64_t* b, uint64_t* out, std::size_t limbs) {
+    const uint64_t mask = 0 - static_cast<uint64_t>(condition);
+
+    for (std::size_t j = 0; j < limbs; j++) {
+        out[j] = (a[j] & mask) | (b[j] & ~mask);
+    }
+}
+
+}
@@ -0,0 +1,215 @@
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace gost_ecc {
+
+unsigned thread_pool::hardware_threads() {
+    unsigned threads = std::thread::hardware_concurrency();
+    return (threads > 0) ? threads : 1;
+}
+
+void thread_pool::run_parallel(const std::vector<std::function<void()> >& tasks) {
+    const unsigned threads = std::min<std::size_t>(hardware_threads(), tasks.size());
+    std::exception_ptr error;
+
+    if (threads <= 1) {
+        // Same outcome as with helper threads: every task runs, the first exception is kept.
+        for (const std::function<void()>& task : tasks) {
+            try {
+                task();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::mutex error_mutex;
+
+    auto run = [&tasks, &next, &error_mutex, &error]() {
+        for (std::size_t i = next++; i < tasks.size(); i = next++) {
+            try {
+                tasks[i]();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    try {
+        for (unsigned i = 1; i < threads; i++) {
+            helpers.push_back(std::thread(run));
+        }
+    } catch (...) {
+        // Couldn't start more threads, the remaining tasks will run in the calling thread.
+    }
+
+    run();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+thread_pool::thread_pool(unsigned threads, std::function<void(unsigned)> on_start)
+    :workers((threads > 0) ? threads : hardware_threads()), on_start(std::move(on_start)),
+      pending(0), next_worker(0), stopping(false)
+{
+    try {
+        for (unsigned i = 0; i < this->size(); i++) {
+            this->workers[i].thread = std::thread(&thread_pool::run, this, i);
+        }
+    } catch (...) {
+        this->stop();
+        throw;
+    }
+}
+
+thread_pool::~thread_pool() {
+    this->stop();
+}
+
+void thread_pool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+
+    for (unsigned i = 0; i < this->size(); i++) {
+        if (this->workers[i].thread.joinable()) {
+            this->workers[i].thread.join();
+        }
+    }
+}
+
+void thread_pool::submit(task t) {
+    worker& w = this->workers[this->next_worker++ % this->size()];
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.tasks.push_back(std::move(t));
+    }
+
+    {
+        // Taking the lock orders the increment with a worker checking the predicate before sleeping.
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->pending++;
+    }
+    this->wake.notify_one();
+}
+
+bool thread_pool::try_pop(unsigned self, task& t) {
+    {
+        worker& own = this->workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            t = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (unsigned i = 1; i < this->size(); i++) {
+        worker& victim = this->workers[(self + i) % this->size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            t = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void thread_pool::run(unsigned self) {
+    if (this->on_start) {
+        this->on_start(self);
+    }
+
+    task t;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(this->sleep_mutex);
+            this->wake.wait(lock, [this]() { return this->stopping || this->pending > 0; });
+            if (this->pending == 0) {
+                return; // Stopping and nothing left to do.
+            }
+        }
+
+        if (this->try_pop(self, t)) {
+            this->pending--;
+            t();
+            t = nullptr;
+        } else {
+            // Task counted in pending has been taken by someone else in the meantime.
+            std::this_thread::yield();
+        }
+    }
+}
+
+void thread_pool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    const std::size_t chunks = std::min<std::size_t>(count, this->size() * 4);
+    const std::size_t chunk_size = (count + chunks - 1) / chunks;
+
+    std::mutex done_mutex;
+    std::condition_variable done;
+    std::size_t remaining = 0;
+    std::exception_ptr error;
+
+    for (std::size_t begin = 0; begin < count; begin += chunk_size) {
+        remaining++;
+    }
+
+    for (std::size_t begin = 0; begin < count; begin += chunk_size) {
+        const std::size_t end = std::min(count, begin + chunk_size);
+
+        this->submit([&, begin, end]() {
+            std::exception_ptr chunk_error;
+            try {
+                for (std::size_t i = begin; i < end; i++) {
+                    body(i);
+                }
+            } catch (...) {
+                chunk_error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (chunk_error && !error) {
+                error = chunk_error;
+            }
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&remaining]() { return remaining == 0; });
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}
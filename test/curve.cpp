@@ -1,8 +1,11 @@
-#include <curve.h>
+#include "test_curve.h"
 
 using namespace std;
 
 namespace gost_ecc {
+
+namespace test_curve {
+
 uint64_t p[8] =
 {0x0000000000000431,
  0x0000000000000000,
@@ -84,3 +87,5 @@ uint64_t y0[8] =
  0x0000000000000000};
 
 }
+
+}
@@ -1,16 +1,47 @@
-#include <curve.h>
+#include "test_curve.h"
 #include <signature.h>
 #include <prime_field.h>
 #include <elliptic_curve.h>
 #include <naf.h>
+#include <der.h>
+#include <streebog.h>
+#include <numa.h>
+#include <thread_pool.h>
+#include <op_counters.h>
+#include <sign_engine_ext.h>
+#include <context.h>
+#include <daemon_protocol.h>
+#include <signature_contest/core/src/corpus.h>
 
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define ASSERT_TRUE(expr) \
     if(!(expr)) {throw std::logic_error("Assertion failed in " + std::string(__FILE__) + " at line " + std::to_string(__LINE__));}
 
 using namespace std;
 using namespace gost_ecc;
+using namespace gost_ecc::test_curve;
 
 const uint64_t d[8] =
 {0x1D19CE9891EC3B28,
@@ -55,6 +86,75 @@ const uint64_t y_q[8] =
  0x26f1b489d6701dd1};
 
 
+// First entry of verify/test2.dat, parameter set A.
+const uint64_t a_private_key[8] =
+{0x107110A2380BF36C,
+ 0x4DC8433D714EE39F,
+ 0xFD58674F481FFF7C,
+ 0xBAC3BCCE8A637B01,
+ 0x294CD35449974C1B,
+ 0x4DE0F7843D2BC9FF,
+ 0x26C7EDBC11E1789F,
+ 0x5012A29B1094B110};
+
+const uint64_t a_public_key_x[8] =
+{0x6F0B820ED8A298D2,
+ 0xB32B9EC67289B0C6,
+ 0x747649854A16BADC,
+ 0xB7C874B1F71D84A7,
+ 0x38FF6DB3C75590F3,
+ 0x223B196051759750,
+ 0xD7143CB5E3003098,
+ 0xEA6855DCB8B2279F};
+
+const uint64_t a_public_key_y[8] =
+{0xB0FD519E100E57BD,
+ 0x66C3E9D369B23F89,
+ 0xCC8ABBCB2EA1F2B1,
+ 0x1E1EB3F43302CDC5,
+ 0x2303F54A786F27F8,
+ 0xC1BBF01395D0BE3D,
+ 0x6D82B7D0F8C067E1,
+ 0x6BC489937670A26E};
+
+const uint64_t a_rand[8] =
+{0xCC676CF87B353C4B,
+ 0xCFA26FDC975B5F51,
+ 0xC1470375B6B949C2,
+ 0xCA1B95C0E2B1D5D9,
+ 0xE4E8420B2B6848F3,
+ 0x4D1ED8A380305887,
+ 0x80CC71B797430744,
+ 0x6C1876A5EBF2B769};
+
+const uint64_t a_hash[8] =
+{0x7BC916A2CC0D0E3E,
+ 0xDFA77AFCEF7230DF,
+ 0x72FC7E8164CCAE38,
+ 0x7B1EFC162ABD4A35,
+ 0xD754C9768E2AF5E1,
+ 0x65FF59FE0A1092B7,
+ 0x18F5270EFD62C5F4,
+ 0x180A75A7514B4339};
+
+const uint64_t a_signature[16] =
+{0x284B9D4BBFE252F9,
+ 0x14BEB42ECA2955A6,
+ 0x56AB2514CE628A79,
+ 0x8AA44025A0B98342,
+ 0x27DEC33C67A167A0,
+ 0x80C228286C26398D,
+ 0x4F58A145629E4C3B,
+ 0x5913F053E6423AB3,
+ 0x3B3F3A1D06BB336F,
+ 0x0BFDF1C131E0F5E9,
+ 0x7BEB630797687C6B,
+ 0x79918FF9FFF4292C,
+ 0x915077379B3B6D90,
+ 0x078ACBFB1226EF16,
+ 0x270BBE8476FE28C4,
+ 0xF3836F26F21E3775};
+
 template <unsigned n>
 inline const byte* to_bytes(const uint64_t (&data)[n]) {
     return reinterpret_cast<const byte*>(&data);
@@ -65,6 +165,26 @@ inline byte* to_bytes(uint64_t (&data)[n]) {
     return reinterpret_cast<byte*>(&data);
 }
 
+inline bool write_file(const std::string& path, const void* data, std::size_t size) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(static_cast<const char*>(data), size);
+    return static_cast<bool>(file);
+}
+
+inline bool read_file(const std::string& path, void* data, std::size_t size) {
+    std::ifstream file(path, std::ios::binary);
+    file.read(static_cast<char*>(data), size);
+    return file.gcount() == static_cast<std::streamsize>(size);
+}
+
+/**
+ * @return Exit code of the command, -1 if it didn't exit normally.
+ */
+inline int run_quietly(const std::string& command) {
+    const int status = std::system((command + " >/dev/null 2>&1").c_str());
+    return (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+}
+
 using namespace mp;
 
 int main() {
@@ -93,6 +213,22 @@ int main() {
         const mp::uint256_t inv = field.mul_inverse(left);
         ASSERT_TRUE(1 == field.mul(left, inv));
 
+        mp::uint256_t batch[] = {left, 0, right};
+        field.mul_inverse(batch, 3);
+        ASSERT_TRUE(inv == batch[0]);
+        ASSERT_TRUE(0 == batch[1]);
+        ASSERT_TRUE(1 == field.mul(right, batch[2]));
+
+        ASSERT_TRUE(field.mul(left, left, left) == field.pow(left, 3));
+        ASSERT_TRUE(1 == field.pow(left, modulus - 1));
+        ASSERT_TRUE(inv == field.pow(left, modulus - 2));
+
+        byte be[32];
+        pf::export_bytes_be(left, be);
+        ASSERT_TRUE(be[31] == to_bytes(alpha)[0] && be[0] == to_bytes(alpha)[31]);
+        ASSERT_TRUE(left == pf::import_bytes_be(be));
+        ASSERT_TRUE((left & 0xffffffffff) == pf::import_bytes_be(be + 27, 5));
+
         const mp::uint256_t prodprod("0x44fe9963117e27cf2c4ea7ada33a47eec7aac295b7378a3d04b5a154bd5b45be");
         ASSERT_TRUE(prodprod == field.mul(left, right, right));
         ASSERT_TRUE(prodprod == field.mul(right, left, right));
@@ -135,6 +271,15 @@ int main() {
 
         ASSERT_TRUE(ec::point(14, 16) == curve.mul_scalar(ec::point(0, 6), 6));
 
+        {
+            ec::jacobian_point points[] = {curve.twice(ec::jacobian_point(left)), ec::jacobian_point::inf, curve.add(ec::jacobian_point(left), right)};
+            ec::point affine[3];
+            curve.to_affine(points, affine, 3);
+            ASSERT_TRUE(ec::point(2, 4) == affine[0]);
+            ASSERT_TRUE(ec::point::inf == affine[1]);
+            ASSERT_TRUE(ec::point(7, 11) == affine[2]);
+        }
+
         {
             ec::jacobian_point table[1 << 8];
             curve.comb_precompute<8>(left, table);
@@ -222,6 +367,1210 @@ int main() {
         ASSERT_TRUE(pf::integer_type("10297018950366695783893339349991847804652198502529290759859202820577721280788") == result);
     }
 
+    {
+        uint64_t raw[8 * 2], decoded[8 * 2];
+        std::copy(std::begin(alpha), std::end(alpha), raw);
+        std::copy(std::begin(rnd), std::end(rnd), raw + 8);
+
+        byte encoded[der::signature_size];
+        der::write_signature(to_bytes(raw), encoded);
+        ASSERT_TRUE(encoded[3] == to_bytes(rnd)[63] && encoded[3 + 64] == to_bytes(alpha)[63]);
+        ASSERT_TRUE(der::read_signature(encoded, sizeof(encoded), to_bytes(decoded)));
+        ASSERT_TRUE(std::equal(std::begin(raw), std::end(raw), std::begin(decoded)));
+        ASSERT_TRUE(!der::read_signature(encoded, sizeof(encoded) - 1, to_bytes(decoded)));
+
+        // Only the shortest lengths and minimal INTEGERs are DER.
+        const byte sequence[] = {0x30, 0x07, 0x02, 0x02, 0x00, 0x80, 0x02, 0x01, 0x02};
+        ASSERT_TRUE(der::read_signature(sequence, sizeof(sequence), to_bytes(decoded)));
+        ASSERT_TRUE(to_bytes(decoded)[0] == 0x80 && to_bytes(decoded)[64] == 0x02);
+
+        const byte long_length[] = {0x30, 0x81, 0x07, 0x02, 0x02, 0x00, 0x80, 0x02, 0x01, 0x02};
+        const byte wide_length[] = {0x30, 0x82, 0x00, 0x07, 0x02, 0x02, 0x00, 0x80, 0x02, 0x01, 0x02};
+        const byte padded_integer[] = {0x30, 0x07, 0x02, 0x02, 0x00, 0x7f, 0x02, 0x01, 0x02};
+        const byte negative_integer[] = {0x30, 0x06, 0x02, 0x01, 0x80, 0x02, 0x01, 0x02};
+        ASSERT_TRUE(!der::read_signature(long_length, sizeof(long_length), to_bytes(decoded)));
+        ASSERT_TRUE(!der::read_signature(wide_length, sizeof(wide_length), to_bytes(decoded)));
+        ASSERT_TRUE(!der::read_signature(padded_integer, sizeof(padded_integer), to_bytes(decoded)));
+        ASSERT_TRUE(!der::read_signature(negative_integer, sizeof(negative_integer), to_bytes(decoded)));
+
+        byte wide_encoded[der::signature_size + 1] = {encoded[0], 0x82, 0x00};
+        std::copy(encoded + 2, encoded + sizeof(encoded), wide_encoded + 3);
+        ASSERT_TRUE(!der::read_signature(wide_encoded, sizeof(wide_encoded), to_bytes(decoded)));
+    }
+
+    {
+        // Example 1 of GOST R 34.11-2012, digests are little-endian.
+        const char* message = "012345678901234567890123456789012345678901234567890123456789012";
+        const uint64_t expected_512[8] = {
+            0xd5b9f54a1ad0541b, 0x6254288dd6863dcc, 0x352f227524bc9ab1, 0xfa1fbae42b1285c0,
+            0x823a7b76f830ad00, 0x11c324f074654c38, 0x7fef082b3381a4e2, 0x486f64c191787941
+        };
+        const uint64_t expected_256[4] = {
+            0x890b59d8ef1e159d, 0x27f94ab76cbaa6da, 0xa449b16b0251d05d, 0x00557be5e584fd52
+        };
+
+        uint64_t digest[8];
+        streebog::hash(64, reinterpret_cast<const byte*>(message), 63, to_bytes(digest));
+        ASSERT_TRUE(std::equal(std::begin(expected_512), std::end(expected_512), std::begin(digest)));
+
+        streebog hash(32);
+        hash.update(reinterpret_cast<const byte*>(message), 10);
+        hash.update(reinterpret_cast<const byte*>(message) + 10, 53);
+        hash.final(to_bytes(digest));
+        ASSERT_TRUE(std::equal(std::begin(expected_256), std::end(expected_256), std::begin(digest)));
+
+        // Different lengths make lanes finish and refill at different steps.
+        const std::size_t count = streebog::lanes + 3;
+        const byte* messages[count];
+        std::size_t lengths[count];
+        uint64_t digests[count][8];
+        byte* outputs[count];
+        for (std::size_t i = 0; i < count; i++) {
+            messages[i] = reinterpret_cast<const byte*>(message);
+            lengths[i] = 63 - 9 * i;
+            outputs[i] = to_bytes(digests[i]);
+        }
+        streebog::hash_many(64, messages, lengths, outputs, count);
+        ASSERT_TRUE(std::equal(std::begin(expected_512), std::end(expected_512), std::begin(digests[0])));
+        for (std::size_t i = 0; i < count; i++) {
+            streebog::hash(64, messages[i], lengths[i], to_bytes(digest));
+            ASSERT_TRUE(std::equal(std::begin(digest), std::end(digest), std::begin(digests[i])));
+        }
+
+        // Each kernel the CPU has must agree with streaming, over several blocks too.
+        byte long_message[300];
+        for (std::size_t i = 0; i < sizeof(long_message); i++) {
+            long_message[i] = static_cast<byte>(i * 7 + 3);
+        }
+        const std::size_t long_lengths[] = {0, 1, 63, 64, 65, 127, 128, 129, 200, 300, 191};
+        const std::size_t long_count = sizeof(long_lengths) / sizeof(long_lengths[0]);
+        const byte* long_messages[long_count];
+        uint64_t long_digests[long_count][8];
+        byte* long_outputs[long_count];
+        for (std::size_t i = 0; i < long_count; i++) {
+            long_messages[i] = long_message;
+            long_outputs[i] = to_bytes(long_digests[i]);
+        }
+
+        const streebog::kernel kernels[] = {streebog::kernel::generic, streebog::kernel::avx2};
+        ASSERT_TRUE(streebog::use_kernel(streebog::kernel::generic));
+        for (streebog::kernel kernel : kernels) {
+            if (!streebog::use_kernel(kernel)) {
+                continue;
+            }
+            for (std::size_t digest_size : {std::size_t(64), std::size_t(32)}) {
+                streebog::hash_many(digest_size, long_messages, long_lengths, long_outputs, long_count);
+                for (std::size_t i = 0; i < long_count; i++) {
+                    streebog stream(digest_size);
+                    stream.update(long_message, long_lengths[i] / 3);
+                    stream.update(long_message + long_lengths[i] / 3, long_lengths[i] - long_lengths[i] / 3);
+                    stream.final(to_bytes(digest));
+                    ASSERT_TRUE(std::equal(to_bytes(digest), to_bytes(digest) + digest_size, to_bytes(long_digests[i])));
+                }
+            }
+        }
+        ASSERT_TRUE(streebog::use_kernel(streebog::kernel::automatic));
+    }
+
+    {
+        // Example 2 of GOST R 34.11-2012: 72 bytes of CP1251 text, two blocks.
+        const byte message[72] = {
+            0xd1, 0xe5, 0x20, 0xe2, 0xe5, 0xf2, 0xf0, 0xe8, 0x2c, 0x20, 0xd1, 0xf2, 0xf0, 0xe8, 0xe1, 0xee,
+            0xe6, 0xe8, 0x20, 0xe2, 0xed, 0xf3, 0xf6, 0xe8, 0x2c, 0x20, 0xe2, 0xe5, 0xfe, 0xf2, 0xfa, 0x20,
+            0xf1, 0x20, 0xec, 0xee, 0xf0, 0xff, 0x20, 0xf1, 0xf2, 0xf0, 0xe5, 0xeb, 0xe0, 0xec, 0xe8, 0x20,
+            0xed, 0xe0, 0x20, 0xf5, 0xf0, 0xe0, 0xe1, 0xf0, 0xfb, 0xff, 0x20, 0xef, 0xeb, 0xfa, 0xea, 0xfb,
+            0x20, 0xc8, 0xe3, 0xee, 0xf0, 0xe5, 0xe2, 0xfb
+        };
+        const uint64_t expected_512[8] = {
+            0x6fcabf2622e6881e, 0xe06915d5f2f19499, 0x1ae60f3b5a47f8da, 0x7613966de4ee0053,
+            0xb8a2ad4935e85f03, 0xb3e56c497ccd0f62, 0x60642bdcddb90c3f, 0x28fbc9bada033b14
+        };
+        const uint64_t expected_256[4] = {
+            0x5d9e40904efed29d, 0xb005746d97537fa8, 0x749a66fc28c6cac0, 0x508f7e553c06501d
+        };
+
+        uint64_t digest[8];
+        streebog::hash(64, message, sizeof(message), to_bytes(digest));
+        ASSERT_TRUE(std::equal(std::begin(expected_512), std::end(expected_512), std::begin(digest)));
+        streebog::hash(32, message, sizeof(message), to_bytes(digest));
+        ASSERT_TRUE(std::equal(std::begin(expected_256), std::end(expected_256), std::begin(digest)));
+
+        // Splits before, at and after the block boundary, and one byte at a time.
+        const std::size_t splits[] = {0, 1, 8, 63, 64, 65, 71, 72};
+        for (std::size_t split : splits) {
+            streebog hash_512(64), hash_256(32);
+            hash_512.update(message, split);
+            hash_512.update(message + split, sizeof(message) - split);
+            hash_512.final(to_bytes(digest));
+            ASSERT_TRUE(std::equal(std::begin(expected_512), std::end(expected_512), std::begin(digest)));
+
+            hash_256.update(message, split);
+            hash_256.update(message + split, sizeof(message) - split);
+            hash_256.final(to_bytes(digest));
+            ASSERT_TRUE(std::equal(std::begin(expected_256), std::end(expected_256), std::begin(digest)));
+        }
+
+        streebog bytewise(64);
+        for (byte value : message) {
+            bytewise.update(&value, 1);
+        }
+        bytewise.final(to_bytes(digest));
+        ASSERT_TRUE(std::equal(std::begin(expected_512), std::end(expected_512), std::begin(digest)));
+
+        // final() resets, the same object hashes the message again.
+        bytewise.update(message, 60);
+        bytewise.update(message + 60, 12);
+        bytewise.final(to_bytes(digest));
+        ASSERT_TRUE(std::equal(std::begin(expected_512), std::end(expected_512), std::begin(digest)));
+    }
+
+    {
+        typedef elliptic_curve<mp::uint256_t, mp::uint512_t> ec;
+
+        ec curve(17, 17-3, 2);
+        uint64_t counts[op_counters::counter_count];
+
+        op_counters::reset_thread();
+        curve.twice(ec::jacobian_point(ec::point(16, 13)));
+        curve.add(ec::jacobian_point::inf, ec::point(3, 1));
+        op_counters::read_thread(counts);
+
+        // Jacobian doubling is 4S + 5M, zero counts unless compiled in.
+        const uint64_t enabled = op_counters::enabled() ? 1 : 0;
+        ASSERT_TRUE(counts[op_counters::point_twice] == enabled);
+        ASSERT_TRUE(counts[op_counters::point_infinity] == enabled);
+        ASSERT_TRUE(counts[op_counters::point_add_mixed] == 0);
+        ASSERT_TRUE(counts[op_counters::field_sqr] == 4 * enabled);
+        ASSERT_TRUE(counts[op_counters::field_mul] == 5 * enabled);
+        ASSERT_TRUE(counts[op_counters::field_reduce] == 9 * enabled);
+    }
+
+    {
+        // C interface of the counters, which refuses to read or reset unless they are compiled in.
+        ASSERT_TRUE(std::string(Gost12S512CounterName(kGost12S512CounterPointTwice)) == "point_twice");
+        ASSERT_TRUE(Gost12S512CounterName(kGost12S512CounterCount) == nullptr);
+
+        uint64_t thread_counts[kGost12S512CounterCount], all_counts[kGost12S512CounterCount];
+        if (!op_counters::enabled()) {
+            ASSERT_TRUE(Gost12S512CountersReset(kGost12S512CountersAll) == kStatusInternalError);
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersThread, thread_counts) == kStatusInternalError);
+        } else {
+            const Gost12S512CountersScope bad_scope = static_cast<Gost12S512CountersScope>(7);
+            ASSERT_TRUE(Gost12S512CountersRead(bad_scope, thread_counts) == kStatusBadInput);
+
+            // Tables are built before the reset, so both signatures below count the same.
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, nullptr);
+            ASSERT_TRUE(ctx != nullptr);
+            char signature[128];
+            auto sign = [ctx, &signature]() {
+                return Gost12S512CtxSign(ctx, reinterpret_cast<const char*>(a_private_key), reinterpret_cast<const char*>(a_rand),
+                                         reinterpret_cast<const char*>(a_hash), signature);
+            };
+
+            ASSERT_TRUE(Gost12S512CountersReset(kGost12S512CountersAll) == kStatusOk);
+            ASSERT_TRUE(sign() == kStatusOk);
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersThread, thread_counts) == kStatusOk);
+            ASSERT_TRUE(thread_counts[kGost12S512CounterPointTwice] > 0 && thread_counts[kGost12S512CounterFieldInverse] > 0);
+            ASSERT_TRUE(thread_counts[kGost12S512CounterFieldReduce] >= thread_counts[kGost12S512CounterFieldMul]);
+
+            // Counts of a finished thread stay in the total, but not in the counts of this thread.
+            Gost12S512Status status = kStatusInternalError;
+            std::thread([&status, &sign]() { status = sign(); }).join();
+            ASSERT_TRUE(status == kStatusOk);
+            uint64_t after[kGost12S512CounterCount];
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersThread, after) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(after, thread_counts, sizeof(after)) == 0);
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersAll, all_counts) == kStatusOk);
+            for (unsigned i = 0; i < kGost12S512CounterCount; i++) {
+                ASSERT_TRUE(all_counts[i] == 2 * thread_counts[i]);
+            }
+
+            ASSERT_TRUE(Gost12S512CountersReset(kGost12S512CountersThread) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersThread, thread_counts) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersAll, all_counts) == kStatusOk);
+            ASSERT_TRUE(thread_counts[kGost12S512CounterPointTwice] == 0 && all_counts[kGost12S512CounterPointTwice] > 0);
+
+            ASSERT_TRUE(Gost12S512CountersReset(kGost12S512CountersAll) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CountersRead(kGost12S512CountersAll, all_counts) == kStatusOk);
+            for (uint64_t count : all_counts) {
+                ASSERT_TRUE(count == 0);
+            }
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // Every context profile signs like the single-call interface and accepts the result.
+        const char* private_key = reinterpret_cast<const char*>(a_private_key);
+        const char* public_key_x = reinterpret_cast<const char*>(a_public_key_x);
+        const char* public_key_y = reinterpret_cast<const char*>(a_public_key_y);
+        const char* rand = reinterpret_cast<const char*>(a_rand);
+        const char* hash = reinterpret_cast<const char*>(a_hash);
+
+        char other_rand[64], other_hash[64], bad_rand[64], zero_rand[64], wrong_hash[64];
+        std::memcpy(other_rand, rand, sizeof(other_rand));
+        other_rand[0] ^= 0x5a;
+        std::memcpy(other_hash, hash, sizeof(other_hash));
+        other_hash[17] ^= 0x33;
+        std::memset(bad_rand, 0xff, sizeof(bad_rand));
+        std::memset(zero_rand, 0, sizeof(zero_rand));
+        std::memcpy(wrong_hash, hash, sizeof(wrong_hash));
+        wrong_hash[0] ^= 0x01;
+
+        char expected[128], other_expected[128];
+        ASSERT_TRUE(Gost12S512Init() == kStatusOk);
+        ASSERT_TRUE(Gost12S512Sign(private_key, rand, hash, expected) == kStatusOk);
+        ASSERT_TRUE(std::memcmp(expected, a_signature, sizeof(expected)) == 0);
+        ASSERT_TRUE(Gost12S512Verify(public_key_x, public_key_y, hash, expected) == kStatusOk);
+        ASSERT_TRUE(Gost12S512Verify(public_key_x, public_key_y, wrong_hash, expected) == kStatusWrongSignature);
+        ASSERT_TRUE(Gost12S512Sign(private_key, other_rand, other_hash, other_expected) == kStatusOk);
+
+        const unsigned profiles[] = {
+            kGost12S512CtxDefault,
+            kGost12S512CtxRegularSign,
+            kGost12S512CtxCompact,
+            kGost12S512CtxLazyTables,
+            kGost12S512CtxLowLatency,
+            kGost12S512CtxLowLatency | kGost12S512CtxCompact,
+            kGost12S512CtxLowLatency | kGost12S512CtxRegularSign,
+            kGost12S512CtxThreadPool | kGost12S512CtxLazyTables,
+            kGost12S512CtxThreadPool | kGost12S512CtxNumaReplicate
+        };
+
+        for (unsigned flags : profiles) {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = flags;
+            options.threads = 2;
+
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+            ASSERT_TRUE(ctx != nullptr);
+
+            char signature[128];
+            ASSERT_TRUE(Gost12S512CtxSign(ctx, private_key, rand, hash, signature) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(signature, expected, sizeof(signature)) == 0);
+            ASSERT_TRUE(Gost12S512CtxVerify(ctx, public_key_x, public_key_y, hash, signature) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CtxVerify(ctx, public_key_x, public_key_y, wrong_hash, signature) == kStatusWrongSignature);
+            ASSERT_TRUE(Gost12S512CtxSign(ctx, private_key, bad_rand, hash, signature) == kStatusBadInput);
+            // A zero nonce gives r = 1 and s = d, it must never be signed with.
+            ASSERT_TRUE(Gost12S512CtxSign(ctx, private_key, zero_rand, hash, signature) == kStatusBadInput);
+
+            Gost12S512Operation* operation = Gost12S512CtxSignStart(ctx, private_key, zero_rand, hash, signature);
+            ASSERT_TRUE(operation != nullptr);
+            while (Gost12S512OperationStep(operation, 16) == 0) {
+            }
+            ASSERT_TRUE(Gost12S512OperationStatus(operation) == kStatusBadInput);
+            Gost12S512OperationDestroy(operation);
+
+            char batch_signatures[4][128];
+            Gost12S512SignJob sign_jobs[4] = {
+                {private_key, rand, hash, batch_signatures[0], kStatusInternalError},
+                {private_key, bad_rand, hash, batch_signatures[1], kStatusInternalError},
+                {private_key, other_rand, other_hash, batch_signatures[2], kStatusInternalError},
+                {private_key, zero_rand, hash, batch_signatures[3], kStatusInternalError}
+            };
+            ASSERT_TRUE(Gost12S512CtxSignBatch(ctx, sign_jobs, 4) == kStatusOk);
+            ASSERT_TRUE(sign_jobs[0].status == kStatusOk && sign_jobs[1].status == kStatusBadInput && sign_jobs[2].status == kStatusOk);
+            ASSERT_TRUE(sign_jobs[3].status == kStatusBadInput);
+            ASSERT_TRUE(std::memcmp(batch_signatures[0], expected, sizeof(expected)) == 0);
+            ASSERT_TRUE(std::memcmp(batch_signatures[2], other_expected, sizeof(other_expected)) == 0);
+
+            Gost12S512VerifyJob verify_jobs[3] = {
+                {public_key_x, public_key_y, hash, expected, kStatusInternalError},
+                {public_key_x, public_key_y, wrong_hash, expected, kStatusInternalError},
+                {public_key_x, public_key_y, other_hash, other_expected, kStatusInternalError}
+            };
+            ASSERT_TRUE(Gost12S512CtxVerifyBatch(ctx, verify_jobs, 3) == kStatusOk);
+            ASSERT_TRUE(verify_jobs[0].status == kStatusOk && verify_jobs[1].status == kStatusWrongSignature && verify_jobs[2].status == kStatusOk);
+
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // paramSetB, expected values computed independently with affine formulas.
+        const uint64_t private_key[8] = {
+            0x2d8ba9388a5c660a, 0x2c3af080bf1b0cf3, 0xf2456d26b23e1b78, 0x4e00d2a0c604605c,
+            0x25ea81df3acfe8c1, 0xbbf8633a4563d870, 0x90825b4f5d2b0ecc, 0x5985de5b3ee68d96
+        };
+        const uint64_t rand[8] = {
+            0x78638d069a16b130, 0x18a565344abcd2b0, 0xb8c605bf697a3c4d, 0xd3ea7a5c515f7aaf,
+            0xec5279c060fea52e, 0x906883f0b1a7ed61, 0xc84eb4d44f85fe9c, 0x14331524e9bfa84e
+        };
+        const uint64_t hash[8] = {
+            0x0be743868f8dfc41, 0x7582dddb42e0d2e5, 0x431982b0614e1f41, 0xe70ff01b639b77b7,
+            0xf791e830f4a23604, 0x63db73ef6205d122, 0xc1eaa6e67983550b, 0x76e0d448244a4bdc
+        };
+        const uint64_t public_key[16] = {
+            0xb2ae91ff121ff562, 0x271cf9819dc17053, 0xa43b42bb9f08be64, 0x09e585ac68bc0f00,
+            0xc416a58e233e5845, 0x11383810e59c9e0b, 0x8e20dc961e97ac94, 0x11eec9a9df1570a6,
+            0x93a39a3c8a8e996e, 0x119c8af231bb0a9b, 0xc8d4e428dbfd55c1, 0xbcfb89721e1c621a,
+            0xc26f8d4c071b9047, 0x1fbc22aac4c92787, 0x118cf4de858b91a7, 0x775055ce89372125
+        };
+        const uint64_t expected[16] = {
+            0x38ba84b836d27a8e, 0xea349c98be583479, 0x77d8d9e62bd7a9b4, 0x60d548112363a6c3,
+            0x12d49bf39b42fc9a, 0x1556fb0cfcf294e8, 0x506f88589e9d6d39, 0x35b830d92b3c7ebc,
+            0x9cffd9a2a15d0789, 0x01e93ec9949dc6d2, 0x575690e46b363aa3, 0xc40d8fc75bb48488,
+            0x8e83128420e28159, 0x36bfb4c6b5d08f7f, 0xe7d8621c8bf8d664, 0x4d41eb874cfdfdfc
+        };
+        const char* key = reinterpret_cast<const char*>(private_key);
+        const char* x = reinterpret_cast<const char*>(public_key);
+        const char* y = reinterpret_cast<const char*>(public_key + 8);
+        const char* digest = reinterpret_cast<const char*>(hash);
+
+        const unsigned profiles[] = {kGost12S512CtxDefault, kGost12S512CtxCompact, kGost12S512CtxRegularSign};
+        for (unsigned flags : profiles) {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = flags;
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetB, &options);
+            ASSERT_TRUE(ctx != nullptr);
+
+            char derived_x[64], derived_y[64], restored_y[64], signature[128];
+            char* xs[] = {derived_x};
+            char* ys[] = {derived_y};
+            ASSERT_TRUE(Gost12S512CtxDeriveKeys(ctx, &key, xs, ys, 1) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(derived_x, x, 64) == 0 && std::memcmp(derived_y, y, 64) == 0);
+            ASSERT_TRUE(Gost12S512CtxDecompressKey(ctx, x, y[0] & 1, restored_y) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(restored_y, y, 64) == 0);
+
+            ASSERT_TRUE(Gost12S512CtxSign(ctx, key, reinterpret_cast<const char*>(rand), digest, signature) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(signature, expected, sizeof(signature)) == 0);
+            ASSERT_TRUE(Gost12S512CtxVerify(ctx, x, y, digest, signature) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CtxVerify(ctx, reinterpret_cast<const char*>(a_public_key_x),
+                                            reinterpret_cast<const char*>(a_public_key_y), digest, signature) != kStatusOk);
+
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // Batches of 5 and 9 leave partly filled groups of interleaved lanes, every job must
+        // still match the single-call path, rejected nonces and signatures included.
+        const char* private_key = reinterpret_cast<const char*>(a_private_key);
+        const char* public_key_x = reinterpret_cast<const char*>(a_public_key_x);
+        const char* public_key_y = reinterpret_cast<const char*>(a_public_key_y);
+        const std::size_t max_count = 9;
+
+        char rands[max_count][64], hashes[max_count][64];
+        for (std::size_t i = 0; i < max_count; i++) {
+            std::memcpy(rands[i], a_rand, 64);
+            std::memcpy(hashes[i], a_hash, 64);
+            rands[i][5] ^= static_cast<char>(i);
+            hashes[i][11] ^= static_cast<char>(i * 3);
+            if (i % 3 == 1) {
+                std::memset(rands[i], 0xff, 64);
+            } else if (i == 4 || i == 8) {
+                std::memset(rands[i], 0, 64);
+            }
+        }
+
+        const unsigned profiles[] = {kGost12S512CtxDefault, kGost12S512CtxCompact, kGost12S512CtxRegularSign};
+        for (unsigned flags : profiles) {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = flags;
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+            ASSERT_TRUE(ctx != nullptr);
+
+            for (std::size_t count : {std::size_t(5), max_count}) {
+                char signatures[max_count][128], single[128];
+                Gost12S512SignJob sign_jobs[max_count];
+                for (std::size_t i = 0; i < count; i++) {
+                    sign_jobs[i] = {private_key, rands[i], hashes[i], signatures[i], kStatusInternalError};
+                }
+                ASSERT_TRUE(Gost12S512CtxSignBatch(ctx, sign_jobs, count) == kStatusOk);
+
+                Gost12S512VerifyJob verify_jobs[max_count];
+                char wrong_hash[64];
+                std::memcpy(wrong_hash, hashes[0], 64);
+                wrong_hash[0] ^= 0x01;
+                for (std::size_t i = 0; i < count; i++) {
+                    const Gost12S512Status status = Gost12S512CtxSign(ctx, private_key, rands[i], hashes[i], single);
+                    ASSERT_TRUE(sign_jobs[i].status == status);
+                    ASSERT_TRUE(status == ((i % 3 == 1 || i == 4 || i == 8) ? kStatusBadInput : kStatusOk));
+                    if (status == kStatusOk) {
+                        ASSERT_TRUE(std::memcmp(signatures[i], single, sizeof(single)) == 0);
+                    } else {
+                        // A zero signature stands in for rejected jobs, verification refuses it too.
+                        std::memset(signatures[i], 0, sizeof(signatures[i]));
+                    }
+                    verify_jobs[i] = {public_key_x, public_key_y, (i == 3) ? wrong_hash : hashes[i], signatures[i],
+                                      kStatusInternalError};
+                }
+
+                ASSERT_TRUE(Gost12S512CtxVerifyBatch(ctx, verify_jobs, count) == kStatusOk);
+                for (std::size_t i = 0; i < count; i++) {
+                    const Gost12S512Status status = Gost12S512CtxVerify(ctx, verify_jobs[i].publicKeyX, verify_jobs[i].publicKeyY,
+                                                                        verify_jobs[i].hash, verify_jobs[i].signature);
+                    ASSERT_TRUE(verify_jobs[i].status == status);
+                    ASSERT_TRUE((status == kStatusOk) == (sign_jobs[i].status == kStatusOk && i != 3));
+                }
+            }
+
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // Resumable signing isn't offered with the regular comb, batches still skip zero keys.
+        Gost12S512CtxOptions options;
+        Gost12S512CtxOptionsInit(&options);
+        options.flags = kGost12S512CtxRegularSign;
+        Gost12S512Ctx* regular = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+        Gost12S512Ctx* plain = Gost12S512CtxCreate(kGost12S512ParamSetA, nullptr);
+        ASSERT_TRUE(regular != nullptr && plain != nullptr);
+
+        const char* private_key = reinterpret_cast<const char*>(a_private_key);
+        const char* rand = reinterpret_cast<const char*>(a_rand);
+        const char* hash = reinterpret_cast<const char*>(a_hash);
+        char signature[128];
+
+        Gost12S512Operation* operation = Gost12S512CtxSignStart(regular, private_key, rand, hash, signature);
+        ASSERT_TRUE(operation != nullptr);
+        ASSERT_TRUE(Gost12S512OperationStep(operation, 1) == 1);
+        ASSERT_TRUE(Gost12S512OperationStatus(operation) == kStatusBadInput);
+        Gost12S512OperationDestroy(operation);
+
+        operation = Gost12S512CtxSignStart(plain, private_key, rand, hash, signature);
+        ASSERT_TRUE(operation != nullptr);
+        while (Gost12S512OperationStep(operation, 16) == 0) {
+        }
+        ASSERT_TRUE(Gost12S512OperationStatus(operation) == kStatusOk);
+        ASSERT_TRUE(std::memcmp(signature, a_signature, sizeof(signature)) == 0);
+        Gost12S512OperationDestroy(operation);
+
+        const char zero_key[64] = {};
+        const char* keys[] = {zero_key, private_key};
+        char xs[2][64], ys[2][64];
+        char* public_keys_x[] = {xs[0], xs[1]};
+        char* public_keys_y[] = {ys[0], ys[1]};
+        ASSERT_TRUE(Gost12S512CtxDeriveKeys(regular, keys, public_keys_x, public_keys_y, 2) == kStatusBadInput);
+        ASSERT_TRUE(std::equal(std::begin(xs[0]), std::end(xs[0]), zero_key));
+        ASSERT_TRUE(std::equal(std::begin(ys[0]), std::end(ys[0]), zero_key));
+        ASSERT_TRUE(std::memcmp(xs[1], a_public_key_x, 64) == 0 && std::memcmp(ys[1], a_public_key_y, 64) == 0);
+
+        Gost12S512CtxDestroy(plain);
+        Gost12S512CtxDestroy(regular);
+    }
+
+    {
+        // Cached results never differ from full verification, repeats cost no point operations.
+        const char* public_key_x = reinterpret_cast<const char*>(a_public_key_x);
+        const char* public_key_y = reinterpret_cast<const char*>(a_public_key_y);
+        const char* hash = reinterpret_cast<const char*>(a_hash);
+
+        char signature[128], wrong_signature[128], wrong_hash[64], other_key_x[64], other_key_y[64];
+        ASSERT_TRUE(Gost12S512Sign(reinterpret_cast<const char*>(a_private_key), reinterpret_cast<const char*>(a_rand),
+                                   hash, signature) == kStatusOk);
+        std::memcpy(wrong_signature, signature, sizeof(wrong_signature));
+        wrong_signature[70] ^= 0x10;
+        std::memcpy(wrong_hash, hash, sizeof(wrong_hash));
+        wrong_hash[5] ^= 0x01;
+        std::memset(other_key_x, 0, sizeof(other_key_x));
+        std::memset(other_key_y, 0, sizeof(other_key_y));
+
+        const uint64_t enabled = op_counters::enabled() ? 1 : 0;
+        const unsigned profiles[] = {kGost12S512CtxDefault, kGost12S512CtxCacheRejected};
+
+        for (unsigned flags : profiles) {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = flags;
+            options.verifyCacheSize = 16;
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+            ASSERT_TRUE(ctx != nullptr);
+
+            for (unsigned round = 0; round < 2; round++) {
+                uint64_t counts[op_counters::counter_count];
+
+                op_counters::reset_thread();
+                ASSERT_TRUE(Gost12S512CtxVerify(ctx, public_key_x, public_key_y, hash, signature) == kStatusOk);
+                op_counters::read_thread(counts);
+                ASSERT_TRUE((counts[op_counters::point_twice] > 0) == (round == 0 && enabled));
+
+                op_counters::reset_thread();
+                ASSERT_TRUE(Gost12S512CtxVerify(ctx, public_key_x, public_key_y, hash, wrong_signature) == kStatusWrongSignature);
+                op_counters::read_thread(counts);
+                const bool cached = round > 0 && (flags & kGost12S512CtxCacheRejected) != 0;
+                ASSERT_TRUE((counts[op_counters::point_twice] > 0) == (!cached && enabled));
+
+                ASSERT_TRUE(Gost12S512CtxVerify(ctx, public_key_x, public_key_y, wrong_hash, signature) == kStatusWrongSignature);
+                ASSERT_TRUE(Gost12S512CtxVerify(ctx, other_key_x, other_key_y, hash, signature) != kStatusOk);
+            }
+
+            Gost12S512VerifyJob jobs[2] = {
+                {public_key_x, public_key_y, hash, signature, kStatusInternalError},
+                {public_key_x, public_key_y, wrong_hash, signature, kStatusInternalError}
+            };
+            ASSERT_TRUE(Gost12S512CtxVerifyBatch(ctx, jobs, 2) == kStatusOk);
+            ASSERT_TRUE(jobs[0].status == kStatusOk && jobs[1].status == kStatusWrongSignature);
+
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // Resumable operations and the queue build lazy tables on first use and still agree
+        // with the single-call interface.
+        const char* private_key = reinterpret_cast<const char*>(a_private_key);
+        const char* public_key_x = reinterpret_cast<const char*>(a_public_key_x);
+        const char* public_key_y = reinterpret_cast<const char*>(a_public_key_y);
+        const char* rand = reinterpret_cast<const char*>(a_rand);
+        const char* hash = reinterpret_cast<const char*>(a_hash);
+
+        char expected[128], wrong_hash[64];
+        ASSERT_TRUE(Gost12S512Sign(private_key, rand, hash, expected) == kStatusOk);
+        std::memcpy(wrong_hash, hash, sizeof(wrong_hash));
+        wrong_hash[63] ^= 0x40;
+
+        const unsigned profiles[] = {kGost12S512CtxLazyTables, kGost12S512CtxLazyTables | kGost12S512CtxCompact};
+
+        for (unsigned flags : profiles) {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = flags;
+
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+            ASSERT_TRUE(ctx != nullptr);
+            const size_t unbuilt = Gost12S512CtxMemoryUsage(ctx);
+
+            char signature[128];
+            // Start leaves building the tables to the steps, the first one pays for it.
+            Gost12S512Operation* sign = Gost12S512CtxSignStart(ctx, private_key, rand, hash, signature);
+            ASSERT_TRUE(sign != nullptr);
+            ASSERT_TRUE(Gost12S512OperationStatus(sign) == kStatusInternalError);
+            ASSERT_TRUE(Gost12S512CtxMemoryUsage(ctx) == unbuilt);
+            ASSERT_TRUE(Gost12S512OperationStep(sign, 8) == 0);
+            const size_t signing_built = Gost12S512CtxMemoryUsage(ctx);
+            ASSERT_TRUE(signing_built > unbuilt);
+            unsigned steps = 0;
+            while (Gost12S512OperationStep(sign, 8) == 0) {
+                steps++;
+            }
+            ASSERT_TRUE(steps > 1);
+            ASSERT_TRUE(Gost12S512OperationStatus(sign) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(signature, expected, sizeof(signature)) == 0);
+            Gost12S512OperationDestroy(sign);
+            ASSERT_TRUE(Gost12S512CtxMemoryUsage(ctx) == signing_built);
+
+            const char* hashes[] = {hash, wrong_hash};
+            const Gost12S512Status statuses[] = {kStatusOk, kStatusWrongSignature};
+            for (unsigned i = 0; i < 2; i++) {
+                Gost12S512Operation* verify = Gost12S512CtxVerifyStart(ctx, public_key_x, public_key_y, hashes[i], expected);
+                ASSERT_TRUE(verify != nullptr);
+                if (i == 0) {
+                    ASSERT_TRUE(Gost12S512CtxMemoryUsage(ctx) == signing_built);
+                }
+                while (Gost12S512OperationStep(verify, 8) == 0) {
+                }
+                ASSERT_TRUE(Gost12S512OperationStatus(verify) == statuses[i]);
+                Gost12S512OperationDestroy(verify);
+            }
+            ASSERT_TRUE(Gost12S512CtxMemoryUsage(ctx) > signing_built);
+
+            char queued_signature[128];
+            Gost12S512Token token, untouched;
+            std::memset(&untouched, 0x5a, sizeof(untouched));
+            const char zero_rand[64] = {};
+            Gost12S512Request requests[5];
+            std::memset(requests, 0, sizeof(requests));
+            requests[0].type = kGost12S512RequestSign;
+            requests[0].privateKey = private_key;
+            requests[0].rand = rand;
+            requests[0].hash = hash;
+            requests[0].signature = queued_signature;
+            requests[1].type = kGost12S512RequestVerify;
+            requests[1].publicKeyX = public_key_x;
+            requests[1].publicKeyY = public_key_y;
+            requests[1].hash = hash;
+            requests[1].signature = expected;
+            requests[2] = requests[1];
+            requests[2].hash = wrong_hash;
+            requests[3].type = kGost12S512RequestPresign;
+            requests[3].rand = rand;
+            requests[3].token = &token;
+            requests[4] = requests[3];
+            requests[4].rand = zero_rand;
+            requests[4].token = &untouched;
+            for (uintptr_t i = 0; i < 5; i++) {
+                requests[i].userData = reinterpret_cast<void*>(i);
+            }
+
+            Gost12S512Queue* queue = Gost12S512QueueCreate(ctx, 5, 2, nullptr, nullptr);
+            ASSERT_TRUE(queue != nullptr);
+            ASSERT_TRUE(Gost12S512QueueSubmit(queue, requests, 5) == 5);
+            ASSERT_TRUE(Gost12S512QueueSubmit(queue, requests, 1) == 0);
+
+            Gost12S512Status completed[5];
+            size_t reaped = 0;
+            for (unsigned wait = 0; reaped < 5 && wait < 60000; wait++) {
+                Gost12S512Completion completions[5];
+                const size_t count = Gost12S512QueueReap(queue, completions, 5 - reaped);
+                for (size_t i = 0; i < count; i++) {
+                    completed[reinterpret_cast<uintptr_t>(completions[i].userData)] = completions[i].status;
+                }
+                reaped += count;
+                if (count == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            Gost12S512QueueDestroy(queue);
+
+            ASSERT_TRUE(reaped == 5);
+            ASSERT_TRUE(completed[0] == kStatusOk && completed[1] == kStatusOk);
+            ASSERT_TRUE(completed[2] == kStatusWrongSignature && completed[3] == kStatusOk);
+            ASSERT_TRUE(completed[4] == kStatusBadInput);
+            ASSERT_TRUE(reinterpret_cast<const unsigned char*>(untouched.data)[0] == 0x5a);
+            ASSERT_TRUE(std::memcmp(queued_signature, expected, sizeof(expected)) == 0);
+
+            ASSERT_TRUE(Gost12S512CtxSignWithToken(ctx, &token, private_key, hash, signature) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(signature, expected, sizeof(expected)) == 0);
+
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // Key and encoding helpers on the full and the compact tables.
+        const char* private_key = reinterpret_cast<const char*>(a_private_key);
+        const char* public_key_x = reinterpret_cast<const char*>(a_public_key_x);
+        const char* public_key_y = reinterpret_cast<const char*>(a_public_key_y);
+        const char* rand = reinterpret_cast<const char*>(a_rand);
+        const char* hash = reinterpret_cast<const char*>(a_hash);
+
+        char expected[128];
+        ASSERT_TRUE(Gost12S512Sign(private_key, rand, hash, expected) == kStatusOk);
+
+        // Second party's private key, any number below q will do.
+        const char* peer_private_key = hash;
+        char bad_rand[64];
+        std::memset(bad_rand, 0xff, sizeof(bad_rand));
+
+        const unsigned profiles[] = {kGost12S512CtxDefault, kGost12S512CtxCompact};
+
+        for (unsigned flags : profiles) {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = flags;
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+            ASSERT_TRUE(ctx != nullptr);
+
+            char signature[128];
+
+            // Presigned tokens sign like the nonces they come from, a bad nonce gives a dead token.
+            const char zero_rand[64] = {};
+            const char* nonces[] = {rand, bad_rand, zero_rand};
+            Gost12S512Token tokens[3];
+            ASSERT_TRUE(Gost12S512CtxPresign(ctx, nonces, tokens, 1) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CtxPresign(ctx, nonces, tokens, 3) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512CtxSignWithToken(ctx, &tokens[0], private_key, hash, signature) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(signature, expected, sizeof(expected)) == 0);
+            ASSERT_TRUE(Gost12S512CtxSignWithToken(ctx, &tokens[1], private_key, hash, signature) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512CtxSignWithToken(ctx, &tokens[2], private_key, hash, signature) == kStatusBadInput);
+
+            // Derived keys are the ones Gost12S512Verify() accepts.
+            const char* keys[] = {private_key, peer_private_key};
+            char xs[2][64], ys[2][64];
+            char* keys_x[] = {xs[0], xs[1]};
+            char* keys_y[] = {ys[0], ys[1]};
+            ASSERT_TRUE(Gost12S512CtxDeriveKeys(ctx, keys, keys_x, keys_y, 2) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(xs[0], public_key_x, 64) == 0 && std::memcmp(ys[0], public_key_y, 64) == 0);
+            ASSERT_TRUE(Gost12S512Verify(xs[0], ys[0], hash, expected) == kStatusOk);
+
+            // Compressed keys restore Y and verify, X off the curve is rejected.
+            char restored_y[64];
+            ASSERT_TRUE(Gost12S512CtxDecompressKey(ctx, public_key_x, public_key_y[0] & 1, restored_y) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(restored_y, public_key_y, 64) == 0);
+            ASSERT_TRUE(Gost12S512CtxVerifyCompressed(ctx, public_key_x, public_key_y[0] & 1, hash, expected) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CtxVerifyCompressed(ctx, public_key_x, (public_key_y[0] & 1) ^ 1, hash, expected) == kStatusWrongSignature);
+            bool off_curve_found = false;
+            for (unsigned char tweak = 1; tweak < 16 && !off_curve_found; tweak++) {
+                char x[64];
+                std::memcpy(x, public_key_x, sizeof(x));
+                x[0] ^= tweak;
+                off_curve_found = Gost12S512CtxDecompressKey(ctx, x, 0, restored_y) == kStatusBadInput &&
+                    Gost12S512CtxVerifyCompressed(ctx, x, 0, hash, expected) == kStatusBadInput;
+            }
+            ASSERT_TRUE(off_curve_found);
+
+            // DER signatures and keys round-trip, malformed encodings are rejected.
+            char der_signature[GOST12S512_DER_SIGNATURE_SIZE];
+            Gost12S512SignatureToDer(expected, der_signature);
+            ASSERT_TRUE(Gost12S512SignatureFromDer(der_signature, sizeof(der_signature), signature) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(signature, expected, sizeof(expected)) == 0);
+
+            char der_key[3 + 128] = {0x04, static_cast<char>(0x81), static_cast<char>(0x80)};
+            std::memcpy(der_key + 3, public_key_x, 64);
+            std::memcpy(der_key + 3 + 64, public_key_y, 64);
+            char der_x[64], der_y[64];
+            ASSERT_TRUE(Gost12S512PublicKeyFromDer(der_key, sizeof(der_key), der_x, der_y) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(der_x, public_key_x, 64) == 0 && std::memcmp(der_y, public_key_y, 64) == 0);
+            ASSERT_TRUE(Gost12S512CtxVerifyDer(ctx, der_key, sizeof(der_key), hash, der_signature, sizeof(der_signature)) == kStatusOk);
+
+            char malformed[GOST12S512_DER_SIGNATURE_SIZE];
+            std::memcpy(malformed, der_signature, sizeof(malformed));
+            malformed[0] = 0x02;
+            ASSERT_TRUE(Gost12S512SignatureFromDer(malformed, sizeof(malformed), signature) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512SignatureFromDer(der_signature, sizeof(der_signature) - 1, signature) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512SignatureFromDer(der_signature, 2, signature) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512PublicKeyFromDer(der_key, sizeof(der_key) - 1, der_x, der_y) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512CtxVerifyDer(ctx, der_key, sizeof(der_key), hash, malformed, sizeof(malformed)) == kStatusBadInput);
+
+            // VKO: both parties get the same shared point, bad inputs are refused.
+            const char ukm[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+            char shared_x[2][64], shared_y[2][64];
+            ASSERT_TRUE(Gost12S512CtxAgree(ctx, private_key, xs[1], ys[1], ukm, sizeof(ukm), shared_x[0], shared_y[0]) == kStatusOk);
+            ASSERT_TRUE(Gost12S512CtxAgree(ctx, peer_private_key, xs[0], ys[0], ukm, sizeof(ukm), shared_x[1], shared_y[1]) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(shared_x[0], shared_x[1], 64) == 0 && std::memcmp(shared_y[0], shared_y[1], 64) == 0);
+
+            char bad_y[64];
+            std::memcpy(bad_y, ys[1], sizeof(bad_y));
+            bad_y[0] ^= 1;
+            char long_ukm[65] = {1};
+            ASSERT_TRUE(Gost12S512CtxAgree(ctx, private_key, xs[1], bad_y, ukm, sizeof(ukm), shared_x[0], shared_y[0]) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512CtxAgree(ctx, bad_rand, xs[1], ys[1], ukm, sizeof(ukm), shared_x[0], shared_y[0]) == kStatusBadInput);
+            ASSERT_TRUE(Gost12S512CtxAgree(ctx, private_key, xs[1], ys[1], long_ukm, sizeof(long_ukm), shared_x[0], shared_y[0]) == kStatusBadInput);
+
+            Gost12S512CtxDestroy(ctx);
+        }
+    }
+
+    {
+        // Signatures of gost_ecc_tool are accepted by Gost12S512Verify(), the tool accepts
+        // those of Gost12S512Sign() and rejects changed files.
+        char directory[] = "/tmp/gost_ecc_test.XXXXXX";
+        ASSERT_TRUE(::mkdtemp(directory) != nullptr);
+        const std::string dir = directory;
+        const std::string tool = GOST_ECC_TOOL;
+
+        const std::string private_key = dir + "/private.key";
+        const std::string public_key = dir + "/public.key";
+        char key[128];
+        std::memcpy(key, a_public_key_x, 64);
+        std::memcpy(key + 64, a_public_key_y, 64);
+        ASSERT_TRUE(write_file(private_key, a_private_key, 64) && write_file(public_key, key, sizeof(key)));
+
+        const std::string messages[] = {"", "abc", std::string(100000, 'x')};
+        std::string files;
+        for (unsigned i = 0; i < 3; i++) {
+            const std::string path = dir + "/message" + std::to_string(i);
+            ASSERT_TRUE(write_file(path, messages[i].data(), messages[i].size()));
+            files += " " + path;
+        }
+
+        ASSERT_TRUE(run_quietly(tool + " sign --key " + private_key + " --threads 2 --batch 2" + files) == 0);
+
+        char digests[3][64];
+        for (unsigned i = 0; i < 3; i++) {
+            Gost12S512Hash* hash = Gost12S512HashCreate(64);
+            ASSERT_TRUE(hash != nullptr);
+            Gost12S512HashUpdate(hash, messages[i].data(), messages[i].size());
+            Gost12S512HashFinal(hash, digests[i]);
+            Gost12S512HashDestroy(hash);
+
+            char signature[128];
+            ASSERT_TRUE(read_file(dir + "/message" + std::to_string(i) + ".sig", signature, sizeof(signature)));
+            ASSERT_TRUE(Gost12S512Verify(key, key + 64, digests[i], signature) == kStatusOk);
+        }
+
+        char signature[128];
+        ASSERT_TRUE(Gost12S512Sign(reinterpret_cast<const char*>(a_private_key), reinterpret_cast<const char*>(a_rand),
+                                   digests[1], signature) == kStatusOk);
+        ASSERT_TRUE(write_file(dir + "/message1.sig", signature, sizeof(signature)));
+        ASSERT_TRUE(run_quietly(tool + " verify --key " + public_key + files) == 0);
+
+        ASSERT_TRUE(write_file(dir + "/message2", "y", 1));
+        ASSERT_TRUE(run_quietly(tool + " verify --key " + public_key + files) == 1);
+        ASSERT_TRUE(run_quietly(tool + " verify --key " + dir + "/missing.key" + files) == 2);
+
+        for (unsigned i = 0; i < 3; i++) {
+            std::remove((dir + "/message" + std::to_string(i)).c_str());
+            std::remove((dir + "/message" + std::to_string(i) + ".sig").c_str());
+        }
+        std::remove(private_key.c_str());
+        std::remove(public_key.c_str());
+        ASSERT_TRUE(::rmdir(directory) == 0);
+    }
+
+    {
+        std::atomic<unsigned> started(0);
+        thread_pool pool(3, [&started](unsigned index) { started |= 1u << index; });
+
+        // Uneven range and uneven work: every index runs exactly once.
+        std::vector<std::atomic<unsigned> > hits(1001);
+        for (std::atomic<unsigned>& hit : hits) {
+            hit = 0;
+        }
+        pool.parallel_for(hits.size(), [&hits](std::size_t i) {
+            if (i < 20) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            hits[i]++;
+        });
+        for (const std::atomic<unsigned>& hit : hits) {
+            ASSERT_TRUE(hit == 1);
+        }
+        ASSERT_TRUE(started == 7);
+
+        // Fewer indices than workers, and an empty range.
+        std::atomic<unsigned> calls(0);
+        pool.parallel_for(2, [&calls](std::size_t) { calls++; });
+        pool.parallel_for(0, [&calls](std::size_t) { calls++; });
+        ASSERT_TRUE(calls == 2);
+
+        // Exception of one index reaches the caller after the other chunks have finished.
+        calls = 0;
+        bool caught = false;
+        try {
+            pool.parallel_for(100, [&calls](std::size_t i) {
+                if (i == 0) {
+                    throw std::runtime_error("body");
+                }
+                calls++;
+            });
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        // Only the rest of the first chunk, 100 / (3 * 4) rounded up, is skipped.
+        ASSERT_TRUE(caught && calls == 100 - 9);
+
+        // A task queued behind a blocked worker is stolen by an idle one.
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool stolen_done = false;
+        bool blocked_done = false;
+        unsigned finished = 0;
+        auto finish = [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished++;
+            changed.notify_all();
+        };
+        thread_pool workers(2);
+        workers.submit([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            blocked_done = changed.wait_for(lock, std::chrono::seconds(10), [&]() { return stolen_done; });
+            finished++;
+            changed.notify_all();
+        });
+        workers.submit(finish);
+        workers.submit([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            stolen_done = true;
+            finished++;
+            changed.notify_all();
+        });
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return finished == 3; });
+        }
+        ASSERT_TRUE(blocked_done);
+
+        // One-off tasks: all of them run, the first exception is rethrown.
+        std::vector<std::atomic<unsigned> > runs(9);
+        std::vector<std::function<void()> > tasks;
+        for (std::size_t i = 0; i < runs.size(); i++) {
+            runs[i] = 0;
+            tasks.push_back([&runs, i]() {
+                runs[i]++;
+                if (i == 4) {
+                    throw std::runtime_error("task");
+                }
+            });
+        }
+        caught = false;
+        try {
+            thread_pool::run_parallel(tasks);
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        ASSERT_TRUE(caught);
+        for (const std::atomic<unsigned>& run : runs) {
+            ASSERT_TRUE(run == 1);
+        }
+    }
+
+    {
+        // Corpus reader of the contest harness: raw entries, version 1 files and broken headers.
+        TestEntry entries[3];
+        for (unsigned i = 0; i < 3; i++) {
+            std::memset(&entries[i], static_cast<int>(0x11 * (i + 1)), sizeof(TestEntry));
+        }
+
+        Corpus corpus;
+        std::memset(&corpus, 0, sizeof(corpus));
+        ASSERT_TRUE(CorpusAttach(&corpus, entries, sizeof(entries)) == kCorpusOk);
+        ASSERT_TRUE(corpus.version == 0 && corpus.count == 3 && corpus.stride == sizeof(TestEntry));
+        ASSERT_TRUE(CorpusEntry(&corpus, 2) == &entries[2]);
+        ASSERT_TRUE(CorpusAttach(&corpus, entries, sizeof(entries) - 1) == kCorpusBadFormat);
+        ASSERT_TRUE(CorpusAttach(&corpus, entries, 0) == kCorpusBadFormat);
+
+        const std::size_t header_size = 2 * CORPUS_ALIGNMENT, record_size = 8 * CORPUS_ALIGNMENT;
+        std::vector<char> file(header_size + 3 * record_size, 0);
+        CorpusHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, CORPUS_MAGIC, sizeof(header.magic));
+        header.version = CORPUS_VERSION;
+        header.header_size = header_size;
+        header.record_size = record_size;
+        header.count = 3;
+        for (unsigned i = 0; i < 3; i++) {
+            std::memcpy(&file[header_size + i * record_size], &entries[i], sizeof(TestEntry));
+        }
+
+        auto attach = [&file](const CorpusHeader& changed, std::size_t size) {
+            std::memcpy(file.data(), &changed, sizeof(changed));
+            Corpus result;
+            return CorpusAttach(&result, file.data(), size);
+        };
+
+        std::memcpy(file.data(), &header, sizeof(header));
+        ASSERT_TRUE(CorpusAttach(&corpus, file.data(), file.size()) == kCorpusOk);
+        ASSERT_TRUE(corpus.version == 1 && corpus.count == 3 && corpus.stride == record_size);
+        ASSERT_TRUE(std::memcmp(CorpusEntry(&corpus, 1), &entries[1], sizeof(TestEntry)) == 0);
+        // A truncated last record is rejected.
+        ASSERT_TRUE(attach(header, file.size() - 1) == kCorpusBadFormat);
+
+        CorpusHeader broken = header;
+        broken.version = CORPUS_VERSION + 1;
+        ASSERT_TRUE(attach(broken, file.size()) == kCorpusUnsupportedVersion);
+        const uint32_t header_sizes[] = {sizeof(CorpusHeader) - CORPUS_ALIGNMENT / 2, header_size + 8,
+                                         static_cast<uint32_t>(file.size() + CORPUS_ALIGNMENT)};
+        for (uint32_t size : header_sizes) {
+            broken = header;
+            broken.header_size = size;
+            ASSERT_TRUE(attach(broken, file.size()) == kCorpusBadFormat);
+        }
+        const uint32_t record_sizes[] = {0, sizeof(TestEntry) - CORPUS_ALIGNMENT, record_size + 8};
+        for (uint32_t size : record_sizes) {
+            broken = header;
+            broken.record_size = size;
+            ASSERT_TRUE(attach(broken, file.size()) == kCorpusBadFormat);
+        }
+        const uint64_t counts[] = {0, 4, ~uint64_t(0)};
+        for (uint64_t count : counts) {
+            broken = header;
+            broken.count = count;
+            ASSERT_TRUE(attach(broken, file.size()) == kCorpusBadFormat);
+        }
+        // A file with the magic but shorter than the header is neither version.
+        ASSERT_TRUE(attach(header, sizeof(CorpusHeader) - 1) == kCorpusBadFormat);
+        // Without the magic the file is read as raw entries, which its size doesn't fit.
+        broken = header;
+        broken.magic[0] = 'X';
+        ASSERT_TRUE(attach(broken, file.size()) == kCorpusBadFormat);
+
+        // Shards cover the entries in order, more shards than entries leave some empty.
+        std::memset(&corpus, 0, sizeof(corpus));
+        ASSERT_TRUE(CorpusAttach(&corpus, entries, sizeof(entries)) == kCorpusOk);
+        const unsigned shard_counts[] = {1, 2, 3, 5, 64};
+        for (unsigned shards : shard_counts) {
+            std::size_t next = 0;
+            for (unsigned shard = 0; shard < shards; shard++) {
+                std::size_t first = 0, count = 0;
+                CorpusShard(&corpus, shard, shards, &first, &count);
+                ASSERT_TRUE(first == next && count <= (3 + shards - 1) / shards && count >= 3 / shards);
+                next = first + count;
+            }
+            ASSERT_TRUE(next == 3);
+        }
+
+        // Written files are version 1 and read back through the mapping.
+        char directory[] = "/tmp/gost_ecc_corpus.XXXXXX";
+        ASSERT_TRUE(::mkdtemp(directory) != nullptr);
+        const std::string path = std::string(directory) + "/corpus.dat";
+        const std::string empty_path = std::string(directory) + "/empty.dat";
+        ASSERT_TRUE(CorpusWrite(&corpus, path.c_str()) == 0);
+        Corpus mapped;
+        ASSERT_TRUE(CorpusOpen(path.c_str(), &mapped) == kCorpusOk);
+        ASSERT_TRUE(mapped.version == 1 && mapped.count == 3 && mapped.stride % CORPUS_ALIGNMENT == 0);
+        for (unsigned i = 0; i < 3; i++) {
+            ASSERT_TRUE(std::memcmp(CorpusEntry(&mapped, i), &entries[i], sizeof(TestEntry)) == 0);
+        }
+        CorpusClose(&mapped);
+        ASSERT_TRUE(mapped.mapping == nullptr && mapped.count == 0);
+
+        ASSERT_TRUE(write_file(empty_path, "", 0));
+        ASSERT_TRUE(CorpusOpen(empty_path.c_str(), &mapped) == kCorpusBadFormat && mapped.mapping == nullptr);
+        std::remove(empty_path.c_str());
+        std::remove(path.c_str());
+        ASSERT_TRUE(CorpusOpen(path.c_str(), &mapped) == kCorpusCantOpen);
+        ASSERT_TRUE(::rmdir(directory) == 0);
+    }
+
+    {
+        // NUMA helpers on whatever topology the machine has, a single node at least.
+        const unsigned nodes = numa::nodes();
+        ASSERT_TRUE(nodes >= 1 && numa::current_node() < nodes);
+        ASSERT_TRUE(numa::node_cpus(nodes).empty() && !numa::bind_thread(nodes));
+
+        // Binding is checked on temporary threads, so the affinity of the test itself is kept.
+        const bool topology = !numa::node_cpus(0).empty();
+        for (unsigned node = 0; node < nodes; node++) {
+            bool bound = false, local = false;
+            std::thread([node, &bound, &local]() {
+                bound = numa::bind_thread(node);
+                local = numa::current_node() == node;
+            }).join();
+            ASSERT_TRUE(bound == topology && (!topology || local));
+        }
+
+        const std::size_t size = 3 * 4096 + 1;
+        unsigned char* memory = static_cast<unsigned char*>(numa::allocate(size, nodes - 1));
+        ASSERT_TRUE(reinterpret_cast<std::uintptr_t>(memory) % 4096 == 0);
+        std::memset(memory, 0xa5, size);
+        ASSERT_TRUE(memory[size - 1] == 0xa5);
+        numa::deallocate(memory, size);
+
+        // Every replica is a deep copy which signs and verifies like the original engine.
+        char expected[128];
+        ASSERT_TRUE(Gost12S512Sign(reinterpret_cast<const char*>(a_private_key), reinterpret_cast<const char*>(a_rand),
+                                   reinterpret_cast<const char*>(a_hash), expected) == kStatusOk);
+        const byte* key = reinterpret_cast<const byte*>(a_private_key);
+        const byte* rand = reinterpret_cast<const byte*>(a_rand);
+        const byte* hash = reinterpret_cast<const byte*>(a_hash);
+
+        std::vector<numa::node_ptr<const signature> > replicas;
+        {
+            Gost12S512CtxOptions options;
+            Gost12S512CtxOptionsInit(&options);
+            options.flags = kGost12S512CtxRegularSign;
+            Gost12S512Ctx* ctx = Gost12S512CtxCreate(kGost12S512ParamSetA, &options);
+            ASSERT_TRUE(ctx != nullptr);
+            for (unsigned node = 0; node < nodes; node++) {
+                replicas.push_back(numa::make_on_node<const signature>(node, *ctx->engine));
+            }
+            Gost12S512CtxDestroy(ctx);
+        }
+        for (const numa::node_ptr<const signature>& replica : replicas) {
+            byte result[128];
+            ASSERT_TRUE(replica->sign(key, rand, hash, result) == kStatusOk);
+            ASSERT_TRUE(std::memcmp(result, expected, sizeof(expected)) == 0);
+            ASSERT_TRUE(replica->verify(reinterpret_cast<const byte*>(a_public_key_x), reinterpret_cast<const byte*>(a_public_key_y),
+                                        hash, result) == kStatusOk);
+        }
+
+        // Exception of the constructor reaches the caller and the memory is released.
+        struct throwing {
+            throwing() {
+                throw std::runtime_error("constructor");
+            }
+        };
+        bool caught = false;
+        try {
+            numa::make_on_node<throwing>(0);
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        ASSERT_TRUE(caught);
+    }
+
+    {
+        // gost_ecc_daemon answers like the single-call interface, over a private socket.
+        char directory[] = "/tmp/gost_ecc_test.XXXXXX";
+        ASSERT_TRUE(::mkdtemp(directory) != nullptr);
+        const std::string socket_path = std::string(directory) + "/daemon.sock";
+
+        const pid_t daemon = ::fork();
+        ASSERT_TRUE(daemon >= 0);
+        if (daemon == 0) {
+            ::execl(GOST_ECC_DAEMON, GOST_ECC_DAEMON, "--socket", socket_path.c_str(), "--workers", "2",
+                    static_cast<char*>(nullptr));
+            ::_exit(127);
+        }
+
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, socket_path.c_str());
+
+        int fd = -1;
+        for (unsigned attempt = 0; fd < 0 && attempt < 3000; attempt++) {
+            fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            ASSERT_TRUE(fd >= 0);
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                ::close(fd);
+                fd = -1;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        ASSERT_TRUE(fd >= 0);
+
+        struct stat info;
+        ASSERT_TRUE(::lstat(socket_path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode) && (info.st_mode & 0777) == 0600);
+
+        char expected[128], wrong_hash[64];
+        ASSERT_TRUE(Gost12S512Sign(reinterpret_cast<const char*>(a_private_key), reinterpret_cast<const char*>(a_rand),
+                                   reinterpret_cast<const char*>(a_hash), expected) == kStatusOk);
+        std::memcpy(wrong_hash, a_hash, sizeof(wrong_hash));
+        wrong_hash[9] ^= 0x04;
+
+        // A silent peer fails the call once the timeout expires instead of blocking forever.
+        int pair[2];
+        ASSERT_TRUE(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+        ASSERT_TRUE(protocol::set_timeouts(pair[0], 50));
+        protocol::response silent;
+        ASSERT_TRUE(!protocol::receive_all(pair[0], &silent, sizeof(silent)) && errno == EAGAIN);
+        ::close(pair[0]);
+        ::close(pair[1]);
+
+        // Pipelined requests, responses may come in any order.
+        protocol::request requests[3];
+        std::memset(requests, 0, sizeof(requests));
+        requests[0].op = protocol::op_sign;
+        std::memcpy(requests[0].data, a_private_key, 64);
+        std::memcpy(requests[0].data + 8, a_rand, 64);
+        std::memcpy(requests[0].data + 16, a_hash, 64);
+        requests[1].op = protocol::op_verify;
+        std::memcpy(requests[1].data, a_public_key_x, 64);
+        std::memcpy(requests[1].data + 8, a_public_key_y, 64);
+        std::memcpy(requests[1].data + 16, a_hash, 64);
+        std::memcpy(requests[1].data + 24, expected, 128);
+        requests[2] = requests[1];
+        std::memcpy(requests[2].data + 16, wrong_hash, 64);
+        for (uint32_t i = 0; i < 3; i++) {
+            requests[i].id = i;
+            ASSERT_TRUE(protocol::send_all(fd, &requests[i], sizeof(requests[i])));
+        }
+
+        Gost12S512Status statuses[3] = {kStatusInternalError, kStatusInternalError, kStatusInternalError};
+        for (unsigned i = 0; i < 3; i++) {
+            protocol::response response;
+            ASSERT_TRUE(protocol::receive_all(fd, &response, sizeof(response)) && response.id < 3);
+            statuses[response.id] = static_cast<Gost12S512Status>(response.status);
+            if (response.id == 0) {
+                ASSERT_TRUE(std::memcmp(response.signature, expected, sizeof(expected)) == 0);
+            }
+        }
+        ASSERT_TRUE(statuses[0] == kStatusOk && statuses[1] == kStatusOk && statuses[2] == kStatusWrongSignature);
+
+        // Requests sent before the daemon is told to stop are still answered.
+        for (uint32_t i = 0; i < 3; i++) {
+            ASSERT_TRUE(protocol::send_all(fd, &requests[i], sizeof(requests[i])));
+        }
+        ASSERT_TRUE(::kill(daemon, SIGTERM) == 0);
+        for (unsigned i = 0; i < 3; i++) {
+            protocol::response response;
+            ASSERT_TRUE(protocol::receive_all(fd, &response, sizeof(response)) && response.id < 3);
+            ASSERT_TRUE(static_cast<Gost12S512Status>(response.status) == statuses[response.id]);
+        }
+        protocol::response extra;
+        ASSERT_TRUE(!protocol::receive_all(fd, &extra, sizeof(extra)));
+        ::close(fd);
+
+        int status = 0;
+        ASSERT_TRUE(::waitpid(daemon, &status, 0) == daemon);
+        ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        ASSERT_TRUE(::lstat(socket_path.c_str(), &info) != 0 && errno == ENOENT);
+
+        // A file in place of the socket is not removed, the daemon refuses to start.
+        ASSERT_TRUE(write_file(socket_path, "x", 1));
+        ASSERT_TRUE(run_quietly(std::string(GOST_ECC_DAEMON) + " --socket " + socket_path) == 1);
+        ASSERT_TRUE(::lstat(socket_path.c_str(), &info) == 0 && S_ISREG(info.st_mode));
+        std::remove(socket_path.c_str());
+        ASSERT_TRUE(::rmdir(directory) == 0);
+    }
+
     std::cout << "General test passed, testing signature..." << std::endl;
 
     signature s(p, a, b, q, x, y);
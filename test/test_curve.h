@@ -0,0 +1,27 @@
+#ifndef TEST_CURVE_H
+#define TEST_CURVE_H
+
+#include <cstdint>
+
+namespace gost_ecc {
+
+/**
+ * @brief 256-bit curve of the signature example from GOST R 34.10-2012, apart from the
+ * parameter sets of curve.h, which the library linked into the test defines.
+ */
+namespace test_curve {
+
+extern uint64_t p[8];
+extern uint64_t a[8];
+extern uint64_t b[8];
+extern uint64_t q[8];
+extern uint64_t x[8];
+extern uint64_t y[8];
+extern uint64_t x0[8];
+extern uint64_t y0[8];
+
+}
+
+}
+
+#endif // TEST_CURVE_H
@@ -0,0 +1,486 @@
+#include <sign_engine_ext.h>
+#include <bounded_queue.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Signs or verifies many files with detached signatures.
+ *
+ *   gost_ecc_tool sign   --key private.key [options] FILE...
+ *   gost_ecc_tool verify --key public.key  [options] FILE...
+ *
+ * Private key is 64 bytes, public key is X || Y, 128 bytes, signature of FILE is FILE.sig in
+ * the raw r || s layout of Gost12S512Sign(). All numbers are little-endian.
+ *
+ * Work runs in a pipeline of threads linked by bounded queues:
+ * read (mmap) -> hash (several threads) -> EC (batches on the context's thread pool) -> write.
+ */
+
+using ::gost_ecc::bounded_queue;
+
+namespace {
+
+const std::size_t signature_size = 128;
+
+struct options {
+    bool sign = false;
+    std::string key_path;
+    std::string list_path;
+    std::vector<std::string> files;
+    unsigned threads = 0;
+    unsigned hash_threads = 0;
+    std::size_t queue_size = 256;
+    std::size_t batch_size = 64;
+    bool quiet = false;
+};
+
+void usage() {
+    std::cerr <<
+        "Usage: gost_ecc_tool sign|verify --key FILE [options] [FILE...]\n"
+        "  --key FILE        private key (sign, 64 bytes) or public key X || Y (verify, 128 bytes)\n"
+        "  --list FILE       read paths to process from FILE, one per line, - for stdin\n"
+        "  --threads N       EC worker threads, default is the number of CPUs\n"
+        "  --hash-threads N  hashing threads, default is the number of CPUs\n"
+        "  --queue N         capacity of each pipeline queue, default 256\n"
+        "  --batch N         jobs per EC batch, default 64\n"
+        "  --quiet           report only failures and the summary\n";
+}
+
+unsigned long parse_number(const char* value) {
+    char* end = nullptr;
+    unsigned long result = std::strtoul(value, &end, 10);
+    if (end == value || *end != '\0') {
+        throw std::invalid_argument(std::string("not a number: ") + value);
+    }
+    return result;
+}
+
+options parse_options(int argc, char** argv) {
+    if (argc < 2) {
+        throw std::invalid_argument("mode is missing");
+    }
+
+    options result;
+    const std::string mode = argv[1];
+    if (mode == "sign") {
+        result.sign = true;
+    } else if (mode != "verify") {
+        throw std::invalid_argument("unknown mode " + mode);
+    }
+
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--key" && has_value) {
+            result.key_path = argv[++i];
+        } else if (arg == "--list" && has_value) {
+            result.list_path = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            result.threads = parse_number(argv[++i]);
+        } else if (arg == "--hash-threads" && has_value) {
+            result.hash_threads = parse_number(argv[++i]);
+        } else if (arg == "--queue" && has_value) {
+            result.queue_size = std::max(1ul, parse_number(argv[++i]));
+        } else if (arg == "--batch" && has_value) {
+            result.batch_size = std::max(1ul, parse_number(argv[++i]));
+        } else if (arg == "--quiet") {
+            result.quiet = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            throw std::invalid_argument("unknown option " + arg);
+        } else {
+            result.files.push_back(arg);
+        }
+    }
+
+    if (result.key_path.empty()) {
+        throw std::invalid_argument("--key is required");
+    }
+    if (result.hash_threads == 0) {
+        result.hash_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return result;
+}
+
+/**
+ * Read a file which must be exactly size bytes long.
+ */
+bool read_exact(const std::string& path, void* data, std::size_t size) {
+    std::ifstream in(path, std::ios::binary);
+    in.read(static_cast<char*>(data), size);
+    return in.gcount() == static_cast<std::streamsize>(size) && in.peek() == std::ifstream::traits_type::eof();
+}
+
+/**
+ * Read-only mapping of a whole file.
+ */
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path)
+        :data(nullptr), size(0)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error(std::strerror(errno));
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::runtime_error(std::strerror(error));
+        }
+
+        this->size = static_cast<std::size_t>(st.st_size);
+        if (this->size > 0) {
+            void* mapping = ::mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            const int error = errno;
+            ::close(fd);
+
+            if (mapping == MAP_FAILED) {
+                throw std::runtime_error(std::strerror(error));
+            }
+            ::madvise(mapping, this->size, MADV_SEQUENTIAL);
+            this->data = static_cast<const char*>(mapping);
+        } else {
+            ::close(fd);
+        }
+    }
+
+    ~mapped_file() {
+        if (this->data != nullptr) {
+            ::munmap(const_cast<char*>(this->data), this->size);
+        }
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const char* data;
+    std::size_t size;
+};
+
+/**
+ * One file on its way through the pipeline.
+ */
+struct item {
+    std::string path;
+    std::unique_ptr<mapped_file> file;
+    std::size_t size = 0;
+
+    std::array<uint64_t, 8> hash;
+    std::array<uint64_t, 16> signature;
+    std::string error;
+    Gost12S512Status status = kStatusOk;
+};
+
+using item_ptr = std::unique_ptr<item>;
+
+class pipeline {
+public:
+    pipeline(const options& opts, const Gost12S512Ctx* ctx, const std::array<uint64_t, 16>& key)
+        :opts(opts), ctx(ctx), key(key),
+          to_hash(opts.queue_size), to_ec(opts.queue_size), to_write(opts.queue_size),
+          hashers_left(opts.hash_threads), processed(0), failed(0), bytes(0)
+    {}
+
+    /**
+     * @return true if every file has been signed or verified successfully.
+     */
+    bool run(std::istream* list) {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        threads.emplace_back([this, list]() { this->read(list); });
+        for (unsigned i = 0; i < this->opts.hash_threads; i++) {
+            threads.emplace_back([this]() { this->hash(); });
+        }
+        threads.emplace_back([this]() { this->ec(); });
+        this->write();
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "%s %zu files, %zu failed, %.1f MB in %.3f s: %.1f files/s, %.1f MB/s\n",
+                     this->opts.sign ? "signed" : "verified", this->processed, this->failed,
+                     this->bytes / 1e6, seconds, this->processed / seconds, this->bytes / 1e6 / seconds);
+
+        return this->failed == 0;
+    }
+
+private:
+    void read(std::istream* list) {
+        auto submit = [this](const std::string& path) {
+            item_ptr current(new item());
+            current->path = path;
+
+            try {
+                current->file.reset(new mapped_file(path));
+                current->size = current->file->size;
+
+                if (!this->opts.sign && !read_exact(path + ".sig", current->signature.data(), signature_size)) {
+                    current->error = "cannot read " + path + ".sig";
+                }
+            } catch (const std::exception& e) {
+                current->error = e.what();
+                current->file.reset();
+            }
+            this->to_hash.push(current);
+        };
+
+        for (const auto& path : this->opts.files) {
+            submit(path);
+        }
+
+        std::string path;
+        while (list != nullptr && std::getline(*list, path)) {
+            if (!path.empty()) {
+                submit(path);
+            }
+        }
+
+        this->to_hash.close();
+    }
+
+    void hash() {
+        Gost12S512Hash* hash = Gost12S512HashCreate(64);
+
+        item_ptr current;
+        while (this->to_hash.pop(current)) {
+            if (current->error.empty() && hash != nullptr) {
+                Gost12S512HashUpdate(hash, current->file->data, current->file->size);
+                Gost12S512HashFinal(hash, reinterpret_cast<char*>(current->hash.data()));
+            } else if (current->error.empty()) {
+                current->error = "out of memory";
+            }
+            current->file.reset();
+            this->to_ec.push(current);
+        }
+
+        Gost12S512HashDestroy(hash);
+
+        if (--this->hashers_left == 0) {
+            this->to_ec.close();
+        }
+    }
+
+    void ec() {
+        std::vector<item_ptr> batch;
+        std::vector<item_ptr> skipped;
+        item_ptr current;
+
+        while (this->to_ec.pop(current)) {
+            // Block for the first item only, then take whatever has already been hashed.
+            do {
+                (current->error.empty() ? batch : skipped).push_back(std::move(current));
+            } while (batch.size() < this->opts.batch_size && this->to_ec.try_pop(current));
+
+            if (this->opts.sign) {
+                this->sign_batch(batch);
+            } else {
+                this->verify_batch(batch);
+            }
+
+            for (auto& done : batch) {
+                this->to_write.push(done);
+            }
+            for (auto& done : skipped) {
+                this->to_write.push(done);
+            }
+            batch.clear();
+            skipped.clear();
+        }
+
+        this->to_write.close();
+    }
+
+    void sign_batch(std::vector<item_ptr>& batch) {
+        std::vector<std::array<uint64_t, 8> > rand(batch.size());
+        std::vector<Gost12S512SignJob> jobs(batch.size());
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            jobs[i].privateKey = reinterpret_cast<const char*>(this->key.data());
+            jobs[i].rand = reinterpret_cast<const char*>(rand[i].data());
+            jobs[i].hash = reinterpret_cast<const char*>(batch[i]->hash.data());
+            jobs[i].signature = reinterpret_cast<char*>(batch[i]->signature.data());
+            jobs[i].status = kStatusBadInput;
+        }
+
+        // The key has been checked up front, so kStatusBadInput means a random number not below q.
+        for (unsigned attempt = 0; attempt < 4; attempt++) {
+            std::vector<Gost12S512SignJob> retry;
+            for (std::size_t i = 0; i < jobs.size(); i++) {
+                if (jobs[i].status == kStatusBadInput) {
+                    for (auto& limb : rand[i]) {
+                        limb = (static_cast<uint64_t>(this->random()) << 32) | this->random();
+                    }
+                    retry.push_back(jobs[i]);
+                }
+            }
+            if (retry.empty()) {
+                break;
+            }
+
+            if (Gost12S512CtxSignBatch(this->ctx, retry.data(), retry.size()) != kStatusOk) {
+                for (auto& job : retry) {
+                    job.status = kStatusInternalError;
+                }
+            }
+            for (std::size_t i = 0, j = 0; i < jobs.size(); i++) {
+                if (jobs[i].status == kStatusBadInput) {
+                    jobs[i].status = retry[j++].status;
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            batch[i]->status = jobs[i].status;
+        }
+    }
+
+    void verify_batch(std::vector<item_ptr>& batch) {
+        std::vector<Gost12S512VerifyJob> jobs(batch.size());
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            jobs[i].publicKeyX = reinterpret_cast<const char*>(this->key.data());
+            jobs[i].publicKeyY = reinterpret_cast<const char*>(this->key.data() + 8);
+            jobs[i].hash = reinterpret_cast<const char*>(batch[i]->hash.data());
+            jobs[i].signature = reinterpret_cast<const char*>(batch[i]->signature.data());
+        }
+
+        if (Gost12S512CtxVerifyBatch(this->ctx, jobs.data(), jobs.size()) != kStatusOk) {
+            for (auto& job : jobs) {
+                job.status = kStatusInternalError;
+            }
+        }
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            batch[i]->status = jobs[i].status;
+        }
+    }
+
+    void write() {
+        item_ptr current;
+
+        while (this->to_write.pop(current)) {
+            this->processed++;
+            this->bytes += current->size;
+
+            if (current->error.empty() && current->status == kStatusOk && this->opts.sign) {
+                std::ofstream out(current->path + ".sig", std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(current->signature.data()), signature_size);
+                if (!out) {
+                    current->error = "cannot write " + current->path + ".sig";
+                }
+            }
+
+            if (!current->error.empty()) {
+                this->failed++;
+                std::fprintf(stderr, "%s: %s\n", current->path.c_str(), current->error.c_str());
+            } else if (current->status != kStatusOk) {
+                this->failed++;
+                std::printf("%s: %s\n", current->path.c_str(),
+                            current->status == kStatusWrongSignature ? "BAD SIGNATURE" : "ERROR");
+            } else if (!this->opts.quiet) {
+                std::printf("%s: OK\n", current->path.c_str());
+            }
+        }
+    }
+
+    const options& opts;
+    const Gost12S512Ctx* ctx;
+    const std::array<uint64_t, 16>& key;
+
+    bounded_queue<item_ptr> to_hash;
+    bounded_queue<item_ptr> to_ec;
+    bounded_queue<item_ptr> to_write;
+    std::atomic<unsigned> hashers_left;
+
+    std::random_device random;
+
+    std::size_t processed;
+    std::size_t failed;
+    std::size_t bytes;
+};
+
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    try {
+        opts = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        usage();
+        return 2;
+    }
+
+    std::array<uint64_t, 16> key = {};
+    if (!read_exact(opts.key_path, key.data(), opts.sign ? 64 : 128)) {
+        std::cerr << "cannot read key " << opts.key_path << std::endl;
+        return 2;
+    }
+
+    Gost12S512CtxOptions ctx_options;
+    Gost12S512CtxOptionsInit(&ctx_options);
+    ctx_options.flags |= kGost12S512CtxThreadPool | kGost12S512CtxLazyTables;
+    ctx_options.threads = opts.threads;
+
+    std::unique_ptr<Gost12S512Ctx, void (*)(Gost12S512Ctx*)> ctx(
+            Gost12S512CtxCreate(kGost12S512ParamSetA, &ctx_options), Gost12S512CtxDestroy);
+    if (!ctx) {
+        std::cerr << "cannot create engine context" << std::endl;
+        return 2;
+    }
+
+    if (opts.sign) {
+        std::array<uint64_t, 8> x, y;
+        const char* private_key = reinterpret_cast<const char*>(key.data());
+        char* public_x = reinterpret_cast<char*>(x.data());
+        char* public_y = reinterpret_cast<char*>(y.data());
+
+        if (Gost12S512CtxDeriveKeys(ctx.get(), &private_key, &public_x, &public_y, 1) != kStatusOk) {
+            std::cerr << "invalid private key " << opts.key_path << std::endl;
+            return 2;
+        }
+    }
+
+    std::ifstream list_file;
+    std::istream* list = nullptr;
+    if (opts.list_path == "-") {
+        list = &std::cin;
+    } else if (!opts.list_path.empty()) {
+        list_file.open(opts.list_path);
+        if (!list_file) {
+            std::cerr << "cannot open list " << opts.list_path << std::endl;
+            return 2;
+        }
+        list = &list_file;
+    }
+
+    pipeline work(opts, ctx.get(), key);
+    return work.run(list) ? 0 : 1;
+}